@@ -267,14 +267,19 @@
  * Others
  *-----------*/
 
-/*1: Show CPU usage and FPS count*/
-#define LV_USE_PERF_MONITOR 0
+/*1: Show CPU usage and FPS count
+ *Build with -D LVGL_PERF to enable it and log every refresh (see wt32DisplayDriver.cpp)*/
+#ifdef LVGL_PERF
+    #define LV_USE_PERF_MONITOR 1
+#else
+    #define LV_USE_PERF_MONITOR 0
+#endif
 #if LV_USE_PERF_MONITOR
     #define LV_USE_PERF_MONITOR_POS LV_ALIGN_BOTTOM_RIGHT
 #endif
 
 /*1: Show the used memory and the memory fragmentation
- * Requires LV_MEM_CUSTOM = 0*/
+ * Requires LV_MEM_CUSTOM = 0, with malloc the LVGL_PERF logs report the heap instead*/
 #define LV_USE_MEM_MONITOR 0
 #if LV_USE_MEM_MONITOR
     #define LV_USE_MEM_MONITOR_POS LV_ALIGN_BOTTOM_LEFT
@@ -33,6 +33,28 @@ const static lcd_cmd_t rm67162_qspi_init[] = {
 
 static spi_device_handle_t spi;
 
+// Async pushes are sent by the LcdPush task with ASYNC_IN_FLIGHT chunks queued at
+// a time. IDF 4.4 gives every queued chunk of a PSRAM frame its own internal DMA
+// bounce buffer, so this bounds them to ASYNC_IN_FLIGHT x ASYNC_CHUNK x 2 bytes.
+#define ASYNC_IN_FLIGHT 2
+#define ASYNC_CHUNK 0x1000 // pixels
+
+typedef struct
+{
+  uint16_t x, y, width, high;
+  uint16_t *data;
+} async_frame;
+
+static async_frame asyncFrame;
+static spi_transaction_ext_t asyncTrans[ASYNC_IN_FLIGHT];
+static TaskHandle_t pushTask = NULL;
+static SemaphoreHandle_t pushDone = NULL;
+static bool asyncActive = false; // A frame was handed to the task and not waited for
+
+#if LCD_USB_QSPI_DREVER == 1
+static void runLcdPush(void *name);
+#endif
+
 static void WriteComm(uint8_t data)
 {
   TFT_CS_L;
@@ -67,6 +89,7 @@ static void WriteData16(uint16_t data)
 static void lcd_send_cmd(uint32_t cmd, uint8_t *dat, uint32_t len)
 {
 #if LCD_USB_QSPI_DREVER == 1
+  lcd_PushColorsWait();
   TFT_CS_L;
   spi_transaction_t t;
   memset(&t, 0, sizeof(t));
@@ -135,6 +158,11 @@ void rm67162_init(void)
   ret = spi_bus_add_device(TFT_SPI_HOST, &devcfg, &spi);
   ESP_ERROR_CHECK(ret);
 
+  // Without the task lcd_PushColorsAsync() pushes blocking
+  pushDone = xSemaphoreCreateBinary();
+  if (pushDone == NULL || xTaskCreatePinnedToCore(runLcdPush, "LcdPush", 3072, NULL, 3, &pushTask, 0) != pdPASS)
+    pushTask = NULL;
+
 #else
   SPI.begin(TFT_SCK, -1, TFT_MOSI, TFT_CS);
   SPI.setFrequency(SPI_FREQUENCY);
@@ -230,6 +258,7 @@ void lcd_PushColors(uint16_t x,
                     uint16_t *data)
 {
 #if LCD_USB_QSPI_DREVER == 1
+  lcd_PushColorsWait();
   bool first_send = 1;
   size_t len = width * high;
   uint16_t *p = (uint16_t *)data;
@@ -285,6 +314,7 @@ void lcd_PushColors(uint16_t x,
 void lcd_PushColors(uint16_t *data, uint32_t len)
 {
 #if LCD_USB_QSPI_DREVER == 1
+  lcd_PushColorsWait();
   bool first_send = 1;
   uint16_t *p = (uint16_t *)data;
   TFT_CS_L;
@@ -333,6 +363,134 @@ void lcd_PushColors(uint16_t *data, uint32_t len)
 #endif
 }
 
+#if LCD_USB_QSPI_DREVER == 1
+// LcdPush task only
+static void sendAsyncFrame(const async_frame *f)
+{
+  size_t len = f->width * f->high;
+  uint16_t *p = f->data;
+  int pending = 0;
+  int slot = 0;
+  bool failed = false;
+  spi_transaction_t *done;
+
+  lcd_address_set(f->x, f->y, f->x + f->width - 1, f->y + f->high - 1);
+  TFT_CS_L;
+  for (bool first = true; len > 0; first = false)
+  {
+    // Chunks end in order, the oldest one frees the slot used next
+    if (pending == ASYNC_IN_FLIGHT)
+    {
+      spi_device_get_trans_result(spi, &done, portMAX_DELAY);
+      pending--;
+    }
+
+    size_t chunk_size = len > ASYNC_CHUNK ? ASYNC_CHUNK : len;
+    spi_transaction_ext_t *t = &asyncTrans[slot];
+    memset(t, 0, sizeof(spi_transaction_ext_t));
+    if (first)
+    {
+      t->base.flags = SPI_TRANS_MODE_QIO;
+      t->base.cmd = 0x32;
+      t->base.addr = 0x002C00;
+    }
+    else
+    {
+      t->base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
+                      SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+    }
+    t->base.tx_buffer = p;
+    t->base.length = chunk_size * 16;
+
+    // Fails with ESP_ERR_NO_MEM when no bounce buffer can be allocated
+    if (spi_device_queue_trans(spi, (spi_transaction_t *)t, portMAX_DELAY) != ESP_OK)
+    {
+      failed = true;
+      break;
+    }
+    pending++;
+    slot = (slot + 1) % ASYNC_IN_FLIGHT;
+    len -= chunk_size;
+    p += chunk_size;
+  }
+
+  while (pending > 0)
+  {
+    spi_device_get_trans_result(spi, &done, portMAX_DELAY);
+    pending--;
+  }
+  TFT_CS_H;
+
+  if (failed)
+  {
+    Serial.printf("[LCD] Queueing the frame failed, sending it blocking\n");
+    lcd_PushColors(f->x, f->y, f->width, f->high, f->data);
+  }
+}
+
+static void runLcdPush(void *name)
+{
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    sendAsyncFrame(&asyncFrame);
+    xSemaphoreGive(pushDone);
+  }
+}
+#endif
+
+void lcd_PushColorsAsync(uint16_t x,
+                         uint16_t y,
+                         uint16_t width,
+                         uint16_t high,
+                         uint16_t *data)
+{
+#if LCD_USB_QSPI_DREVER == 1
+  lcd_PushColorsWait();
+  if (pushTask == NULL)
+  {
+    lcd_PushColors(x, y, width, high, data);
+    return;
+  }
+  asyncFrame.x = x;
+  asyncFrame.y = y;
+  asyncFrame.width = width;
+  asyncFrame.high = high;
+  asyncFrame.data = data;
+  asyncActive = true;
+  xTaskNotifyGive(pushTask);
+#else
+  lcd_PushColors(x, y, width, high, data);
+#endif
+}
+
+void lcd_PushColorsWait(void)
+{
+#if LCD_USB_QSPI_DREVER == 1
+  // The task sets the window with the same commands that wait here
+  if (!asyncActive || xTaskGetCurrentTaskHandle() == pushTask)
+    return;
+  xSemaphoreTake(pushDone, portMAX_DELAY);
+  asyncActive = false;
+#endif
+}
+
+bool lcd_PushColorsBusy(void)
+{
+#if LCD_USB_QSPI_DREVER == 1
+  if (!asyncActive)
+    return false;
+  if (xSemaphoreTake(pushDone, 0) == pdTRUE)
+  {
+    asyncActive = false;
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
 void lcd_sleep()
 {
   lcd_send_cmd(0x10, NULL, 0);
@@ -51,6 +51,16 @@ void lcd_PushColors(uint16_t x,
                     uint16_t high,
                     uint16_t *data);
 void lcd_PushColors(uint16_t *data, uint32_t len);
+// Hand the frame to the LcdPush task, which sends it over DMA a few chunks at a
+// time, and return. The buffer must stay untouched until the transfer ends:
+// lcd_PushColorsWait() (or any other lcd_* call) waits for it.
+void lcd_PushColorsAsync(uint16_t x,
+                         uint16_t y,
+                         uint16_t width,
+                         uint16_t high,
+                         uint16_t *data);
+void lcd_PushColorsWait(void);
+bool lcd_PushColorsBusy(void);
 void lcd_sleep();
 
 void lcd_on();
@@ -0,0 +1,213 @@
+#include <Arduino.h>
+#include "monitor.h"
+#include "mining.h"
+#include "history.h"
+#include "hashrate.h"
+#include "fetcher.h"
+#include "fleet.h"
+#include "drivers/storage/nvMemory.h"
+
+// Canned miner state for the harness. It stands in for monitor.cpp and the
+// tasks behind it (stats, hashrate, fetcher, fleet, history), so every run
+// draws the same values. Strings are formatted the way monitor.cpp formats
+// them; the clock starts at CANNED_EPOCH and follows the virtual time.
+
+#define CANNED_EPOCH 1713702840UL   // 21/04/2024 12:34:00
+
+monitor_data mMonitor = {SCREEN_MINING, false, NM_hashing};
+TSettings Settings;
+nvMemory nvMem;
+pool_data pData;
+bool invertColors = false;
+
+uint32_t getEpochSeconds(void)
+{
+  return CANNED_EPOCH + millis() / 1000;
+}
+
+void setTimezone(int timezone)
+{
+  Settings.Timezone = timezone;
+}
+
+static void cannedTime(unsigned long *hours, unsigned long *minutes, unsigned long *seconds)
+{
+  uint32_t now = getEpochSeconds();
+  *hours = now % 86400 / 3600;
+  *minutes = now % 3600 / 60;
+  *seconds = now % 60;
+}
+
+static void cannedTime(char *localHour, size_t size)
+{
+  unsigned long hours, minutes, seconds;
+  cannedTime(&hours, &minutes, &seconds);
+  snprintf(localHour, size, "%02lu:%02lu", hours, minutes);
+}
+
+mining_data getMiningData(unsigned long mElapsed)
+{
+  mining_data data;
+
+  strlcpy(data.completedShares, "42", sizeof(data.completedShares));
+  strlcpy(data.totalMHashes, "123456", sizeof(data.totalMHashes));
+  strlcpy(data.totalKHashes, "123456789", sizeof(data.totalKHashes));
+  strlcpy(data.currentHashRate, "312.45", sizeof(data.currentHashRate));
+  strlcpy(data.templates, "7", sizeof(data.templates));
+  strlcpy(data.bestDiff, "1.23G", sizeof(data.bestDiff));
+  strlcpy(data.timeMining, "1  02:03:04", sizeof(data.timeMining));
+  strlcpy(data.valids, "1", sizeof(data.valids));
+  strlcpy(data.temp, "45", sizeof(data.temp));
+  cannedTime(data.currentTime, sizeof(data.currentTime));
+
+  return data;
+}
+
+clock_data getClockData(unsigned long mElapsed)
+{
+  clock_data data;
+
+  strlcpy(data.completedShares, "42", sizeof(data.completedShares));
+  strlcpy(data.totalKHashes, "123456789", sizeof(data.totalKHashes));
+  strlcpy(data.currentHashRate, "312.45", sizeof(data.currentHashRate));
+  strlcpy(data.btcPrice, "64321$", sizeof(data.btcPrice));
+  strlcpy(data.blockHeight, "840000", sizeof(data.blockHeight));
+  cannedTime(data.currentTime, sizeof(data.currentTime));
+  strlcpy(data.currentDate, "21/04/2024", sizeof(data.currentDate));
+
+  return data;
+}
+
+clock_data_t getClockData_t(unsigned long mElapsed)
+{
+  clock_data_t data;
+
+  strlcpy(data.valids, "1", sizeof(data.valids));
+  strlcpy(data.currentHashRate, "312.45", sizeof(data.currentHashRate));
+  cannedTime(&data.currentHours, &data.currentMinutes, &data.currentSeconds);
+
+  return data;
+}
+
+coin_data getCoinData(unsigned long mElapsed)
+{
+  coin_data data;
+
+  strlcpy(data.completedShares, "42", sizeof(data.completedShares));
+  strlcpy(data.totalKHashes, "123456789", sizeof(data.totalKHashes));
+  strlcpy(data.currentHashRate, "312.45", sizeof(data.currentHashRate));
+  strlcpy(data.btcPrice, "64321$", sizeof(data.btcPrice));
+  cannedTime(data.currentTime, sizeof(data.currentTime));
+#ifdef NERDMINER_T_HMI
+  strlcpy(data.hourFee, "18", sizeof(data.hourFee));
+  strlcpy(data.fastestFee, "32", sizeof(data.fastestFee));
+  strlcpy(data.economyFee, "9", sizeof(data.economyFee));
+  strlcpy(data.minimumFee, "5", sizeof(data.minimumFee));
+#endif
+  strlcpy(data.halfHourFee, "21 sat/vB", sizeof(data.halfHourFee));
+  strlcpy(data.netwrokDifficulty, "86.39T", sizeof(data.netwrokDifficulty));
+  strlcpy(data.globalHashRate, "612.34", sizeof(data.globalHashRate));
+  strlcpy(data.blockHeight, "840000", sizeof(data.blockHeight));
+
+  // First block after the fourth halving
+  unsigned long remainingBlocks = (((840000UL / HALVING_BLOCKS) + 1) * HALVING_BLOCKS) - 840000UL;
+  data.progressPercent = (HALVING_BLOCKS - remainingBlocks) * 100.0f / HALVING_BLOCKS;
+  snprintf(data.remainingBlocks, sizeof(data.remainingBlocks), "%lu BLOCKS", remainingBlocks);
+
+  return data;
+}
+
+pool_data getPoolData(void)
+{
+  pData.workersCount = 3;
+  strlcpy(pData.workersHash, "1.02M", sizeof(pData.workersHash));
+  strlcpy(pData.bestDifficulty, "3.14G", sizeof(pData.bestDifficulty));
+  return pData;
+}
+
+pool_settings getPoolSettings(void)
+{
+  pool_settings pool;
+  pool.address = Settings.PoolAddress;
+  pool.port = Settings.PoolPort;
+  strlcpy(pool.wallet, Settings.BtcWallet, sizeof(pool.wallet));
+  strlcpy(pool.password, Settings.PoolPassword, sizeof(pool.password));
+  return pool;
+}
+
+hashrate_data getHashrate(void)
+{
+  hashrate_data rate = {};
+  rate.current = rate.avg1m = rate.avg15m = rate.avg1h = 312450;
+  rate.worker[0] = 208300;
+  rate.worker[1] = 104150;
+  return rate;
+}
+
+fetch_status getFetchStatus(FetchSource source)
+{
+  fetch_status status = {};
+  status.valid = true;
+  return status;
+}
+
+fleet_data getFleetData(void)
+{
+  fleet_data fleet = {};
+  fleet.miners = 1;
+  fleet.hashrate = 312450;
+  fleet.shares = 42;
+  fleet.valids = 1;
+  fleet.bestDiff = 1.23e9;
+  return fleet;
+}
+
+// One sample a minute over the last day: the hashrate wanders around
+// 312 KH/s, a share every 47 minutes and WiFi lost for a quarter hour
+uint32_t historyQuery(uint32_t from, uint32_t to, history_callback fn, void *arg)
+{
+  uint32_t now = getEpochSeconds();
+  uint32_t first = now - 1440 * 60;
+  if (from < first) from = first;
+
+  uint32_t count = 0;
+  for (uint32_t t = from - from % 60 + 60; t <= to && t <= now; t += 60)
+  {
+    uint32_t minute = t / 60;
+    history_sample s;
+    s.time = t;
+    s.hashrate = 312450 + (int32_t)(18000 * sin(minute / 37.0)) - (minute % 97) * 90;
+    s.shares = minute % 47 == 0 ? 1 : 0;
+    s.temperature = 45 + minute % 5;
+    s.rssi = -60;
+    s.state = NM_hashing | HISTORY_WIFI;
+    if (minute % 600 < 15)
+    {
+      s.rssi = 0;
+      s.state = NM_Connecting;
+    }
+    count++;
+    if (!fn(&s, arg)) break;
+  }
+  return count;
+}
+
+nvMemory::nvMemory() : Initialized_(false) {}
+
+nvMemory::~nvMemory() {}
+
+bool nvMemory::saveConfig(TSettings *Settings)
+{
+  return true;
+}
+
+// Nothing saved, the drivers keep their defaults
+bool nvMemory::loadConfig(TSettings *Settings)
+{
+  return false;
+}
+
+bool nvMemory::deleteConfig()
+{
+  return true;
+}
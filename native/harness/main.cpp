@@ -0,0 +1,136 @@
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "drivers/displays/display.h"
+#include "panel.h"
+#include "png.h"
+
+// Off-device display harness
+// Boots the board's display driver on the shim framebuffer, draws every cyclic
+// screen twice (the first draw and a redraw of unchanged data) and writes one
+// PNG per frame plus report.json with what each frame cost: draw calls,
+// windows pushed, pixels and bytes sent. tools/frame_capture.py compares the
+// report against a baseline.
+//
+//   .pio/build/native-tdisplay/program [output dir, default frames]
+
+#ifndef NATIVE_BOARD
+#define NATIVE_BOARD "native"
+#endif
+
+#define SCREEN_ELAPSED_ms 5000    // mElapsed the monitor passes between two draws
+#define SETTLE_ms         1000    // Time left to the driver tasks after a draw
+
+typedef struct {
+  std::string screen;
+  const char *pass;
+  std::string image;
+  panel_stats stats;
+  long us;
+  uint32_t crc;
+} frame_record;
+
+static std::string outputDir;
+static std::vector<frame_record> records;
+static unsigned long frame = 0;
+
+static void capture(const std::string &screen, const char *pass, std::chrono::steady_clock::time_point start)
+{
+  frame_record r;
+  r.us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  r.screen = screen;
+  r.pass = pass;
+  r.stats = panelStats();
+  r.crc = panelCrc();
+
+  if (panelWidth() > 0 && panelHeight() > 0)
+  {
+    r.image = "screen_" + screen + "_" + pass + ".png";
+    if (!writePng((outputDir + "/" + r.image).c_str(), panelPixels(), panelWidth(), panelHeight()))
+    {
+      fprintf(stderr, "Cannot write %s/%s\n", outputDir.c_str(), r.image.c_str());
+      exit(1);
+    }
+  }
+  records.push_back(r);
+}
+
+// One tick of runMonitor() without a redraw. Some drivers only notice a new
+// screen here (esp23_2432s028r), on the device that happens in the ticks
+// between two redraws.
+static void monitorTick(void)
+{
+  animateCurrentScreen(frame);
+  doLedStuff(frame);
+  frame++;
+}
+
+static void drawScreen(int screen, const char *pass)
+{
+  panelResetStats();
+  auto start = std::chrono::steady_clock::now();
+
+  monitorTick();
+  drawCurrentScreen(SCREEN_ELAPSED_ms);
+  monitorTick();
+  schedulerRun(SETTLE_ms);
+
+  capture(std::to_string(screen), pass, start);
+}
+
+static bool writeReport(void)
+{
+  FILE *f = fopen((outputDir + "/report.json").c_str(), "w");
+  if (f == NULL) return false;
+
+  fprintf(f, "{\n  \"board\": \"%s\",\n  \"width\": %d,\n  \"height\": %d,\n  \"frames\": [\n",
+          NATIVE_BOARD, panelWidth(), panelHeight());
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    const frame_record &r = records[i];
+    fprintf(f, "    {\"screen\": \"%s\", \"pass\": \"%s\", \"image\": \"%s\", \"drawCalls\": %u, \"pushes\": %u, "
+               "\"pixels\": %llu, \"bytes\": %llu, \"us\": %ld, \"crc\": \"%08x\"}%s\n",
+            r.screen.c_str(), r.pass, r.image.c_str(), r.stats.drawCalls, r.stats.pushes,
+            (unsigned long long)r.stats.pixels, (unsigned long long)r.stats.bytes, r.us, r.crc,
+            i + 1 < records.size() ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  return fclose(f) == 0;
+}
+
+int main(int argc, char **argv)
+{
+  outputDir = argc > 1 ? argv[1] : "frames";
+  mkdir(outputDir.c_str(), 0755);
+
+  // Boot as the device does
+  panelBegin(PANEL_WIDTH, PANEL_HEIGHT);
+  auto start = std::chrono::steady_clock::now();
+  initDisplay();
+  drawLoadingScreen();
+  doLedStuff(frame);
+  schedulerRun(SETTLE_ms);
+  capture("loading", "first", start);
+
+  for (int screen = 0; screen < currentDisplayDriver->num_cyclic_screens; screen++)
+  {
+    currentDisplayDriver->current_cyclic_screen = screen;
+    drawScreen(screen, "first");
+    drawScreen(screen, "again");
+  }
+
+  if (!writeReport())
+  {
+    fprintf(stderr, "Cannot write %s/report.json\n", outputDir.c_str());
+    return 1;
+  }
+
+  for (const frame_record &r : records)
+    printf("[FRAME] screen %-8s %-6s %5u calls %5u pushes %8llu px %9llu bytes %8ld us\n",
+           r.screen.c_str(), r.pass, r.stats.drawCalls, r.stats.pushes,
+           (unsigned long long)r.stats.pixels, (unsigned long long)r.stats.bytes, r.us);
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include "png.h"
+
+#include <stdio.h>
+#include <vector>
+#include <zlib.h>
+
+static void put32(std::vector<uint8_t> &out, uint32_t v)
+{
+  out.push_back(v >> 24);
+  out.push_back(v >> 16);
+  out.push_back(v >> 8);
+  out.push_back(v);
+}
+
+static void chunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data)
+{
+  put32(out, data.size());
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  put32(out, crc32(0L, out.data() + start, out.size() - start));
+}
+
+bool writePng(const char *path, const uint16_t *pixels, int32_t width, int32_t height)
+{
+  // Rows of filter type 0 followed by the pixels, 5/6 bit channels scaled to 8
+  std::vector<uint8_t> raw;
+  raw.reserve((size_t)height * (width * 3 + 1));
+  for (int32_t y = 0; y < height; y++)
+  {
+    raw.push_back(0);
+    for (int32_t x = 0; x < width; x++)
+    {
+      uint16_t c = pixels[(size_t)y * width + x];
+      raw.push_back(((c >> 11) & 0x1F) * 255 / 31);
+      raw.push_back(((c >> 5) & 0x3F) * 255 / 63);
+      raw.push_back((c & 0x1F) * 255 / 31);
+    }
+  }
+
+  uLongf size = compressBound(raw.size());
+  std::vector<uint8_t> idat(size);
+  if (compress2(idat.data(), &size, raw.data(), raw.size(), Z_BEST_COMPRESSION) != Z_OK) return false;
+  idat.resize(size);
+
+  std::vector<uint8_t> ihdr;
+  put32(ihdr, width);
+  put32(ihdr, height);
+  ihdr.push_back(8);      // Bit depth
+  ihdr.push_back(2);      // Truecolour
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+
+  static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> out(signature, signature + sizeof(signature));
+  chunk(out, "IHDR", ihdr);
+  chunk(out, "IDAT", idat);
+  chunk(out, "IEND", std::vector<uint8_t>());
+
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) return false;
+  bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+  return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,9 @@
+#ifndef NATIVE_PNG_H
+#define NATIVE_PNG_H
+
+#include <stdint.h>
+
+// Writes an RGB565 image as an 8 bit RGB PNG, false on an I/O error
+bool writePng(const char *path, const uint16_t *pixels, int32_t width, int32_t height);
+
+#endif // NATIVE_PNG_H
@@ -0,0 +1,132 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <WiFi.h>
+#include <stdarg.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI(VSPI);
+WiFiClass WiFi;
+
+static uint8_t pinLevels[64];
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  if (pin < sizeof(pinLevels)) pinLevels[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pin < sizeof(pinLevels) ? pinLevels[pin] : LOW;
+}
+
+// Mid scale, about 2 V on the battery dividers
+uint16_t analogRead(uint8_t pin)
+{
+  return 2048;
+}
+
+bool psramFound(void)
+{
+  return true;
+}
+
+float temperatureRead(void)
+{
+  return 45;
+}
+
+void yield(void)
+{
+}
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = 0;
+  }
+  return len;
+}
+#endif
+
+String::String(double v, unsigned int decimals)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+  s_ = buf;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if ((size_t)len < sizeof(buf)) return write((const uint8_t *)buf, len);
+
+  char *big = (char *)malloc(len + 1);
+  if (big == NULL) return 0;
+  va_start(args, format);
+  vsnprintf(big, len + 1, format, args);
+  va_end(args);
+  size_t n = write((const uint8_t *)big, len);
+  free(big);
+  return n;
+}
+
+size_t Print::print(long v, int base)
+{
+  return base == HEX ? printf("%lX", v) : printf("%ld", v);
+}
+
+size_t Print::print(unsigned long v, int base)
+{
+  return base == HEX ? printf("%lX", v) : printf("%lu", v);
+}
+
+size_t Print::print(long long v, int base)
+{
+  return base == HEX ? printf("%llX", v) : printf("%lld", v);
+}
+
+size_t Print::print(unsigned long long v, int base)
+{
+  return base == HEX ? printf("%llX", v) : printf("%llu", v);
+}
+
+size_t Print::print(double v, int digits)
+{
+  return printf("%.*f", digits, v);
+}
+
+void HardwareSerial::flush(void)
+{
+  fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  return fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,181 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino-ESP32 core the display drivers use.
+// Time is virtual: it only moves when the harness (or a task delay) moves it, so
+// every run draws the same frames. Also included from C by LVGL's tick source.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT         0x01
+#define OUTPUT        0x03
+#define INPUT_PULLUP  0x05
+
+#define PI         3.1415926535897932384626433832795
+#define HALF_PI    1.5707963267948966192313216916398
+#define TWO_PI     6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define PROGMEM
+#define F(string_literal) (string_literal)
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+bool psramFound(void);
+float temperatureRead(void);
+void yield(void);
+
+class String
+{
+public:
+  String(const char *s = "") : s_(s ? s : "") {}
+  String(const std::string &s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v) : s_(std::to_string(v)) {}
+  explicit String(unsigned int v) : s_(std::to_string(v)) {}
+  explicit String(long v) : s_(std::to_string(v)) {}
+  explicit String(unsigned long v) : s_(std::to_string(v)) {}
+  explicit String(double v, unsigned int decimals = 2);
+
+  const char *c_str() const { return s_.c_str(); }
+  unsigned int length() const { return s_.length(); }
+  int toInt() const { return atoi(s_.c_str()); }
+  char operator[](unsigned int i) const { return i < s_.length() ? s_[i] : 0; }
+
+  String &operator+=(const String &rhs) { s_ += rhs.s_; return *this; }
+  String &operator+=(const char *rhs) { s_ += rhs; return *this; }
+  String &operator+=(char rhs) { s_ += rhs; return *this; }
+
+  friend String operator+(const String &a, const String &b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String &a, const char *b) { return String(a.s_ + b); }
+  friend String operator+(const char *a, const String &b) { return String(a + b.s_); }
+
+  bool operator==(const String &rhs) const { return s_ == rhs.s_; }
+  bool operator==(const char *rhs) const { return s_ == rhs; }
+  bool operator!=(const String &rhs) const { return s_ != rhs.s_; }
+  bool operator!=(const char *rhs) const { return s_ != rhs; }
+
+private:
+  std::string s_;
+};
+
+class Print;
+
+class Printable
+{
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+#define DEC 10
+#define HEX 16
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(long long v, int base = DEC);
+  size_t print(unsigned long long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+  size_t print(const Printable &p) { return p.printTo(*this); }
+
+  size_t println(void) { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T &v) { size_t n = print(v); return n + println(); }
+  template <typename T>
+  size_t println(const T &v, int format) { size_t n = print(v, format); return n + println(); }
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud) {}
+  void flush(void);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+  const char *getChipModel(void) { return "ESP32-D0WDQ6"; }
+  uint8_t getChipRevision(void) { return 1; }
+  uint32_t getCpuFreqMHz(void) { return 240; }
+  uint32_t getFlashChipSize(void) { return 4 * 1024 * 1024; }
+  uint32_t getHeapSize(void) { return 320 * 1024; }
+  uint32_t getFreeHeap(void) { return 180 * 1024; }
+  uint32_t getMinFreeHeap(void) { return 150 * 1024; }
+  uint32_t getPsramSize(void) { return 0; }
+  void restart(void) { exit(0); }
+};
+
+extern EspClass ESP;
+
+#endif // __cplusplus
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,6 @@
+#ifndef NATIVE_ARDUINOJSON_H
+#define NATIVE_ARDUINOJSON_H
+
+// Included through nvMemory.h, nothing the drivers draw is parsed from JSON
+
+#endif // NATIVE_ARDUINOJSON_H
@@ -0,0 +1,6 @@
+#ifndef NATIVE_DNSSERVER_H
+#define NATIVE_DNSSERVER_H
+
+// Included through wManager.h, the portal does not run in the harness
+
+#endif // NATIVE_DNSSERVER_H
@@ -0,0 +1,15 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+// No file system on the host, the drivers only include it
+
+#include <Arduino.h>
+
+namespace fs
+{
+class FS
+{
+};
+}
+
+#endif // NATIVE_FS_H
@@ -0,0 +1,44 @@
+#include "FastLED.h"
+
+CFastLED FastLED;
+
+// nscale8_video: a channel that was on stays on
+static uint8_t scaleVideo(uint8_t value, uint8_t scale)
+{
+  return ((value * scale) >> 8) + ((value && scale) ? 1 : 0);
+}
+
+CRGB &CRGB::fadeLightBy(uint8_t fadefactor)
+{
+  uint8_t scale = 255 - fadefactor;
+  r = scaleVideo(r, scale);
+  g = scaleVideo(g, scale);
+  b = scaleVideo(b, scale);
+  return *this;
+}
+
+void CFastLED::add(CRGB *data, int count)
+{
+  leds = data;
+  ledCount = count;
+}
+
+void CFastLED::show(void)
+{
+  if (leds == NULL) return;
+  PANEL_CALL();
+  panelCount(ledCount, ledCount * 3);
+
+#ifdef PANEL_LEDS
+  uint8_t r = scaleVideo(leds[0].r, brightness);
+  uint8_t g = scaleVideo(leds[0].g, brightness);
+  uint8_t b = scaleVideo(leds[0].b, brightness);
+  panelPaint(0, 0, panelWidth(), panelHeight(), ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+#endif
+}
+
+void CFastLED::clear(bool writeData)
+{
+  for (int i = 0; i < ledCount; i++) leds[i] = CRGB();
+  if (writeData) show();
+}
@@ -0,0 +1,47 @@
+#ifndef NATIVE_FASTLED_H
+#define NATIVE_FASTLED_H
+
+// Host stand-in for FastLED. Every show() is a draw call and one push of 3
+// bytes per LED. With PANEL_LEDS the first LED is also painted over the whole
+// panel, so boards with only a status LED still get a frame to look at.
+
+#include <Arduino.h>
+#include "panel.h"
+
+enum EOrder { RGB, RBG, GRB, GBR, BRG, BGR };
+enum ESPIChipsets { APA102, WS2812B, WS2812, NEOPIXEL, SK6812 };
+
+struct CRGB
+{
+  uint8_t r, g, b;
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+
+  CRGB &setRGB(uint8_t nr, uint8_t ng, uint8_t nb) { r = nr; g = ng; b = nb; return *this; }
+  CRGB &fadeLightBy(uint8_t fadefactor);
+};
+
+class CFastLED
+{
+public:
+  template <ESPIChipsets CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  void addLeds(CRGB *data, int count) { add(data, count); }
+  template <ESPIChipsets CHIPSET, uint8_t DATA_PIN, uint8_t CLOCK_PIN, EOrder RGB_ORDER>
+  void addLeds(CRGB *data, int count) { add(data, count); }
+
+  void setBrightness(uint8_t scale) { brightness = scale; }
+  void show(void);
+  void clear(bool writeData = false);
+
+private:
+  void add(CRGB *data, int count);
+
+  CRGB *leds = NULL;
+  int ledCount = 0;
+  uint8_t brightness = 255;
+};
+
+extern CFastLED FastLED;
+
+#endif // NATIVE_FASTLED_H
@@ -0,0 +1,168 @@
+#ifndef NATIVE_LOVYANGFX_HPP
+#define NATIVE_LOVYANGFX_HPP
+
+// Host stand-in for the parts of LovyanGFX the WT32 driver uses: the device
+// configuration is accepted as is and the panel is the shim framebuffer.
+// DMA pushes complete before pushImageDMA() returns.
+
+#include <Arduino.h>
+#include "panel.h"
+
+#define VSPI_HOST       2
+#define SPI_DMA_CH_AUTO 3
+
+namespace lgfx
+{
+
+// RGB565 in the byte order sent to the panel
+struct swap565_t
+{
+  uint16_t raw;
+};
+
+class Bus_SPI
+{
+public:
+  struct config_t
+  {
+    int spi_host = VSPI_HOST;
+    uint8_t spi_mode = 0;
+    uint32_t freq_write = 16000000;
+    uint32_t freq_read = 8000000;
+    bool spi_3wire = true;
+    bool use_lock = true;
+    int dma_channel = 0;
+    int16_t pin_sclk = -1, pin_mosi = -1, pin_miso = -1, pin_dc = -1;
+  };
+
+  config_t config(void) const { return cfg; }
+  void config(const config_t &c) { cfg = c; }
+
+private:
+  config_t cfg;
+};
+
+class Bus_Parallel8
+{
+public:
+  struct config_t
+  {
+    uint8_t port = 0;
+    uint32_t freq_write = 16000000;
+    int16_t pin_wr = -1, pin_rd = -1, pin_rs = -1;
+    int16_t pin_d0 = -1, pin_d1 = -1, pin_d2 = -1, pin_d3 = -1;
+    int16_t pin_d4 = -1, pin_d5 = -1, pin_d6 = -1, pin_d7 = -1;
+  };
+
+  config_t config(void) const { return cfg; }
+  void config(const config_t &c) { cfg = c; }
+
+private:
+  config_t cfg;
+};
+
+class Light_PWM
+{
+public:
+  struct config_t
+  {
+    int16_t pin_bl = -1;
+    bool invert = false;
+    uint32_t freq = 1200;
+    uint8_t pwm_channel = 7;
+  };
+
+  config_t config(void) const { return cfg; }
+  void config(const config_t &c) { cfg = c; }
+
+private:
+  config_t cfg;
+};
+
+class Touch_FT5x06
+{
+public:
+  struct config_t
+  {
+    uint16_t x_min = 0, x_max = 4095, y_min = 0, y_max = 4095;
+    int16_t pin_int = -1;
+    bool bus_shared = true;
+    uint8_t offset_rotation = 0;
+    int8_t i2c_port = 0;
+    uint8_t i2c_addr = 0x38;
+    int16_t pin_sda = -1, pin_scl = -1;
+    uint32_t freq = 400000;
+  };
+
+  config_t config(void) const { return cfg; }
+  void config(const config_t &c) { cfg = c; }
+
+private:
+  config_t cfg;
+};
+
+class Panel_ST7796
+{
+public:
+  struct config_t
+  {
+    int16_t pin_cs = -1, pin_rst = -1, pin_busy = -1;
+    uint16_t memory_width = 320, memory_height = 480;
+    uint16_t panel_width = 320, panel_height = 480;
+    uint16_t offset_x = 0, offset_y = 0;
+    uint8_t offset_rotation = 0;
+    uint8_t dummy_read_pixel = 8, dummy_read_bits = 1;
+    bool readable = true, invert = false, rgb_order = false, dlen_16bit = false, bus_shared = true;
+  };
+
+  config_t config(void) const { return cfg; }
+  void config(const config_t &c) { cfg = c; }
+
+  template <class Bus>
+  void setBus(Bus *bus) {}
+  void setLight(Light_PWM *light) {}
+  void setTouch(Touch_FT5x06 *touch) {}
+
+private:
+  config_t cfg;
+};
+
+class LGFX_Device
+{
+public:
+  void setPanel(Panel_ST7796 *p) { panel = p; }
+
+  bool init(void) { return true; }
+  bool initDMA(void) { return true; }
+  void startWrite(void) { startCount++; }
+  void endWrite(void) { if (startCount > 0) startCount--; }
+  uint32_t getStartCount(void) { return startCount; }
+
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t *data)
+  {
+    PANEL_CALL();
+    panelWrite(x, y, w, h, (const uint16_t *)data, w, true);
+  }
+  bool dmaBusy(void) { return false; }
+  void waitDMA(void) {}
+
+  bool getTouch(uint16_t *x, uint16_t *y) { return false; }
+  void setBrightness(uint8_t brightness) {}
+
+  void setRotation(uint8_t r) { rotation = r & 7; }
+  uint8_t getRotation(void) { return rotation; }
+  int32_t width(void) { return (rotation & 1) ? rawHeight() : rawWidth(); }
+  int32_t height(void) { return (rotation & 1) ? rawWidth() : rawHeight(); }
+
+private:
+  int32_t rawWidth(void) { return panel ? panel->config().panel_width : 0; }
+  int32_t rawHeight(void) { return panel ? panel->config().panel_height : 0; }
+
+  Panel_ST7796 *panel = NULL;
+  uint32_t startCount = 0;
+  uint8_t rotation = 0;
+};
+
+} // namespace lgfx
+
+#endif // NATIVE_LOVYANGFX_HPP
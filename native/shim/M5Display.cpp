@@ -0,0 +1,20 @@
+#include "M5Display.h"
+
+M5Class M5;
+
+void M5Display::progressBar(int x, int y, int w, int h, uint8_t val)
+{
+  PANEL_CALL();
+  drawRect(x, y, w, h, 0x09F1);
+  fillRect(x + 1, y + 1, w * (((float)val) / 100.0), h - 1, 0x09F1);
+}
+
+// Images are stored byte swapped, whatever the current setting
+void M5Display::drawBitmap(int16_t x0, int16_t y0, int16_t w, int16_t h, const uint16_t *data)
+{
+  PANEL_CALL();
+  bool swap = getSwapBytes();
+  setSwapBytes(true);
+  pushImage(x0, y0, w, h, data);
+  setSwapBytes(swap);
+}
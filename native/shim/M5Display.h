@@ -0,0 +1,64 @@
+#ifndef NATIVE_M5DISPLAY_H
+#define NATIVE_M5DISPLAY_H
+
+// What the M5Stack and M5StickC libraries add on top of their TFT_eSPI copy,
+// shared by M5Stack.h and M5StickC.h
+
+#include <TFT_eSPI.h>
+
+#define BLACK       0x0000
+#define NAVY        0x000F
+#define DARKGREEN   0x03E0
+#define DARKCYAN    0x03EF
+#define MAROON      0x7800
+#define PURPLE      0x780F
+#define OLIVE       0x7BE0
+#define LIGHTGREY   0xC618
+#define DARKGREY    0x7BEF
+#define BLUE        0x001F
+#define GREEN       0x07E0
+#define CYAN        0x07FF
+#define RED         0xF800
+#define MAGENTA     0xF81F
+#define YELLOW      0xFFE0
+#define WHITE       0xFFFF
+#define ORANGE      0xFD20
+#define GREENYELLOW 0xAFE5
+#define PINK        0xF81F
+
+#define ST7735_DISPOFF 0x28
+#define ST7735_DISPON  0x29
+
+class M5Display : public TFT_eSPI
+{
+public:
+  void progressBar(int x, int y, int w, int h, uint8_t val);
+  void drawBitmap(int16_t x0, int16_t y0, int16_t w, int16_t h, const uint16_t *data);
+};
+
+class M5Power
+{
+public:
+  bool begin(void) { return true; }
+};
+
+// Backlight through the power chip, not the panel
+class M5Axp
+{
+public:
+  void ScreenBreath(uint8_t brightness) {}
+};
+
+class M5Class
+{
+public:
+  void begin(bool lcdEnable = true, bool powerEnable = true, bool serialEnable = true) { Lcd.begin(); }
+
+  M5Display Lcd;
+  M5Power Power;
+  M5Axp Axp;
+};
+
+extern M5Class M5;
+
+#endif // NATIVE_M5DISPLAY_H
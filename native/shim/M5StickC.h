@@ -0,0 +1,6 @@
+#ifndef NATIVE_M5STICKC_H
+#define NATIVE_M5STICKC_H
+
+#include "M5Display.h"
+
+#endif // NATIVE_M5STICKC_H
@@ -0,0 +1,173 @@
+#include "OpenFontRender.h"
+
+OpenFontRender::OpenFontRender()
+{
+}
+
+OpenFontRender::~OpenFontRender()
+{
+  if (_face != NULL) FT_Done_Face(_face);
+  if (_library != NULL) FT_Done_FreeType(_library);
+}
+
+FT_Error OpenFontRender::loadFont(const unsigned char *data, size_t size, uint8_t target)
+{
+  FT_Error error;
+  if (_library == NULL && (error = FT_Init_FreeType(&_library)) != 0) return error;
+  if (_face != NULL) FT_Done_Face(_face);
+  _face = NULL;
+  return FT_New_Memory_Face(_library, data, size, 0, &_face);
+}
+
+// Ink of the string relative to the pen start on the baseline, exclusive max
+bool OpenFontRender::inkBox(const char *str, unsigned int size, FT_BBox &box)
+{
+  if (_face == NULL) return false;
+  FT_Set_Pixel_Sizes(_face, 0, size);
+
+  int32_t pen = 0;
+  box.xMin = box.yMin = INT32_MAX;
+  box.xMax = box.yMax = INT32_MIN;
+  for (const char *p = str; *p; p++)
+  {
+    FT_UInt charIndex = FT_Get_Char_Index(_face, (uint8_t)*p);
+    if (charIndex == 0 || FT_Load_Glyph(_face, charIndex, FT_LOAD_RENDER) != 0) continue;
+    FT_GlyphSlot slot = _face->glyph;
+    if (slot->bitmap.width > 0 && slot->bitmap.rows > 0)
+    {
+      box.xMin = min(box.xMin, (FT_Pos)(pen + slot->bitmap_left));
+      box.xMax = max(box.xMax, (FT_Pos)(pen + slot->bitmap_left + (int32_t)slot->bitmap.width));
+      box.yMin = min(box.yMin, (FT_Pos)-slot->bitmap_top);
+      box.yMax = max(box.yMax, (FT_Pos)(-slot->bitmap_top + (int32_t)slot->bitmap.rows));
+    }
+    pen += slot->advance.x >> 6;
+  }
+  return box.xMax > box.xMin;
+}
+
+// Top-left corner of the ink box for the alignment
+void OpenFontRender::origin(const FT_BBox &ink, int32_t x, int32_t y, Align align, int32_t &ox, int32_t &oy)
+{
+  int32_t w = ink.xMax - ink.xMin;
+  int32_t h = ink.yMax - ink.yMin;
+  ox = x;
+  oy = y;
+
+  switch (align)
+  {
+  case Align::Center: case Align::TopCenter: case Align::MiddleCenter: case Align::BottomCenter:
+    ox = x - w / 2;
+    break;
+  case Align::Right: case Align::TopRight: case Align::MiddleRight: case Align::BottomRight:
+    ox = x - w;
+    break;
+  default:
+    break;
+  }
+
+  switch (align)
+  {
+  case Align::MiddleLeft: case Align::MiddleCenter: case Align::MiddleRight:
+    oy = y - h / 2;
+    break;
+  case Align::BottomLeft: case Align::BottomCenter: case Align::BottomRight:
+    oy = y - h;
+    break;
+  default:
+    break;
+  }
+}
+
+FT_BBox OpenFontRender::calculateBoundingBox(int32_t x, int32_t y, unsigned int fontSize, Align align, Layout layout, const char *str)
+{
+  FT_BBox ink, box = {x, y, x, y};
+  if (!inkBox(str, fontSize, ink)) return box;
+
+  int32_t ox, oy;
+  origin(ink, x, y, align, ox, oy);
+  box.xMin = ox;
+  box.yMin = oy;
+  box.xMax = ox + (ink.xMax - ink.xMin) - 1;
+  box.yMax = oy + (ink.yMax - ink.yMin) - 1;
+  return box;
+}
+
+uint16_t OpenFontRender::drawString(const char *str, int32_t x, int32_t y, uint16_t fg, uint16_t bg, Layout layout)
+{
+  PANEL_CALL();
+  FT_BBox ink;
+  if (_drawer == NULL || !inkBox(str, _size, ink)) return 0;
+
+  int32_t ox, oy;
+  origin(ink, x, y, _align, ox, oy);
+  int32_t pen = ox - ink.xMin;
+  int32_t baseline = oy - ink.yMin;
+
+  for (const char *p = str; *p; p++)
+  {
+    FT_UInt charIndex = FT_Get_Char_Index(_face, (uint8_t)*p);
+    if (charIndex == 0 || FT_Load_Glyph(_face, charIndex, FT_LOAD_RENDER) != 0) continue;
+    FT_GlyphSlot slot = _face->glyph;
+    FT_Bitmap &bitmap = slot->bitmap;
+
+    for (unsigned int row = 0; row < bitmap.rows; row++)
+    {
+      const uint8_t *alpha = bitmap.buffer + row * bitmap.pitch;
+      int32_t py = baseline - slot->bitmap_top + (int32_t)row;
+      for (unsigned int col = 0; col < bitmap.width; col++)
+      {
+        if (alpha[col] == 0) continue;
+        int32_t px = pen + slot->bitmap_left + (int32_t)col;
+        uint16_t color = fg;
+        if (alpha[col] < 255) color = _drawer->alphaBlend(alpha[col], fg, _drawer->readPixel(px, py));
+        _drawer->drawPixel(px, py, color);
+      }
+    }
+    pen += slot->advance.x >> 6;
+  }
+  return ink.xMax - ink.xMin;
+}
+
+uint16_t OpenFontRender::drawString(const char *str, int32_t x, int32_t y)
+{
+  return drawString(str, x, y, _fg, _bg);
+}
+
+uint16_t OpenFontRender::drawString(const char *str, int32_t x, int32_t y, uint16_t fg)
+{
+  return drawString(str, x, y, fg, _bg);
+}
+
+uint16_t OpenFontRender::cdrawString(const char *str, int32_t x, int32_t y, uint16_t fg, uint16_t bg, Layout layout)
+{
+  Align saved = _align;
+  _align = Align::TopCenter;
+  uint16_t w = drawString(str, x, y, fg, bg, layout);
+  _align = saved;
+  return w;
+}
+
+uint16_t OpenFontRender::cdrawString(const char *str, int32_t x, int32_t y, uint16_t fg)
+{
+  return cdrawString(str, x, y, fg, _bg);
+}
+
+uint16_t OpenFontRender::rdrawString(const char *str, int32_t x, int32_t y, uint16_t fg, uint16_t bg, Layout layout)
+{
+  Align saved = _align;
+  _align = Align::TopRight;
+  uint16_t w = drawString(str, x, y, fg, bg, layout);
+  _align = saved;
+  return w;
+}
+
+uint16_t OpenFontRender::rdrawString(const char *str, int32_t x, int32_t y, uint16_t fg)
+{
+  return rdrawString(str, x, y, fg, _bg);
+}
+
+uint16_t OpenFontRender::drawChar(char character, int32_t x, int32_t y, uint16_t fg)
+{
+  char str[2] = {character, 0};
+  return drawString(str, x, y, fg, _bg);
+}
@@ -0,0 +1,79 @@
+#ifndef NATIVE_OPENFONTRENDER_H
+#define NATIVE_OPENFONTRENDER_H
+
+// Host stand-in for OpenFontRender on the system FreeType. Strings are placed
+// by their ink box like the library does: the alignment picks which corner or
+// edge of the box lands on (x, y). Anti-aliased pixels are blended with what
+// the drawer already holds.
+
+#include <TFT_eSPI.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+enum class Align
+{
+  Left,
+  Center,
+  Right,
+  TopLeft,
+  TopCenter,
+  TopRight,
+  MiddleLeft,
+  MiddleCenter,
+  MiddleRight,
+  BottomLeft,
+  BottomCenter,
+  BottomRight,
+};
+
+enum class Layout
+{
+  Horizontal,
+  Vertical,
+};
+
+class OpenFontRender
+{
+public:
+  OpenFontRender();
+  ~OpenFontRender();
+
+  void setDrawer(TFT_eSPI &drawer) { _drawer = &drawer; }
+  FT_Error loadFont(const unsigned char *data, size_t size, uint8_t target = 0);
+
+  void setCursor(int32_t x, int32_t y) { _cursorX = x; _cursorY = y; }
+  void setFontColor(uint16_t fg) { _fg = fg; }
+  void setFontColor(uint16_t fg, uint16_t bg) { _fg = fg; _bg = bg; }
+  void setFontSize(unsigned int size) { _size = size; }
+  unsigned int getFontSize(void) { return _size; }
+  void setLineSpaceRatio(double ratio) { _lineSpaceRatio = ratio; }
+  void setAlignment(Align align) { _align = align; }
+  Align getAlignment(void) { return _align; }
+
+  uint16_t drawString(const char *str, int32_t x, int32_t y);
+  uint16_t drawString(const char *str, int32_t x, int32_t y, uint16_t fg);
+  uint16_t drawString(const char *str, int32_t x, int32_t y, uint16_t fg, uint16_t bg, Layout layout = Layout::Horizontal);
+  uint16_t cdrawString(const char *str, int32_t x, int32_t y, uint16_t fg);
+  uint16_t cdrawString(const char *str, int32_t x, int32_t y, uint16_t fg, uint16_t bg, Layout layout = Layout::Horizontal);
+  uint16_t rdrawString(const char *str, int32_t x, int32_t y, uint16_t fg);
+  uint16_t rdrawString(const char *str, int32_t x, int32_t y, uint16_t fg, uint16_t bg, Layout layout = Layout::Horizontal);
+  uint16_t drawChar(char character, int32_t x, int32_t y, uint16_t fg);
+
+  // Inclusive box the string covers when drawn at (x, y)
+  FT_BBox calculateBoundingBox(int32_t x, int32_t y, unsigned int fontSize, Align align, Layout layout, const char *str);
+
+private:
+  bool inkBox(const char *str, unsigned int size, FT_BBox &box);
+  void origin(const FT_BBox &ink, int32_t x, int32_t y, Align align, int32_t &ox, int32_t &oy);
+
+  TFT_eSPI *_drawer = NULL;
+  FT_Library _library = NULL;
+  FT_Face _face = NULL;
+  int32_t _cursorX = 0, _cursorY = 0;
+  uint16_t _fg = 0xFFFF, _bg = 0x0000;
+  unsigned int _size = 44;
+  double _lineSpaceRatio = 1.0;
+  Align _align = Align::TopLeft;
+};
+
+#endif // NATIVE_OPENFONTRENDER_H
@@ -0,0 +1,6 @@
+#ifndef NATIVE_SPIFFS_H
+#define NATIVE_SPIFFS_H
+
+#include "FS.h"
+
+#endif // NATIVE_SPIFFS_H
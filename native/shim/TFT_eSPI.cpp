@@ -0,0 +1,667 @@
+#include "TFT_eSPI.h"
+
+// Built in fonts, only this file includes them like in the library
+#include <Fonts/glcdfont.c>
+#include <Fonts/Font16.h>
+#include <Fonts/Font32rle.h>
+#include <Fonts/Font64rle.h>
+#include <Fonts/Font7srle.h>
+#include <Fonts/Font72rle.h>
+
+static const unsigned char *const glcdFont = font;
+
+typedef struct {
+  const unsigned char *const *chartbl;
+  const unsigned char *widthtbl;
+  uint8_t height;
+  uint8_t baseline;
+} fontinfo;
+
+static const fontinfo fontdata[] = {
+    {NULL, NULL, 0, 0},
+    {NULL, NULL, 8, 7},   // GLCD
+    {chrtbl_f16, widtbl_f16, chr_hgt_f16, baseline_f16},
+    {NULL, NULL, 0, 0},
+    {chrtbl_f32, widtbl_f32, chr_hgt_f32, baseline_f32},
+    {NULL, NULL, 0, 0},
+    {chrtbl_f64, widtbl_f64, chr_hgt_f64, baseline_f64},
+    {chrtbl_f7s, widtbl_f7s, chr_hgt_f7s, baseline_f7s},
+    {chrtbl_f72, widtbl_f72, chr_hgt_f72, baseline_f72},
+};
+
+#define MAX_GLYPH_PIXELS (96 * 96)
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _width(w), _height(h)
+{
+}
+
+void TFT_eSPI::invertDisplay(bool i)
+{
+  panelCommand(1);
+}
+
+void TFT_eSPI::writecommand(uint8_t c)
+{
+  panelCommand(1);
+}
+
+void TFT_eSPI::writedata(uint8_t d)
+{
+  panelCommand(1);
+}
+
+// The screen: every primitive is a window sent to the panel
+
+void TFT_eSPI::fillArea(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+  panelFill(x, y, w, h, color);
+}
+
+void TFT_eSPI::writeArea(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, int32_t stride, bool swap)
+{
+  // Without swapBytes the bytes go out as they sit in memory
+  panelWrite(x, y, w, h, data, stride, !swap);
+}
+
+uint16_t TFT_eSPI::readArea(int32_t x, int32_t y)
+{
+  return panelRead(x, y);
+}
+
+bool TFT_eSPI::clip(int32_t &x, int32_t &y, int32_t &w, int32_t &h)
+{
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > _width) w = _width - x;
+  if (y + h > _height) h = _height - y;
+  return w > 0 && h > 0;
+}
+
+void TFT_eSPI::fillClipped(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+  if (clip(x, y, w, h)) fillArea(x, y, w, h, color);
+}
+
+void TFT_eSPI::pushClipped(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, bool swap)
+{
+  int32_t dx = x < 0 ? -x : 0;
+  int32_t dy = y < 0 ? -y : 0;
+  int32_t stride = w;
+  if (clip(x, y, w, h)) writeArea(x, y, w, h, data + (size_t)dy * stride + dx, stride, swap);
+}
+
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, uint16_t *buffer)
+{
+  PANEL_CALL();
+  pushClipped(x, y, w, h, data, swapBytes);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+  PANEL_CALL();
+  fillClipped(x, y, 1, 1, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+  PANEL_CALL();
+  fillClipped(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+  PANEL_CALL();
+  fillClipped(x, y, 1, h, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+  PANEL_CALL();
+  fillClipped(x, y, w, h, color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+  PANEL_CALL();
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color);
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::fillScreen(uint32_t color)
+{
+  PANEL_CALL();
+  fillClipped(0, 0, _width, _height, color);
+}
+
+// Bresenham in horizontal or vertical runs, as the library draws it
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+  PANEL_CALL();
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+  if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+
+  int32_t dx = x1 - x0, dy = abs(y1 - y0);
+  int32_t err = dx >> 1, ystep = y0 < y1 ? 1 : -1, xs = x0, dlen = 0;
+
+  for (; x0 <= x1; x0++)
+  {
+    dlen++;
+    err -= dy;
+    if (err < 0)
+    {
+      if (steep) fillClipped(y0, xs, 1, dlen, color);
+      else fillClipped(xs, y0, dlen, 1, color);
+      dlen = 0;
+      y0 += ystep;
+      xs = x0 + 1;
+      err += dx;
+    }
+  }
+  if (dlen)
+  {
+    if (steep) fillClipped(y0, xs, 1, dlen, color);
+    else fillClipped(xs, y0, dlen, 1, color);
+  }
+}
+
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color)
+{
+  PANEL_CALL();
+  int32_t x = 0;
+  int32_t dx = 1;
+  int32_t dy = r + r;
+  int32_t p = -(r >> 1);
+
+  fillClipped(x0 - r, y0, dy + 1, 1, color);
+  while (x < r)
+  {
+    if (p >= 0)
+    {
+      fillClipped(x0 - x, y0 + r, dx, 1, color);
+      fillClipped(x0 - x, y0 - r, dx, 1, color);
+      dy -= 2;
+      p -= dy;
+      r--;
+    }
+    dx += 2;
+    p += dx;
+    x++;
+    fillClipped(x0 - r, y0 + x, dy + 1, 1, color);
+    fillClipped(x0 - r, y0 - x, dy + 1, 1, color);
+  }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
+{
+  PANEL_CALL();
+  pushClipped(x, y, w, h, data, swapBytes);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+{
+  pushImage(x, y, w, h, (const uint16_t *)data);
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y)
+{
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  return readArea(x, y);
+}
+
+uint16_t TFT_eSPI::color565(uint8_t r, uint8_t g, uint8_t b)
+{
+  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+uint16_t TFT_eSPI::alphaBlend(uint8_t alpha, uint16_t fgc, uint16_t bgc)
+{
+  // Split out and blend 5 bit red and blue channels
+  uint32_t rxb = bgc & 0xF81F;
+  rxb += ((fgc & 0xF81F) - rxb) * (alpha >> 2) >> 6;
+  // Split out and blend 6 bit green channel
+  uint32_t xgx = bgc & 0x07E0;
+  xgx += ((fgc & 0x07E0) - xgx) * alpha >> 8;
+  return (rxb & 0xF81F) | (xgx & 0x07E0);
+}
+
+// Text
+
+void TFT_eSPI::setTextFont(uint8_t font)
+{
+  textfont = (font > 0) ? font : 1;
+  gfxFont = NULL;
+}
+
+void TFT_eSPI::setFreeFont(const GFXfont *f)
+{
+  if (f == NULL)
+  {
+    setTextFont(1);
+    return;
+  }
+  textfont = 1;
+  gfxFont = f;
+
+  // Biggest extents above and below the baseline
+  glyph_ab = 0;
+  glyph_bb = 0;
+  uint16_t numChars = gfxFont->last - gfxFont->first;
+  for (uint16_t c = 0; c < numChars; c++)
+  {
+    const GFXglyph *glyph = &gfxFont->glyph[c];
+    int8_t ab = -glyph->yOffset;
+    if (ab > glyph_ab) glyph_ab = ab;
+    int8_t bb = glyph->height - ab;
+    if (bb > glyph_bb) glyph_bb = bb;
+  }
+}
+
+// Draws a glyph from its coverage mask: the foreground in horizontal runs, or the
+// whole cell in one window when the background is opaque
+void TFT_eSPI::drawGlyphRuns(const uint8_t *mask, int32_t w, int32_t h, int32_t x, int32_t y, bool opaque)
+{
+  int32_t size = textsize;
+  if (opaque)
+  {
+    static uint16_t cell[MAX_GLYPH_PIXELS * 4];
+    if ((size_t)w * h * size * size > sizeof(cell) / sizeof(cell[0])) return;
+    int32_t cw = w * size;
+    for (int32_t row = 0; row < h * size; row++)
+      for (int32_t col = 0; col < cw; col++)
+        cell[row * cw + col] = mask[(row / size) * w + col / size] ? textcolor : textbgcolor;
+    pushClipped(x, y, cw, h * size, cell, true);
+    return;
+  }
+
+  for (int32_t row = 0; row < h; row++)
+  {
+    int32_t run = 0;
+    for (int32_t col = 0; col <= w; col++)
+    {
+      if (col < w && mask[row * w + col])
+      {
+        run++;
+        continue;
+      }
+      if (run) fillClipped(x + (col - run) * size, y + row * size, run * size, size, textcolor);
+      run = 0;
+    }
+  }
+}
+
+// Free font glyph, foreground only with the baseline at y
+void TFT_eSPI::drawGfxChar(int32_t x, int32_t y, uint16_t c, uint16_t color)
+{
+  if (c < gfxFont->first || c > gfxFont->last) return;
+  const GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+  const uint8_t *bitmap = gfxFont->bitmap;
+  uint32_t bo = glyph->bitmapOffset;
+  int32_t w = glyph->width, h = glyph->height;
+  int32_t xo = glyph->xOffset, yo = glyph->yOffset;
+  int32_t size = textsize;
+  uint8_t bits = 0, bit = 0;
+
+  for (int32_t yy = 0; yy < h; yy++)
+  {
+    int32_t hpc = 0;
+    int32_t xx;
+    for (xx = 0; xx < w; xx++)
+    {
+      if (bit == 0)
+      {
+        bits = bitmap[bo++];
+        bit = 0x80;
+      }
+      if (bits & bit) hpc++;
+      else if (hpc)
+      {
+        fillClipped(x + (xo + xx - hpc) * size, y + (yo + yy) * size, hpc * size, size, color);
+        hpc = 0;
+      }
+      bit >>= 1;
+    }
+    if (hpc) fillClipped(x + (xo + xx - hpc) * size, y + (yo + yy) * size, hpc * size, size, color);
+  }
+}
+
+int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
+{
+  PANEL_CALL();
+  bool opaque = textcolor != textbgcolor;
+
+  if (font == 1)
+  {
+    if (gfxFont)
+    {
+      if (uniCode < gfxFont->first || uniCode > gfxFont->last) return 0;
+      drawGfxChar(x, y, uniCode, textcolor);
+      return gfxFont->glyph[uniCode - gfxFont->first].xAdvance * textsize;
+    }
+
+    // GLCD: 5 columns of 8 pixels, LSB at the top, in a 6 x 8 cell
+    uint8_t mask[6 * 8] = {0};
+    for (int32_t i = 0; i < 5; i++)
+    {
+      uint8_t line = glcdFont[(uniCode & 0xFF) * 5 + i];
+      for (int32_t j = 0; j < 8; j++, line >>= 1) mask[j * 6 + i] = line & 0x1;
+    }
+    drawGlyphRuns(mask, 6, 8, x, y, opaque);
+    return 6 * textsize;
+  }
+
+  if (font < 2 || font > 8 || fontdata[font].chartbl == NULL) return 0;
+  if (uniCode < 32 || uniCode > 127) return 0;
+  uniCode -= 32;
+
+  const uint8_t *flash_address = fontdata[font].chartbl[uniCode];
+  int32_t width = fontdata[font].widthtbl[uniCode];
+  int32_t height = fontdata[font].height;
+  if (width * height > MAX_GLYPH_PIXELS) return 0;
+
+  uint8_t mask[MAX_GLYPH_PIXELS] = {0};
+  if (font == 2)
+  {
+    // 1 bit per pixel, MSB first, whole bytes per row
+    int32_t w = (width + 6) / 8;
+    for (int32_t i = 0; i < height; i++)
+      for (int32_t k = 0; k < w; k++)
+      {
+        uint8_t line = flash_address[w * i + k];
+        for (int32_t b = 0; b < 8; b++)
+          if (k * 8 + b < width && (line & (0x80 >> b))) mask[i * width + k * 8 + b] = 1;
+      }
+  }
+  else
+  {
+    // Run length encoded: bit 7 set for a foreground run, length in the low bits plus one
+    int32_t pc = 0;
+    while (pc < width * height)
+    {
+      uint8_t line = *flash_address++;
+      int32_t run = (line & 0x7F) + 1;
+      for (int32_t i = 0; i < run && pc < width * height; i++, pc++) mask[pc] = (line & 0x80) ? 1 : 0;
+    }
+  }
+  drawGlyphRuns(mask, width, height, x, y, opaque);
+  return width * textsize;
+}
+
+int16_t TFT_eSPI::drawString(const char *string, int32_t poX, int32_t poY, uint8_t font)
+{
+  PANEL_CALL();
+  int16_t sumX = 0;
+  int32_t baseline = 0;
+  int32_t cwidth = textWidth(string, font);
+  int32_t cheight = 8 * textsize;
+  bool freeFont = (font == 1 && gfxFont);
+
+  if (freeFont)
+  {
+    cheight = glyph_ab * textsize;
+    poY += cheight;   // Free fonts are drawn from the baseline
+    baseline = cheight;
+    // Allow for the descenders at the bottom of the string
+    if (textdatum == BL_DATUM || textdatum == BC_DATUM || textdatum == BR_DATUM) cheight += glyph_bb * textsize;
+  }
+
+  if (font != 1)
+  {
+    baseline = fontdata[font].baseline * textsize;
+    cheight = fontHeight(font);
+  }
+
+  switch (textdatum)
+  {
+  case TC_DATUM: poX -= cwidth / 2; break;
+  case TR_DATUM: poX -= cwidth; break;
+  case ML_DATUM: poY -= cheight / 2; break;
+  case MC_DATUM: poX -= cwidth / 2; poY -= cheight / 2; break;
+  case MR_DATUM: poX -= cwidth; poY -= cheight / 2; break;
+  case BL_DATUM: poY -= cheight; break;
+  case BC_DATUM: poX -= cwidth / 2; poY -= cheight; break;
+  case BR_DATUM: poX -= cwidth; poY -= cheight; break;
+  case L_BASELINE: poY -= baseline; break;
+  case C_BASELINE: poX -= cwidth / 2; poY -= baseline; break;
+  case R_BASELINE: poX -= cwidth; poY -= baseline; break;
+  }
+
+  if (freeFont && textcolor != textbgcolor && string[0])
+  {
+    // Background box, allowing for a negative offset of the first glyph
+    cheight = (glyph_ab + glyph_bb) * textsize;
+    uint16_t c = (uint8_t)string[0];
+    if (c >= gfxFont->first && c <= gfxFont->last)
+    {
+      int32_t xo = gfxFont->glyph[c - gfxFont->first].xOffset * textsize;
+      if (xo > 0) xo = 0;
+      else cwidth -= xo;
+      fillClipped(poX + xo, poY - glyph_ab * textsize, cwidth, cheight, textbgcolor);
+    }
+  }
+
+  while (*string) sumX += drawChar((uint8_t)*string++, poX + sumX, poY, font);
+  return sumX;
+}
+
+int16_t TFT_eSPI::textWidth(const char *string, uint8_t font)
+{
+  int32_t str_width = 0;
+
+  if (font > 1 && font < 9)
+  {
+    if (fontdata[font].widthtbl == NULL) return 0;
+    const unsigned char *widthtable = fontdata[font].widthtbl - 32;
+    while (*string)
+    {
+      uint8_t uniCode = *string++;
+      if (uniCode > 31 && uniCode < 128) str_width += widthtable[uniCode];
+      else str_width += widthtable[32];   // Illegal character as a space
+    }
+  }
+  else if (gfxFont)
+  {
+    while (*string)
+    {
+      uint16_t uniCode = (uint8_t)*string++;
+      if (uniCode < gfxFont->first || uniCode > gfxFont->last) continue;
+      const GFXglyph *glyph = &gfxFont->glyph[uniCode - gfxFont->first];
+      // The last glyph can be wider than its advance
+      if (*string) str_width += glyph->xAdvance;
+      else str_width += glyph->xOffset + glyph->width;
+    }
+  }
+  else
+  {
+    while (*string++) str_width += 6;
+  }
+  return str_width * textsize;
+}
+
+int16_t TFT_eSPI::fontHeight(int16_t font)
+{
+  if (font < 0 || font > 8) return 0;
+  if (font == 1 && gfxFont) return gfxFont->yAdvance * textsize;
+  return fontdata[font].height * textsize;
+}
+
+size_t TFT_eSPI::write(const uint8_t *buffer, size_t size)
+{
+  PANEL_CALL();
+  return Print::write(buffer, size);
+}
+
+size_t TFT_eSPI::write(uint8_t utf8)
+{
+  PANEL_CALL();
+  uint16_t uniCode = utf8;
+  if (uniCode == '\n') uniCode += 22;   // A valid space for the metrics
+  else if (uniCode < 32) return 1;
+
+  if (!gfxFont)
+  {
+    int32_t cwidth = 0, cheight = 0;
+    if (textfont == 2)
+    {
+      if (uniCode > 127) return 1;
+      // Font 2 is drawn in whole bytes
+      cwidth = (widtbl_f16[uniCode - 32] + 6) / 8 * 8;
+      cheight = chr_hgt_f16;
+    }
+    else if (textfont > 2 && textfont < 9 && fontdata[textfont].widthtbl)
+    {
+      if (uniCode > 127) return 1;
+      cwidth = fontdata[textfont].widthtbl[uniCode - 32];
+      cheight = fontdata[textfont].height;
+    }
+    else if (textfont == 1)
+    {
+      cwidth = 6;
+      cheight = 8;
+    }
+    cheight *= textsize;
+
+    if (utf8 == '\n')
+    {
+      cursor_y += cheight;
+      cursor_x = 0;
+    }
+    else
+    {
+      if (textwrapX && cursor_x + cwidth * textsize > _width)
+      {
+        cursor_y += cheight;
+        cursor_x = 0;
+      }
+      if (textwrapY && cursor_y >= _height) cursor_y = 0;
+      cursor_x += drawChar(uniCode, cursor_x, cursor_y, textfont);
+    }
+    return 1;
+  }
+
+  if (utf8 == '\n')
+  {
+    cursor_x = 0;
+    cursor_y += textsize * gfxFont->yAdvance;
+    return 1;
+  }
+  if (uniCode < gfxFont->first || uniCode > gfxFont->last) return 1;
+
+  const GFXglyph *glyph = &gfxFont->glyph[uniCode - gfxFont->first];
+  if (glyph->width > 0 && glyph->height > 0)
+  {
+    if (textwrapX && cursor_x + textsize * (glyph->xOffset + glyph->width) > _width)
+    {
+      cursor_x = 0;
+      cursor_y += textsize * gfxFont->yAdvance;
+    }
+    if (textwrapY && cursor_y >= _height) cursor_y = 0;
+    drawGfxChar(cursor_x, cursor_y, uniCode, textcolor);
+  }
+  cursor_x += glyph->xAdvance * textsize;
+  return 1;
+}
+
+// Sprites: pixels stay in memory, in the byte order they are sent in
+
+TFT_eSprite::TFT_eSprite(TFT_eSPI *tft) : TFT_eSPI(0, 0), tft(tft)
+{
+}
+
+TFT_eSprite::~TFT_eSprite()
+{
+  deleteSprite();
+}
+
+void *TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames)
+{
+  if (buffer != NULL) return buffer;
+  if (w < 1 || h < 1) return NULL;
+  buffer = (uint16_t *)calloc((size_t)w * h, sizeof(uint16_t));
+  if (buffer == NULL) return NULL;
+  _width = w;
+  _height = h;
+  return buffer;
+}
+
+void TFT_eSprite::deleteSprite(void)
+{
+  free(buffer);
+  buffer = NULL;
+  _width = 0;
+  _height = 0;
+}
+
+// Only 16 bit sprites are drawn here
+void *TFT_eSprite::setColorDepth(int8_t b)
+{
+  if (b != 16) Serial.printf("[TFT_eSprite] %d bit sprites not supported, kept 16 bit\n", b);
+  return buffer;
+}
+
+void TFT_eSprite::fillSprite(uint32_t color)
+{
+  PANEL_CALL();
+  fillClipped(0, 0, _width, _height, color);
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y)
+{
+  PANEL_CALL();
+  if (buffer == NULL) return;
+  bool oldSwapBytes = tft->getSwapBytes();
+  tft->setSwapBytes(false);
+  tft->pushImage(x, y, _width, _height, buffer);
+  tft->setSwapBytes(oldSwapBytes);
+}
+
+bool TFT_eSprite::pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh)
+{
+  PANEL_CALL();
+  if (buffer == NULL) return false;
+
+  // Crop the window to the sprite
+  int32_t xs = max(sx, (int32_t)0), ys = max(sy, (int32_t)0);
+  int32_t xe = min(sx + sw, _width), ye = min(sy + sh, _height);
+  sw = xe - xs;
+  sh = ye - ys;
+  if (sw <= 0 || sh <= 0) return false;
+  tx += xs - sx;
+  ty += ys - sy;
+
+  bool oldSwapBytes = tft->getSwapBytes();
+  tft->setSwapBytes(false);
+  // One block when whole lines go, else line by line
+  if (sx == 0 && sw == _width) tft->pushImage(tx, ty, sw, sh, buffer + (size_t)_width * ys);
+  else
+    while (sh--) tft->pushImage(tx, ty++, sw, 1, buffer + xs + (size_t)_width * ys++);
+  tft->setSwapBytes(oldSwapBytes);
+  return true;
+}
+
+void TFT_eSprite::fillArea(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+  uint16_t wire = panelSwap(color);
+  for (int32_t row = 0; row < h; row++)
+  {
+    uint16_t *p = buffer + (size_t)(y + row) * _width + x;
+    for (int32_t col = 0; col < w; col++) p[col] = wire;
+  }
+}
+
+void TFT_eSprite::writeArea(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, int32_t stride, bool swap)
+{
+  for (int32_t row = 0; row < h; row++)
+  {
+    const uint16_t *src = data + (size_t)row * stride;
+    uint16_t *dst = buffer + (size_t)(y + row) * _width + x;
+    for (int32_t col = 0; col < w; col++) dst[col] = swap ? panelSwap(src[col]) : src[col];
+  }
+}
+
+uint16_t TFT_eSprite::readArea(int32_t x, int32_t y)
+{
+  return panelSwap(buffer[(size_t)y * _width + x]);
+}
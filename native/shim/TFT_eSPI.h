@@ -0,0 +1,208 @@
+#ifndef NATIVE_TFT_ESPI_H
+#define NATIVE_TFT_ESPI_H
+
+// Host stand-in for TFT_eSPI. The screen is the panel framebuffer (panel.h),
+// sprites are memory like on the device: 16 bit pixels kept in the byte order
+// they are sent in, so drivers poking getPointer() see what they would see on
+// the board. Text follows the library: same fonts, datums and metrics.
+// Every outermost drawing call is counted, see PANEL_CALL().
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <User_Setup_Select.h>
+
+#include "panel.h"
+
+#ifndef LOAD_GFXFF
+#define LOAD_GFXFF
+#endif
+#include <Fonts/GFXFF/gfxfont.h>
+#include <User_Setups/User_Custom_Fonts.h>
+
+// Font selectors
+#define GLCD  0
+#define GFXFF 1
+#define FONT2 2
+#define FONT4 4
+#define FONT6 6
+#define FONT7 7
+#define FONT8 8
+
+// Text datums
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define CL_DATUM 3
+#define MC_DATUM 4
+#define CC_DATUM 4
+#define MR_DATUM 5
+#define CR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+#define L_BASELINE 9
+#define C_BASELINE 10
+#define R_BASELINE 11
+
+// Colours, RGB565
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK        0xFE19
+#define TFT_BROWN       0x9A60
+#define TFT_GOLD        0xFEA0
+#define TFT_SILVER      0xC618
+#define TFT_SKYBLUE     0x867D
+#define TFT_VIOLET      0x915C
+#define TFT_TRANSPARENT 0x0120
+
+class TFT_eSPI : public Print
+{
+public:
+  TFT_eSPI(int16_t w = PANEL_WIDTH, int16_t h = PANEL_HEIGHT);
+
+  void init(uint8_t tc = 0) {}
+  void begin(uint8_t tc = 0) { init(tc); }
+
+  // Rotation is kept for the drivers to read back, the frames are captured in the
+  // orientation the env declares
+  void setRotation(uint8_t r) { rotation = r & 3; }
+  uint8_t getRotation(void) { return rotation; }
+
+  void invertDisplay(bool i);
+  void writecommand(uint8_t c);
+  void writedata(uint8_t d);
+  void startWrite(void) {}
+  void endWrite(void) {}
+
+  // DMA transfers end at once
+  bool initDMA(bool ctrl_cs = false) { return true; }
+  void deInitDMA(void) {}
+  void dmaWait(void) {}
+  bool dmaBusy(void) { return false; }
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, uint16_t *buffer = nullptr);
+
+  void setSwapBytes(bool swap) { swapBytes = swap; }
+  bool getSwapBytes(void) { return swapBytes; }
+
+  int16_t width(void) { return _width; }
+  int16_t height(void) { return _height; }
+
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillScreen(uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+
+  uint16_t readPixel(int32_t x, int32_t y);
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b);
+  uint16_t alphaBlend(uint8_t alpha, uint16_t fgc, uint16_t bgc);
+
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  void setCursor(int16_t x, int16_t y, uint8_t font) { setTextFont(font); setCursor(x, y); }
+  int16_t getCursorX(void) { return cursor_x; }
+  int16_t getCursorY(void) { return cursor_y; }
+
+  void setTextColor(uint16_t color) { textcolor = textbgcolor = color; }
+  void setTextColor(uint16_t fgcolor, uint16_t bgcolor, bool bgfill = false) { textcolor = fgcolor; textbgcolor = bgcolor; }
+  void setTextSize(uint8_t size) { textsize = size > 0 ? size : 1; }
+  void setTextWrap(bool wrapX, bool wrapY = false) { textwrapX = wrapX; textwrapY = wrapY; }
+  void setTextDatum(uint8_t datum) { textdatum = datum; }
+  uint8_t getTextDatum(void) { return textdatum; }
+  void setTextPadding(uint16_t x_width) {}
+  void setTextFont(uint8_t font);
+  void setFreeFont(const GFXfont *f = NULL);
+
+  int16_t drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font);
+  int16_t drawChar(uint16_t uniCode, int32_t x, int32_t y) { return drawChar(uniCode, x, y, textfont); }
+  int16_t drawString(const char *string, int32_t x, int32_t y, uint8_t font);
+  int16_t drawString(const char *string, int32_t x, int32_t y) { return drawString(string, x, y, textfont); }
+  int16_t drawString(const String &string, int32_t x, int32_t y, uint8_t font) { return drawString(string.c_str(), x, y, font); }
+  int16_t drawString(const String &string, int32_t x, int32_t y) { return drawString(string.c_str(), x, y, textfont); }
+
+  int16_t textWidth(const char *string, uint8_t font);
+  int16_t textWidth(const char *string) { return textWidth(string, textfont); }
+  int16_t textWidth(const String &string, uint8_t font) { return textWidth(string.c_str(), font); }
+  int16_t textWidth(const String &string) { return textWidth(string.c_str(), textfont); }
+  int16_t fontHeight(int16_t font);
+  int16_t fontHeight(void) { return fontHeight(textfont); }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+protected:
+  // Drawing primitives of the target, already clipped. Colours are RGB565,
+  // images follow the swapBytes convention of pushImage().
+  virtual void fillArea(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+  virtual void writeArea(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, int32_t stride, bool swap);
+  virtual uint16_t readArea(int32_t x, int32_t y);
+
+  bool clip(int32_t &x, int32_t &y, int32_t &w, int32_t &h);
+  void fillClipped(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+  void pushClipped(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, bool swap);
+  void drawGlyphRuns(const uint8_t *mask, int32_t w, int32_t h, int32_t x, int32_t y, bool opaque);
+  void drawGfxChar(int32_t x, int32_t y, uint16_t c, uint16_t color);
+
+  int32_t _width, _height;
+  uint8_t rotation = 0;
+  bool swapBytes = false;
+
+  int32_t cursor_x = 0, cursor_y = 0;
+  uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+  uint8_t textsize = 1, textdatum = TL_DATUM, textfont = 1;
+  bool textwrapX = true, textwrapY = false;
+  const GFXfont *gfxFont = NULL;
+  uint8_t glyph_ab = 0, glyph_bb = 0;
+};
+
+class TFT_eSprite : public TFT_eSPI
+{
+public:
+  explicit TFT_eSprite(TFT_eSPI *tft);
+  ~TFT_eSprite();
+
+  void *createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite(void);
+  bool created(void) { return buffer != NULL; }
+  void *getPointer(void) { return buffer; }
+  void *setColorDepth(int8_t b);
+  int8_t getColorDepth(void) { return colorDepth; }
+
+  void fillSprite(uint32_t color);
+  void pushSprite(int32_t x, int32_t y);
+  bool pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
+
+protected:
+  void fillArea(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override;
+  void writeArea(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, int32_t stride, bool swap) override;
+  uint16_t readArea(int32_t x, int32_t y) override;
+
+  TFT_eSPI *tft;
+  uint16_t *buffer = NULL;
+  int8_t colorDepth = 16;
+};
+
+#endif // NATIVE_TFT_ESPI_H
@@ -0,0 +1,29 @@
+#ifndef NATIVE_TFT_ETOUCH_H
+#define NATIVE_TFT_ETOUCH_H
+
+// Touch controller that is never pressed, screens change through the harness
+
+#include <TFT_eSPI.h>
+
+class TFT_eTouchBase
+{
+public:
+  struct Calibation
+  {
+    int16_t x0, x1, y0, y1;
+    uint8_t rel_rotation;
+  };
+};
+
+template <class T>
+class TFT_eTouch : public TFT_eTouchBase
+{
+public:
+  TFT_eTouch(T &tft, uint8_t cs, uint8_t irq = 0xFF, SPIClass &spi = SPI) {}
+
+  void init(void) {}
+  void setCalibration(Calibation &calibation) {}
+  bool getXY(int16_t &x, int16_t &y) { return false; }
+};
+
+#endif // NATIVE_TFT_ETOUCH_H
@@ -0,0 +1,29 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+// The harness is always connected, on a fixed address
+
+#include <Arduino.h>
+
+#define WL_CONNECTED 3
+
+class IPAddress : public Printable
+{
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+  size_t printTo(Print &p) const override { return p.printf("%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]); }
+
+private:
+  uint8_t octets[4];
+};
+
+class WiFiClass
+{
+public:
+  uint8_t status(void) { return WL_CONNECTED; }
+  IPAddress localIP(void) { return IPAddress(192, 168, 1, 42); }
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
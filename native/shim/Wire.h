@@ -0,0 +1,8 @@
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+// Included by the WT32 driver, the touch controller is the only I2C device
+
+#include <Arduino.h>
+
+#endif // NATIVE_WIRE_H
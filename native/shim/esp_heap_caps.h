@@ -0,0 +1,22 @@
+#ifndef NATIVE_ESP_HEAP_CAPS_H
+#define NATIVE_ESP_HEAP_CAPS_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_EXEC       (1 << 0)
+#define MALLOC_CAP_32BIT      (1 << 1)
+#define MALLOC_CAP_8BIT       (1 << 2)
+#define MALLOC_CAP_DMA        (1 << 3)
+#define MALLOC_CAP_SPIRAM     (1 << 10)
+#define MALLOC_CAP_INTERNAL   (1 << 11)
+#define MALLOC_CAP_DEFAULT    (1 << 12)
+
+// One host heap stands for all the capabilities
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+static inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) { return calloc(n, size); }
+static inline void heap_caps_free(void *ptr) { free(ptr); }
+static inline size_t heap_caps_get_free_size(uint32_t caps) { return 180 * 1024; }
+static inline size_t heap_caps_get_largest_free_block(uint32_t caps) { return 110 * 1024; }
+
+#endif // NATIVE_ESP_HEAP_CAPS_H
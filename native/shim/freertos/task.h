@@ -0,0 +1,29 @@
+#ifndef NATIVE_TASK_H
+#define NATIVE_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+// Tasks are cooperative: one runs at a time, until it calls vTaskDelay
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth,
+                                   void *parameters, UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t coreId);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+BaseType_t xPortGetCoreID(void);
+
+// Harness side: move the virtual clock forward, running the tasks that wake up meanwhile
+void schedulerRun(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_TASK_H
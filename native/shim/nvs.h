@@ -0,0 +1,13 @@
+#ifndef NATIVE_NVS_H
+#define NATIVE_NVS_H
+
+// Declarations only, the harness keeps no settings (see cannedData.cpp)
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+typedef uint32_t nvs_handle_t;
+
+#define ESP_OK 0
+
+#endif // NATIVE_NVS_H
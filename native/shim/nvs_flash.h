@@ -0,0 +1,6 @@
+#ifndef NATIVE_NVS_FLASH_H
+#define NATIVE_NVS_FLASH_H
+
+#include "nvs.h"
+
+#endif // NATIVE_NVS_FLASH_H
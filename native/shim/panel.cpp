@@ -0,0 +1,127 @@
+#include "panel.h"
+
+#include <string.h>
+#include <vector>
+#include <zlib.h>
+
+static std::vector<uint16_t> framebuffer;
+static int32_t fbWidth = 0;
+static int32_t fbHeight = 0;
+static panel_stats stats;
+static int callDepth = 0;
+
+void panelBegin(int32_t width, int32_t height)
+{
+  fbWidth = width;
+  fbHeight = height;
+  framebuffer.assign((size_t)width * height, 0);
+  panelResetStats();
+}
+
+int32_t panelWidth(void)
+{
+  return fbWidth;
+}
+
+int32_t panelHeight(void)
+{
+  return fbHeight;
+}
+
+const uint16_t *panelPixels(void)
+{
+  return framebuffer.data();
+}
+
+uint32_t panelCrc(void)
+{
+  uLong crc = crc32(0L, Z_NULL, 0);
+  return crc32(crc, (const Bytef *)framebuffer.data(), framebuffer.size() * sizeof(uint16_t));
+}
+
+static bool clipWindow(int32_t &x, int32_t &y, int32_t &w, int32_t &h, int32_t &dx, int32_t &dy)
+{
+  dx = dy = 0;
+  if (x < 0) { dx = -x; w += x; x = 0; }
+  if (y < 0) { dy = -y; h += y; y = 0; }
+  if (x + w > fbWidth) w = fbWidth - x;
+  if (y + h > fbHeight) h = fbHeight - y;
+  return w > 0 && h > 0;
+}
+
+static void countWindow(int32_t w, int32_t h)
+{
+  stats.pushes++;
+  stats.pixels += (uint64_t)w * h;
+  stats.bytes += (uint64_t)w * h * 2 + PANEL_WINDOW_BYTES;
+}
+
+void panelPaint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+  int32_t dx, dy;
+  if (!clipWindow(x, y, w, h, dx, dy)) return;
+  for (int32_t row = 0; row < h; row++)
+  {
+    uint16_t *p = &framebuffer[(size_t)(y + row) * fbWidth + x];
+    for (int32_t col = 0; col < w; col++) p[col] = color;
+  }
+}
+
+void panelFill(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+  int32_t dx, dy;
+  if (!clipWindow(x, y, w, h, dx, dy)) return;
+  panelPaint(x, y, w, h, color);
+  countWindow(w, h);
+}
+
+void panelWrite(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, int32_t stride, bool wireOrder)
+{
+  int32_t dx, dy;
+  if (!clipWindow(x, y, w, h, dx, dy)) return;
+  for (int32_t row = 0; row < h; row++)
+  {
+    const uint16_t *src = data + (size_t)(dy + row) * stride + dx;
+    uint16_t *dst = &framebuffer[(size_t)(y + row) * fbWidth + x];
+    for (int32_t col = 0; col < w; col++) dst[col] = wireOrder ? panelSwap(src[col]) : src[col];
+  }
+  countWindow(w, h);
+}
+
+void panelCommand(size_t bytes)
+{
+  stats.bytes += bytes;
+}
+
+void panelCount(uint32_t pixels, size_t bytes)
+{
+  stats.pushes++;
+  stats.pixels += pixels;
+  stats.bytes += bytes;
+}
+
+uint16_t panelRead(int32_t x, int32_t y)
+{
+  if (x < 0 || y < 0 || x >= fbWidth || y >= fbHeight) return 0;
+  return framebuffer[(size_t)y * fbWidth + x];
+}
+
+panel_stats panelStats(void)
+{
+  return stats;
+}
+
+void panelResetStats(void)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+PanelCall::PanelCall()
+{
+  if (callDepth++ == 0) stats.drawCalls++;
+}
+
+PanelCall::~PanelCall()
+{
+  callDepth--;
+}
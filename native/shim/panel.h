@@ -0,0 +1,64 @@
+#ifndef NATIVE_PANEL_H
+#define NATIVE_PANEL_H
+
+// The board's screen on the host: a framebuffer of true RGB565 colours and the
+// cost of what the driver sent to it. A push is one window written to the
+// panel; its bytes are the pixel data plus the CASET/RASET/RAMWR commands.
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Logical size of the screen in the orientation the driver uses, set per env
+#ifndef PANEL_WIDTH
+#define PANEL_WIDTH 0
+#endif
+#ifndef PANEL_HEIGHT
+#define PANEL_HEIGHT 0
+#endif
+
+#define PANEL_WINDOW_BYTES 11
+
+typedef struct {
+  uint32_t drawCalls;   // Graphics calls made by the driver, nested ones not counted
+  uint32_t pushes;      // Windows (or LED strip updates) sent
+  uint64_t pixels;
+  uint64_t bytes;
+} panel_stats;
+
+void panelBegin(int32_t width, int32_t height);
+int32_t panelWidth(void);
+int32_t panelHeight(void);
+const uint16_t *panelPixels(void);
+uint32_t panelCrc(void);
+
+// Draw on the framebuffer without counting anything
+void panelPaint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+
+// Window transfers, clipped to the panel. Data in wire order holds byte swapped
+// colours, as sprites keep them.
+void panelFill(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+void panelWrite(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, int32_t stride, bool wireOrder);
+void panelCommand(size_t bytes);
+void panelCount(uint32_t pixels, size_t bytes);
+uint16_t panelRead(int32_t x, int32_t y);
+
+panel_stats panelStats(void);
+void panelResetStats(void);
+
+// Counts a draw call unless one is already in progress, so a sprite push or a
+// string made of glyphs is one call however it is implemented
+class PanelCall
+{
+public:
+  PanelCall();
+  ~PanelCall();
+};
+
+#define PANEL_CALL() PanelCall panelCall_
+
+static inline uint16_t panelSwap(uint16_t color)
+{
+  return (uint16_t)((color >> 8) | (color << 8));
+}
+
+#endif // NATIVE_PANEL_H
@@ -0,0 +1,47 @@
+#include "rm67162.h"
+#include "panel.h"
+
+void rm67162_init(void)
+{
+}
+
+// MADCTL and its parameter, the frames stay in the orientation of the env
+void lcd_setRotation(uint8_t r)
+{
+  panelCommand(2);
+}
+
+void lcd_PushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t high, uint16_t *data)
+{
+  PANEL_CALL();
+  panelWrite(x, y, width, high, data, width, true);
+}
+
+void lcd_PushColorsAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t high, uint16_t *data)
+{
+  lcd_PushColors(x, y, width, high, data);
+}
+
+void lcd_PushColorsWait(void)
+{
+}
+
+bool lcd_PushColorsBusy(void)
+{
+  return false;
+}
+
+void lcd_sleep()
+{
+  panelCommand(1);
+}
+
+void lcd_on()
+{
+  panelCommand(1);
+}
+
+void lcd_off()
+{
+  panelCommand(1);
+}
@@ -0,0 +1,20 @@
+#ifndef NATIVE_RM67162_H
+#define NATIVE_RM67162_H
+
+// Host stand-in for the AMOLED panel driver. Frames are taken from the buffer
+// as sent over QSPI (sprite memory, byte swapped colours) and the transfer
+// is done by the time the call returns.
+
+#include <Arduino.h>
+
+void rm67162_init(void);
+void lcd_setRotation(uint8_t r);
+void lcd_PushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t high, uint16_t *data);
+void lcd_PushColorsAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t high, uint16_t *data);
+void lcd_PushColorsWait(void);
+bool lcd_PushColorsBusy(void);
+void lcd_sleep();
+void lcd_on();
+void lcd_off();
+
+#endif // NATIVE_RM67162_H
@@ -0,0 +1,128 @@
+#include <Arduino.h>
+#include <ucontext.h>
+#include <vector>
+
+// Virtual clock and cooperative tasks. The harness is the only thing moving
+// time forward: schedulerRun() steps it one tick at a time and switches to
+// every task whose delay is over, which runs until its next vTaskDelay().
+
+#define TASK_STACK_SIZE (256 * 1024)    // Host code needs more than the ESP32 stack depths
+
+typedef struct {
+  ucontext_t context;
+  TaskFunction_t code;
+  void *parameters;
+  const char *name;
+  BaseType_t core;
+  int64_t wakeUs;
+  bool finished;
+  std::vector<uint8_t> stack;
+} native_task;
+
+static int64_t nowUs = 0;
+static std::vector<native_task *> tasks;
+static native_task *running = NULL;
+static ucontext_t schedulerContext;
+
+int64_t esp_timer_get_time(void)
+{
+  return nowUs;
+}
+
+unsigned long millis(void)
+{
+  return nowUs / 1000;
+}
+
+unsigned long micros(void)
+{
+  return nowUs;
+}
+
+void delay(unsigned long ms)
+{
+  vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+  return nowUs / 1000 / portTICK_PERIOD_MS;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+  return 0;
+}
+
+// The loop task of the device runs on core 1
+BaseType_t xPortGetCoreID(void)
+{
+  return running != NULL ? running->core : 1;
+}
+
+static void taskEntry(void)
+{
+  running->code(running->parameters);
+  running->finished = true;
+  swapcontext(&running->context, &schedulerContext);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth,
+                                   void *parameters, UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t coreId)
+{
+  native_task *task = new native_task();
+  task->code = code;
+  task->parameters = parameters;
+  task->name = name;
+  task->core = coreId;
+  task->wakeUs = nowUs;
+  task->finished = false;
+  task->stack.resize(TASK_STACK_SIZE);
+
+  getcontext(&task->context);
+  task->context.uc_stack.ss_sp = task->stack.data();
+  task->context.uc_stack.ss_size = task->stack.size();
+  task->context.uc_link = NULL;
+  makecontext(&task->context, taskEntry, 0);
+
+  tasks.push_back(task);
+  if (created != NULL) *created = task;
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  if (running == NULL)
+  {
+    // Called from the harness itself, the tasks keep running meanwhile
+    schedulerRun(ticks * portTICK_PERIOD_MS);
+    return;
+  }
+  running->wakeUs = nowUs + (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+  swapcontext(&running->context, &schedulerContext);
+}
+
+static void runReadyTasks(void)
+{
+  for (size_t i = 0; i < tasks.size(); i++)
+  {
+    native_task *task = tasks[i];
+    if (task->finished || task->wakeUs > nowUs) continue;
+    running = task;
+    swapcontext(&schedulerContext, &task->context);
+    running = NULL;
+  }
+}
+
+void schedulerRun(uint32_t ms)
+{
+  if (running != NULL) return;    // A task can only wait through vTaskDelay
+
+  for (uint32_t tick = 0; tick < ms; tick++)
+  {
+    runReadyTasks();
+    nowUs += portTICK_PERIOD_MS * 1000;
+  }
+  runReadyTasks();
+}
@@ -0,0 +1,8 @@
+#ifndef NATIVE_SOC_MEMORY_LAYOUT_H
+#define NATIVE_SOC_MEMORY_LAYOUT_H
+
+#include <stdbool.h>
+
+static inline bool esp_ptr_external_ram(const void *p) { return false; }
+
+#endif // NATIVE_SOC_MEMORY_LAYOUT_H
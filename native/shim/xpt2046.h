@@ -0,0 +1,19 @@
+#ifndef NATIVE_XPT2046_H
+#define NATIVE_XPT2046_H
+
+// Touch controller that is never pressed, screens change through the harness
+
+#include <SPI.h>
+
+class XPT2046
+{
+public:
+  XPT2046(SPIClass &spi, uint8_t cs, uint8_t irq) {}
+
+  void begin(uint16_t width, uint16_t height) {}
+  bool pressed(void) { return false; }
+  uint16_t RawX(void) { return 0; }
+  uint16_t RawY(void) { return 0; }
+};
+
+#endif // NATIVE_XPT2046_H
@@ -2,14 +2,21 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 #include <OneButton.h>
 
 #include "mbedtls/md.h"
 #include "wManager.h"
 #include "mining.h"
+#include "stratumProxy.h"
+#include "fleet.h"
+#include "fetcher.h"
+#include "hashrate.h"
 #include "monitor.h"
+#include "inputEvents.h"
+#include "journal.h"
+#include "fastBoot.h"
 #include "drivers/displays/display.h"
 #include "drivers/storage/SDCard.h"
 #include "drivers/storage/nvMemory.h"
@@ -56,6 +63,8 @@ const char* ntpServer = "pool.ntp.org";
 /********* INIT *****/
 void setup()
 {
+  bootMark(BOOT_SETUP);
+
       //Init pin 15 to eneble 5V external power (LilyGo bug)
   #ifdef PIN_ENABLE5V
       pinMode(PIN_ENABLE5V, OUTPUT);
@@ -97,15 +106,21 @@ void setup()
     button2.attachLongPressStart(reset_configuration);
   #endif
 
+  // Button edges, touch and WiFi events wake the loop task
+  setupInput();
+
   /******** INIT NERDMINER ************/
   Serial.println("NerdMiner v2 starting......");
 
+  /******** START WIFI (connects during the splash) *****/
+  fastBootBegin();
+
   /******** INIT DISPLAY ************/
   initDisplay();
   
   /******** PRINT INIT SCREEN *****/
   drawLoadingScreen();
-  delay(2*SECOND_MS);
+  fastBootSplash(2*SECOND_MS);
 
   /******** SHOW LED INIT STATUS (devices without screen) *****/
   mMonitor.NerdStatus = NM_waitingConfig;
@@ -115,6 +130,10 @@ void setup()
   SDCrd.initSDcard();
 #endif
 
+  /******** INIT SHARE JOURNAL (SD card) *****/
+  setupJournal();
+  journalEvent(JOURNAL_BOOT, "%s reset=%d heap=%u", CURRENT_VERSION, esp_reset_reason(), ESP.getFreeHeap());
+
   /******** INIT WIFI ************/
   init_WifiManager();
 
@@ -136,6 +155,24 @@ void setup()
   BaseType_t res2 = xTaskCreatePinnedToCore(runStratumWorker, "Stratum", 15000, (void*)name, 3, NULL,1);
  #endif
 
+#ifdef STRATUM_PROXY
+  /******** CREATE LAN STRATUM PROXY TASK *****/
+  sprintf(name, "(%s)", "Proxy");
+  BaseType_t res3 = xTaskCreatePinnedToCore(runStratumProxy, "Proxy", 8000, (void*)name, 3, NULL,1);
+#endif
+
+  /******** CREATE FLEET DISCOVERY TASK *****/
+  sprintf(name, "(%s)", "Fleet");
+  BaseType_t res4 = xTaskCreatePinnedToCore(runFleet, "Fleet", 5000, (void*)name, 2, NULL,1);
+
+  /******** CREATE API FETCH TASK *****/
+  // TLS handshakes run on core 0 so they never delay the screen
+  sprintf(name, "(%s)", "Fetch");
+  BaseType_t res5 = xTaskCreatePinnedToCore(runFetcher, "Fetch", 8000, (void*)name, 1, NULL,0);
+
+  /******** HASHRATE SAMPLING *****/
+  setupHashrate();
+
   /******** CREATE MINER TASKS *****/
   //for (size_t i = 0; i < THREADS; i++) {
   //  char *name = (char*) malloc(32);
@@ -152,6 +189,7 @@ void setup()
 
   /******** MONITOR SETUP *****/
   setup_monitor();
+  bootMark(BOOT_TASKS_STARTED);
 }
 
 void app_error_fault_handler(void *arg) {
@@ -165,7 +203,26 @@ void app_error_fault_handler(void *arg) {
   esp_restart();
 }
 
+// Ticks OneButton quickly only while a button is down or a click sequence
+// is pending, otherwise the loop sleeps until an input, WiFi or portal event
+// (or the short DNS poll while the access point is up)
+static uint32_t loopTimeoutMs(void)
+{
+  #ifdef PIN_BUTTON_1
+    if (!button1.isIdle()) return INPUT_TICK_ms;
+  #endif
+
+  #ifdef PIN_BUTTON_2
+    if (!button2.isIdle()) return INPUT_TICK_ms;
+  #endif
+
+  return wifiManagerTimeoutMs();
+}
+
 void loop() {
+  input_event event = waitInput(loopTimeoutMs());
+  int64_t start = esp_timer_get_time();
+
   // keep watching the push buttons:
   #ifdef PIN_BUTTON_1
     button1.tick();
@@ -176,9 +233,11 @@ void loop() {
   #endif
 
 #ifdef TOUCH_ENABLE
-  touchHandler.isTouched();
+  // Only read the XPT2046 over SPI when PENIRQ reported a press
+  if (event == INPUT_TOUCH)
+    touchHandler.isTouched();
 #endif
   wifiManagerProcess(); // avoid delays() in loop when non-blocking and other long running code
 
-  vTaskDelay(50 / portTICK_PERIOD_MS);
+  inputAccount(event, esp_timer_get_time() - start);
 }
@@ -12,6 +12,7 @@
 #include "monitor.h"
 #include "OpenFontRender.h"
 #include "rotation.h"
+#include "glyphAtlas.h"
 
 #define WIDTH 536
 #define HEIGHT 240
@@ -27,7 +28,10 @@
 
 OpenFontRender render;
 TFT_eSPI tft = TFT_eSPI();
-TFT_eSprite background = TFT_eSprite(&tft);
+// Two frame buffers: one is drawn while the other one is sent by DMA
+TFT_eSprite buffers[2] = {TFT_eSprite(&tft), TFT_eSprite(&tft)};
+TFT_eSprite *background = &buffers[0];
+uint8_t drawBuffer = 0;
 
 void amoledDisplay_Init(void)
 {
@@ -38,9 +42,12 @@ void amoledDisplay_Init(void)
   rm67162_init();
   lcd_setRotation(LANDSCAPE);
 
-  background.createSprite(WIDTH, HEIGHT);
-  background.setSwapBytes(true);
-  render.setDrawer(background);
+  for (int i = 0; i < 2; i++)
+  {
+    buffers[i].createSprite(WIDTH, HEIGHT);
+    buffers[i].setSwapBytes(true);
+  }
+  render.setDrawer(*background);
   render.setLineSpaceRatio(0.9);
 
   if (render.loadFont(DigitalNumbers, sizeof(DigitalNumbers)))
@@ -48,6 +55,7 @@ void amoledDisplay_Init(void)
     Serial.println("Initialise error");
     return;
   }
+  glyphAtlasBegin(DigitalNumbers, sizeof(DigitalNumbers));
 }
 
 int screen_state = 1;
@@ -64,53 +72,59 @@ void amoledDisplay_AlternateRotation(void)
     screen_rotation ^= 1;
 }
 
+// Start the transfer of the frame just drawn and draw the next one on the other buffer.
+// The transfer only blocks if the previous one is still running.
+void amoledDisplay_PushFrame(void)
+{
+  lcd_PushColorsAsync(0, 0, WIDTH, HEIGHT, (uint16_t *)background->getPointer());
+  drawBuffer ^= 1;
+  background = &buffers[drawBuffer];
+  render.setDrawer(*background);
+}
+
+static void amoledDisplay_Text(const char *value, unsigned int size, int32_t x, int32_t y, uint16_t color, Align align)
+{
+  glyphDrawString(*background, render, value, x, y, size, color, align, NULL);
+}
+
 void amoledDisplay_MinerScreen(unsigned long mElapsed)
 {
   mining_data data = getMiningData(mElapsed);
 
   // Print background screen
-  background.pushImage(0, 0, MinerWidth, MinerHeight, MinerScreen);
+  background->pushImage(0, 0, MinerWidth, MinerHeight, MinerScreen);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Hashrate
-  render.setFontSize(FS(35));
   render.setFontColor(TFT_BLACK);
 
-  render.rdrawString(data.currentHashRate.c_str(), X(118), Y(114), TFT_BLACK);
+  amoledDisplay_Text(data.currentHashRate, FS(35), X(118), Y(114), TFT_BLACK, Align::Right);
   // Total hashes
-  render.setFontSize(FS(18));
-  render.rdrawString(data.totalMHashes.c_str(), X(268), Y(138), TFT_BLACK);
+  amoledDisplay_Text(data.totalMHashes, FS(18), X(268), Y(138), TFT_BLACK, Align::Right);
   // Block templates
-  render.setFontSize(FS(18));
-  render.drawString(data.templates.c_str(), X(186), Y(20), 0xDEDB);
+  amoledDisplay_Text(data.templates, FS(18), X(186), Y(20), 0xDEDB, Align::Left);
   // Best diff
-  render.drawString(data.bestDiff.c_str(), X(186), Y(48), 0xDEDB);
+  amoledDisplay_Text(data.bestDiff, FS(18), X(186), Y(48), 0xDEDB, Align::Left);
   // 32Bit shares
-  render.setFontSize(FS(18));
-  render.drawString(data.completedShares.c_str(), X(186), Y(76), 0xDEDB);
+  amoledDisplay_Text(data.completedShares, FS(18), X(186), Y(76), 0xDEDB, Align::Left);
   // Hores
-  render.setFontSize(FS(14));
-  render.rdrawString(data.timeMining.c_str(), X(315), Y(104), 0xDEDB);
+  amoledDisplay_Text(data.timeMining, FS(14), X(315), Y(104), 0xDEDB, Align::Right);
 
   // Valid Blocks
-  render.setFontSize(FS(24));
-  render.drawString(data.valids.c_str(), X(285), Y(56), 0xDEDB);
+  amoledDisplay_Text(data.valids, FS(24), X(285), Y(56), 0xDEDB, Align::Left);
 
   // Print Temp
-  render.setFontSize(FS(10));
-  render.rdrawString(data.temp.c_str(), X(239), Y(1), TFT_BLACK);
+  amoledDisplay_Text(data.temp, FS(10), X(239), Y(1), TFT_BLACK, Align::Right);
 
-  render.setFontSize(FS(4));
-  render.rdrawString(String(0).c_str(), X(244), Y(3), TFT_BLACK);
+  amoledDisplay_Text("0", FS(4), X(244), Y(3), TFT_BLACK, Align::Right);
 
   // Print Hour
-  render.setFontSize(FS(10));
-  render.rdrawString(data.currentTime.c_str(), X(286), Y(1), TFT_BLACK);
+  amoledDisplay_Text(data.currentTime, FS(10), X(286), Y(1), TFT_BLACK, Align::Right);
 
   // Push prepared background to screen
-  lcd_PushColors(0, 0, WIDTH, HEIGHT, (uint16_t *)background.getPointer());
+  amoledDisplay_PushFrame();
 }
 
 void amoledDisplay_ClockScreen(unsigned long mElapsed)
@@ -118,36 +132,34 @@ void amoledDisplay_ClockScreen(unsigned long mElapsed)
   clock_data data = getClockData(mElapsed);
 
   // Print background screen
-  background.pushImage(0, 0, minerClockWidth, minerClockHeight, minerClockScreen);
+  background->pushImage(0, 0, minerClockWidth, minerClockHeight, minerClockScreen);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Hashrate
-  render.setFontSize(FS(25));
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), X(94), Y(129), TFT_BLACK);
+  amoledDisplay_Text(data.currentHashRate, FS(25), X(94), Y(129), TFT_BLACK, Align::Right);
 
   // Print BTC Price
-  background.setFreeFont(FSSB12);
-  background.setTextSize(1);
-  background.setTextDatum(TL_DATUM);
-  background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), X(202), Y(3), GFXFF);
+  background->setFreeFont(FSSB12);
+  background->setTextSize(1);
+  background->setTextDatum(TL_DATUM);
+  background->setTextColor(TFT_BLACK);
+  background->drawString(data.btcPrice, X(202), Y(3), GFXFF);
 
   // Print BlockHeight
-  render.setFontSize(FS(18));
-  render.rdrawString(data.blockHeight.c_str(), X(254), Y(140), TFT_BLACK);
+  amoledDisplay_Text(data.blockHeight, FS(18), X(254), Y(140), TFT_BLACK, Align::Right);
 
   // Print Hour
-  background.setFreeFont(FF24);
-  background.setTextSize(2);
-  background.setTextColor(0xDEDB, TFT_BLACK);
+  background->setFreeFont(FF24);
+  background->setTextSize(2);
+  background->setTextColor(0xDEDB, TFT_BLACK);
 
-  background.drawString(data.currentTime.c_str(), X(130), Y(50), GFXFF);
+  background->drawString(data.currentTime, X(130), Y(50), GFXFF);
 
   // Push prepared background to screen
-  lcd_PushColors(0, 0, WIDTH, HEIGHT, (uint16_t *)background.getPointer());
+  amoledDisplay_PushFrame();
 }
 
 void amoledDisplay_GlobalHashScreen(unsigned long mElapsed)
@@ -155,75 +167,73 @@ void amoledDisplay_GlobalHashScreen(unsigned long mElapsed)
   coin_data data = getCoinData(mElapsed);
 
   // Print background screen
-  background.pushImage(0, 0, globalHashWidth, globalHashHeight, globalHashScreen);
+  background->pushImage(0, 0, globalHashWidth, globalHashHeight, globalHashScreen);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Print BTC Price
-  background.setFreeFont(FSSB12);
-  background.setTextSize(1);
-  background.setTextDatum(TL_DATUM);
-  background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), X(198), Y(3), GFXFF);
+  background->setFreeFont(FSSB12);
+  background->setTextSize(1);
+  background->setTextDatum(TL_DATUM);
+  background->setTextColor(TFT_BLACK);
+  background->drawString(data.btcPrice, X(198), Y(3), GFXFF);
 
   // Print Hour
-  background.setFreeFont(FSSB12);
-  background.setTextSize(1);
-  background.setTextDatum(TL_DATUM);
-  background.setTextColor(TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), X(268), Y(3), GFXFF);
+  background->setFreeFont(FSSB12);
+  background->setTextSize(1);
+  background->setTextDatum(TL_DATUM);
+  background->setTextColor(TFT_BLACK);
+  background->drawString(data.currentTime, X(268), Y(3), GFXFF);
 
   // Print Last Pool Block
-  background.setFreeFont(FSS12);
-  background.setTextDatum(TR_DATUM);
-  background.setTextColor(0x9C92);
-  background.drawString(data.halfHourFee.c_str(), X(302), Y(52), GFXFF);
+  background->setFreeFont(FSS12);
+  background->setTextDatum(TR_DATUM);
+  background->setTextColor(0x9C92);
+  background->drawString(data.halfHourFee, X(302), Y(52), GFXFF);
 
   // Print Difficulty
-  background.setFreeFont(FSS12);
-  background.setTextDatum(TR_DATUM);
-  background.setTextColor(0x9C92);
-  background.drawString(data.netwrokDifficulty.c_str(), X(302), Y(88), GFXFF);
+  background->setFreeFont(FSS12);
+  background->setTextDatum(TR_DATUM);
+  background->setTextColor(0x9C92);
+  background->drawString(data.netwrokDifficulty, X(302), Y(88), GFXFF);
 
   // Print Global Hashrate
-  render.setFontSize(FS(17));
-  render.rdrawString(data.globalHashRate.c_str(), X(274), Y(145), TFT_BLACK);
+  amoledDisplay_Text(data.globalHashRate, FS(17), X(274), Y(145), TFT_BLACK, Align::Right);
 
   // Print BlockHeight
-  render.setFontSize(FS(28));
-  render.rdrawString(data.blockHeight.c_str(), X(140), Y(104), 0xDEDB);
+  amoledDisplay_Text(data.blockHeight, FS(28), X(140), Y(104), 0xDEDB, Align::Right);
 
   // Draw percentage rectangle
   int x2 = 2 + (138 * data.progressPercent / 100);
-  background.fillRect(2, Y(149), X(x2), Y(238), 0xDEDB);
+  background->fillRect(2, Y(149), X(x2), Y(238), 0xDEDB);
 
   // Print Remaining BLocks
-  background.setTextFont(FONT4);
-  background.setTextSize(1);
-  background.setTextDatum(MC_DATUM);
-  background.setTextColor(TFT_BLACK);
-  background.drawString(data.remainingBlocks.c_str(), X(72), Y(159), FONT2);
+  background->setTextFont(FONT4);
+  background->setTextSize(1);
+  background->setTextDatum(MC_DATUM);
+  background->setTextColor(TFT_BLACK);
+  background->drawString(data.remainingBlocks, X(72), Y(159), FONT2);
 
   // Push prepared background to screen
-  lcd_PushColors(0, 0, WIDTH, HEIGHT, (uint16_t *)background.getPointer());
+  amoledDisplay_PushFrame();
 }
 
 void amoledDisplay_LoadingScreen(void)
 {
-  background.fillScreen(TFT_BLACK);
-  background.pushImage(0, 0, initWidth, initHeight, initScreen);
-  background.setTextColor(TFT_BLACK);
-  background.drawString(CURRENT_VERSION, X(24), Y(147), FONT2);
+  background->fillScreen(TFT_BLACK);
+  background->pushImage(0, 0, initWidth, initHeight, initScreen);
+  background->setTextColor(TFT_BLACK);
+  background->drawString(CURRENT_VERSION, X(24), Y(147), FONT2);
 
-  lcd_PushColors(0, 0, WIDTH, HEIGHT, (uint16_t *)background.getPointer());
+  amoledDisplay_PushFrame();
 }
 
 void amoledDisplay_SetupScreen(void)
 {
-  background.pushImage(0, 0, setupModeWidth, setupModeHeight, setupModeScreen);
+  background->pushImage(0, 0, setupModeWidth, setupModeHeight, setupModeScreen);
 
-  lcd_PushColors(0, 0, WIDTH, HEIGHT, (uint16_t *)background.getPointer());
+  amoledDisplay_PushFrame();
 }
 
 void amoledDisplay_AnimateCurrentScreen(unsigned long frame)
@@ -245,6 +255,7 @@ DisplayDriver amoledDisplayDriver = {
     amoledDisplayCyclicScreens,
     amoledDisplay_AnimateCurrentScreen,
     amoledDisplay_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(amoledDisplayCyclicScreens),
     0,
     WIDTH,
@@ -52,6 +52,8 @@ DisplayDriver *currentDisplayDriver = &m5stickCDriver;
 DisplayDriver *currentDisplayDriver = &t_hmiDisplayDriver;
 #endif
 
+// Screen state as set by alternateScreenState/toggleDisplay
+static bool displayOn = true;
 
 // Initialize the display
 void initDisplay()
@@ -63,6 +65,7 @@ void initDisplay()
 void alternateScreenState()
 {
   currentDisplayDriver->alternateScreenState();
+  displayOn = !displayOn;
 }
 
 // Alternate screen rotation
@@ -118,5 +121,12 @@ void toggleDisplay(bool enabled)
 {
   if (currentDisplayDriver && currentDisplayDriver->toggleDisplay) {
     currentDisplayDriver->toggleDisplay(enabled);
+    displayOn = enabled;
   }
 }
+
+// Whether the screen (or status LED) is currently on
+bool isDisplayOn()
+{
+  return displayOn;
+}
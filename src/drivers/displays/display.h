@@ -16,5 +16,6 @@ void drawCurrentScreen(unsigned long mElapsed);
 void animateCurrentScreen(unsigned long frame);
 void doLedStuff(unsigned long frame);
 void toggleDisplay(bool enabled);
+bool isDisplayOn();
 
 #endif // DISPLAY_H
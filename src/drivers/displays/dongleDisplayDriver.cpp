@@ -71,7 +71,7 @@ extern monitor_data mMonitor;
 
 #define PRINT_VALUE(value)                                       \
   {                                                              \
-    render.drawString(String(value).c_str(), x, y, VALUE_COLOR); \
+    render.drawString(value, x, y, VALUE_COLOR);                 \
     y += 27;                                                     \
   }
 
@@ -121,7 +121,7 @@ void dongleDisplay_MinerScreen(unsigned long mElapsed)
 
   // Print background screen
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   background.pushImage(0, 0, MinerWidth, MinerHeight, MinerScreen);
   RESET_SCREEN();
@@ -4,17 +4,20 @@
 
 #include <TFT_eSPI.h>
 #include <TFT_eTouch.h>
-#include "media/images_320_170.h"
-#include "media/images_bottom_320_70.h"
+#include "media/images_320_170_rle.h"
+#include "media/images_bottom_320_70_rle.h"
 #include "media/myFonts.h"
 #include "media/Free_Fonts.h"
 #include "version.h"
 #include "monitor.h"
+#include "fetcher.h"
 #include "OpenFontRender.h"
 #include <SPI.h>
 #include "rotation.h"
 #include "drivers/storage/nvMemory.h"
 #include "drivers/storage/storage.h"
+#include "historyChart.h"
+#include "mining.h"
 
 #define WIDTH 130 //320
 #define HEIGHT 170 
@@ -95,8 +98,8 @@ void esp32_2432S028R_Init(void)
   digitalWrite(LED_PIN, LOW);
   digitalWrite(LED_PIN_B, HIGH);
   digitalWrite(LED_PIN_G, HIGH);
-  pData.bestDifficulty = "0";
-  pData.workersHash = "0";
+  strcpy(pData.bestDifficulty, "0");
+  strcpy(pData.workersHash, "0");
   pData.workersCount = 0;
   //Serial.println("=========== Fim Display ==============") ;
 }
@@ -138,11 +141,11 @@ bool createBackgroundSprite(int16_t wdt, int16_t hgt){  // Set the background an
   return background.created();
 }
 
-extern unsigned long mPoolUpdate;
+static unsigned long mPoolUpdate = 0;
 
 void printPoolData(){
   if ((hasChangedScreen) || (mPoolUpdate == 0) || (millis() - mPoolUpdate > UPDATE_POOL_min * 60 * 1000)){     
-      if (Settings.PoolAddress != "tn.vkbit.com") { 
+      if (getPoolSettings().address != "tn.vkbit.com") { 
           pData = getPoolData();             
           background.createSprite(320,50); //Background Sprite
           if (!background.created()) {    
@@ -152,28 +155,32 @@ void printPoolData(){
           }       
           background.setSwapBytes(true);
           if (bottomScreenBlue) {
-            background.pushImage(0, -20, 320, 70, bottonPoolScreen);
-            tft.pushImage(0,170,320,20,bottonPoolScreen);      
+            rlePushImage(background, 0, -20, bottonPoolScreen_rle);
+            rlePushRect(tft, 0, 170, bottonPoolScreen_rle, 0, 0, 320, 20);      
           } else {
-            background.pushImage(0, -20, 320, 70, bottonPoolScreen_g);
-            tft.pushImage(0,170,320,20,bottonPoolScreen_g);
+            rlePushImage(background, 0, -20, bottonPoolScreen_g_rle);
+            rlePushRect(tft, 0, 170, bottonPoolScreen_g_rle, 0, 0, 320, 20);
           }
                 
           render.setDrawer(background); // Link drawing object to background instance (so font will be rendered on background)
           render.setLineSpaceRatio(1);
           
           render.setFontSize(24);
-          render.cdrawString(String(pData.workersCount).c_str(), 157, 16, TFT_BLACK);
+          char workersCount[8];
+          snprintf(workersCount, sizeof(workersCount), "%d", pData.workersCount);
+          render.cdrawString(workersCount, 157, 16, TFT_BLACK);
           render.setFontSize(18);
           render.setAlignment(Align::BottomRight);
-          render.cdrawString(pData.workersHash.c_str(), 265, 14, TFT_BLACK);
+          render.cdrawString(pData.workersHash, 265, 14, TFT_BLACK);
           render.setAlignment(Align::BottomLeft);
-          render.cdrawString(pData.bestDifficulty.c_str(), 54, 14, TFT_BLACK);
-          background.pushSprite(0,190);      
+          render.cdrawString(pData.bestDifficulty, 54, 14, TFT_BLACK);
+          background.pushSprite(0,190);
           background.deleteSprite();
+          // Keep redrawing until the fetch task delivered real pool data
+          if (getFetchStatus(FETCH_POOL).valid) mPoolUpdate = millis();
       } else {
-        pData.bestDifficulty = "TESTNET";
-        pData.workersHash = "TESTNET";
+        strcpy(pData.bestDifficulty, "TESTNET");
+        strcpy(pData.workersHash, "TESTNET");
         pData.workersCount = 1;
         tft.fillRect(0,170,320,70, TFT_DARKGREEN);        
         background.createSprite(320,40); //Background Sprite
@@ -188,7 +195,7 @@ void printPoolData(){
         background.setTextSize(1);
         background.setTextColor(TFT_WHITE, TFT_DARKGREEN);        
         background.drawString("TESTNET", 50, 0, GFXFF);
-        background.pushSprite(0,185);  
+        background.pushSprite(0,185);
         mPoolUpdate = millis();
         Serial.println("Testnet");
         background.deleteSprite();
@@ -204,7 +211,7 @@ void esp32_2432S028R_MinerScreen(unsigned long mElapsed)
 
   printPoolData();
 
-  if (hasChangedScreen) tft.pushImage(0, 0, initWidth, initHeight, MinerScreen);
+  if (hasChangedScreen) rlePushImage(tft, 0, 0, MinerScreen_rle);
     
   hasChangedScreen = false; 
  
@@ -212,40 +219,40 @@ void esp32_2432S028R_MinerScreen(unsigned long mElapsed)
   // Recreate sprite to the right side of the screen
   createBackgroundSprite(WIDTH-5, HEIGHT-7);
   //Print background screen    
-  background.pushImage(-190, 0, MinerWidth, MinerHeight, MinerScreen);
+  rlePushImage(background, -190, 0, MinerScreen_rle);
   
   // Total hashes
   render.setFontSize(18);
-  render.rdrawString(data.totalMHashes.c_str(), 268-wdtOffset, 138, TFT_BLACK);
+  render.rdrawString(data.totalMHashes, 268-wdtOffset, 138, TFT_BLACK);
 
   // Block templates
   render.setFontSize(18);
   render.setAlignment(Align::TopLeft);
-  render.drawString(data.templates.c_str(), 189-wdtOffset, 20, 0xDEDB);
+  render.drawString(data.templates, 189-wdtOffset, 20, 0xDEDB);
   // Best diff
-  render.drawString(data.bestDiff.c_str(), 189-wdtOffset, 48, 0xDEDB);
+  render.drawString(data.bestDiff, 189-wdtOffset, 48, 0xDEDB);
   // 32Bit shares
   render.setFontSize(18);
-  render.drawString(data.completedShares.c_str(), 189-wdtOffset, 76, 0xDEDB);
+  render.drawString(data.completedShares, 189-wdtOffset, 76, 0xDEDB);
   // Hores
   render.setFontSize(14);
-  render.rdrawString(data.timeMining.c_str(), 315-wdtOffset, 104, 0xDEDB);
+  render.rdrawString(data.timeMining, 315-wdtOffset, 104, 0xDEDB);
 
   // Valid Blocks
   render.setFontSize(24);
   render.setAlignment(Align::TopCenter);
-  render.drawString(data.valids.c_str(), 290-wdtOffset, 56, 0xDEDB);
+  render.drawString(data.valids, 290-wdtOffset, 56, 0xDEDB);
 
   // Print Temp
   render.setFontSize(10);
-  render.rdrawString(data.temp.c_str(), 239-wdtOffset, 1, TFT_BLACK);
+  render.rdrawString(data.temp, 239-wdtOffset, 1, TFT_BLACK);
 
   render.setFontSize(4);
   render.rdrawString(String(0).c_str(), 244-wdtOffset, 3, TFT_BLACK);
 
   // Print Hour
   render.setFontSize(10);
-  render.rdrawString(data.currentTime.c_str(), 286-wdtOffset, 1, TFT_BLACK);
+  render.rdrawString(data.currentTime, 286-wdtOffset, 1, TFT_BLACK);
 
   // Push prepared background to screen
   background.pushSprite(190, 0);
@@ -258,13 +265,13 @@ void esp32_2432S028R_MinerScreen(unsigned long mElapsed)
   // Create background sprite to print data at once
   createBackgroundSprite(WIDTH-7, HEIGHT-100); // initHeight); //Background Sprite
   //Print background screen    
-  background.pushImage(0, -90, MinerWidth, MinerHeight, MinerScreen);
+  rlePushImage(background, 0, -90, MinerScreen_rle);
 
   // Hashrate 
   render.setFontSize(35);
   render.setCursor(19, 118);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 118, 114-90, TFT_BLACK);
+  render.rdrawString(data.currentHashRate, 118, 114-90, TFT_BLACK);
   
   // Push prepared background to screen
   background.pushSprite(0, 90);
@@ -273,7 +280,7 @@ void esp32_2432S028R_MinerScreen(unsigned long mElapsed)
   background.deleteSprite();  
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str()); 
+                data.completedShares, data.totalKHashes, data.currentHashRate); 
    
   #ifdef DEBUG_MEMORY
     // Print heap
@@ -284,7 +291,7 @@ void esp32_2432S028R_MinerScreen(unsigned long mElapsed)
 void esp32_2432S028R_ClockScreen(unsigned long mElapsed)
 {
 
-  if (hasChangedScreen) tft.pushImage(0, 0, minerClockWidth, minerClockHeight, minerClockScreen);
+  if (hasChangedScreen) rlePushImage(tft, 0, 0, minerClockScreen_rle);
   
   printPoolData();
 
@@ -296,15 +303,15 @@ void esp32_2432S028R_ClockScreen(unsigned long mElapsed)
   createBackgroundSprite(270,36);
 
   // Print background screen
-  background.pushImage(0, -130, minerClockWidth, minerClockHeight, minerClockScreen);
+  rlePushImage(background, 0, -130, minerClockScreen_rle);
   // Hashrate
   render.setFontSize(25);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 95, 0, TFT_BLACK);
+  render.rdrawString(data.currentHashRate, 95, 0, TFT_BLACK);
 
   // Print BlockHeight
   render.setFontSize(18);
-  render.rdrawString(data.blockHeight.c_str(), 254, 9, TFT_BLACK);
+  render.rdrawString(data.blockHeight, 254, 9, TFT_BLACK);
 
   // Push prepared background to screen
   background.pushSprite(0, 130);
@@ -313,20 +320,20 @@ void esp32_2432S028R_ClockScreen(unsigned long mElapsed)
 
   createBackgroundSprite(169,105);
   // Print background screen
-  background.pushImage(-130, -3, minerClockWidth, minerClockHeight, minerClockScreen);
+  rlePushImage(background, -130, -3, minerClockScreen_rle);
   
   // Print BTC Price
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 202-130, 0, GFXFF);
+  background.drawString(data.btcPrice, 202-130, 0, GFXFF);
  
   // Print Hour
   background.setFreeFont(FF23);
   background.setTextSize(2);
   background.setTextColor(0xDEDB, TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), 0, 50, GFXFF);
+  background.drawString(data.currentTime, 0, 50, GFXFF);
  
   // Push prepared background to screen
   background.pushSprite(130, 3);
@@ -335,7 +342,7 @@ void esp32_2432S028R_ClockScreen(unsigned long mElapsed)
   background.deleteSprite();   
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   #ifdef DEBUG_MEMORY
   // Print heap
@@ -345,7 +352,7 @@ void esp32_2432S028R_ClockScreen(unsigned long mElapsed)
 
 void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
 {
-  if (hasChangedScreen) tft.pushImage(0, 0, globalHashWidth, globalHashHeight, globalHashScreen);
+  if (hasChangedScreen) rlePushImage(tft, 0, 0, globalHashScreen_rle);
   
   printPoolData();
   
@@ -356,32 +363,32 @@ void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
   // Create background sprite to print data at once
   createBackgroundSprite(169,105);
   // Print background screen
-  background.pushImage(-160, -3, minerClockWidth, minerClockHeight, globalHashScreen);
+  rlePushImage(background, -160, -3, globalHashScreen_rle);
   
   // Print BTC Price
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 198-160, 0, GFXFF);
+  background.drawString(data.btcPrice, 198-160, 0, GFXFF);
   // Print Hour
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), 268-160, 0, GFXFF);
+  background.drawString(data.currentTime, 268-160, 0, GFXFF);
 
   // Print Last Pool Block
   background.setFreeFont(FSS9);
   background.setTextDatum(TR_DATUM);
   background.setTextColor(0x9C92);
-  background.drawString(data.halfHourFee.c_str(), 302-160, 49, GFXFF);
+  background.drawString(data.halfHourFee, 302-160, 49, GFXFF);
 
   // Print Difficulty
   background.setFreeFont(FSS9);
   background.setTextDatum(TR_DATUM);
   background.setTextColor(0x9C92);
-  background.drawString(data.netwrokDifficulty.c_str(), 302-160, 85, GFXFF);
+  background.drawString(data.netwrokDifficulty, 302-160, 85, GFXFF);
   // Push prepared background to screen
   background.pushSprite(160, 3);
   // Delete sprite to free the memory heap
@@ -390,11 +397,11 @@ void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
  // Create background sprite to print data at once
   createBackgroundSprite(280,30);
   // Print background screen
-  background.pushImage(0, -139, minerClockWidth, minerClockHeight, globalHashScreen);
+  rlePushImage(background, 0, -139, globalHashScreen_rle);
   //background.fillSprite(TFT_CYAN);
   // Print Global Hashrate
   render.setFontSize(17);
-  render.rdrawString(data.globalHashRate.c_str(), 274, 145-139, TFT_BLACK);
+  render.rdrawString(data.globalHashRate, 274, 145-139, TFT_BLACK);
 
   // Draw percentage rectangle
   int x2 = 2 + (138 * data.progressPercent / 100);
@@ -405,7 +412,7 @@ void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
   background.setTextSize(1); 
   background.setTextDatum(MC_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.remainingBlocks.c_str(), 72, 159-139, FONT2);
+  background.drawString(data.remainingBlocks, 72, 159-139, FONT2);
 
   // Push prepared background to screen
   background.pushSprite(0, 139);
@@ -415,11 +422,11 @@ void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
  // Create background sprite to print data at once
   createBackgroundSprite(140,40);
   // Print background screen
-  background.pushImage(-5, -100, minerClockWidth, minerClockHeight, globalHashScreen);
+  rlePushImage(background, -5, -100, globalHashScreen_rle);
   //background.fillSprite(TFT_CYAN);
   // Print BlockHeight
   render.setFontSize(28);
-  render.rdrawString(data.blockHeight.c_str(), 140-5, 104-100, 0xDEDB);
+  render.rdrawString(data.blockHeight, 140-5, 104-100, 0xDEDB);
 
   // Push prepared background to screen
   background.pushSprite(5, 100);
@@ -427,7 +434,7 @@ void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
   background.deleteSprite();   
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   #ifdef DEBUG_MEMORY
   // Print heap
@@ -437,7 +444,7 @@ void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
 void esp32_2432S028R_BTCprice(unsigned long mElapsed)
 {
   
-  if (hasChangedScreen) tft.pushImage(0, 0, priceScreenWidth, priceScreenHeight, priceScreen);
+  if (hasChangedScreen) rlePushImage(tft, 0, 0, priceScreen_rle);
   printPoolData();
   hasChangedScreen = false;
 
@@ -447,15 +454,15 @@ void esp32_2432S028R_BTCprice(unsigned long mElapsed)
   createBackgroundSprite(270,36);
 
   // Print background screen
-  background.pushImage(0, -130, priceScreenWidth, priceScreenHeight, priceScreen);
+  rlePushImage(background, 0, -130, priceScreen_rle);
   // Hashrate
   render.setFontSize(25);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 95, 0, TFT_BLACK);
+  render.rdrawString(data.currentHashRate, 95, 0, TFT_BLACK);
 
   // Print BlockHeight
   render.setFontSize(18);
-  render.rdrawString(data.blockHeight.c_str(), 254, 9, TFT_WHITE);
+  render.rdrawString(data.blockHeight, 254, 9, TFT_WHITE);
 
   // Push prepared background to screen
   background.pushSprite(0, 130);
@@ -464,21 +471,21 @@ void esp32_2432S028R_BTCprice(unsigned long mElapsed)
 
   createBackgroundSprite(169,105);
   // Print background screen
-  background.pushImage(-130, -3, priceScreenWidth, priceScreenHeight, priceScreen);
+  rlePushImage(background, -130, -3, priceScreen_rle);
   
   // Print Hour
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), 202-130, 0, GFXFF);
+  background.drawString(data.currentTime, 202-130, 0, GFXFF);
  
   // Print BTC Price
   background.setFreeFont(FF24);
   background.setTextDatum(TL_DATUM);
   background.setTextSize(1);
   background.setTextColor(0xDEDB, TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 0, 50, GFXFF);
+  background.drawString(data.btcPrice, 0, 50, GFXFF);
  
   // Push prepared background to screen
   background.pushSprite(130, 3);
@@ -487,7 +494,7 @@ void esp32_2432S028R_BTCprice(unsigned long mElapsed)
   background.deleteSprite();   
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   #ifdef DEBUG_MEMORY
   // Print heap
@@ -495,21 +502,36 @@ void esp32_2432S028R_BTCprice(unsigned long mElapsed)
   #endif
 }
 
+static uint32_t historyMinute = 0;
+
+void esp32_2432S028R_HistoryScreen(unsigned long mElapsed)
+{
+  // Drawn straight on the panel, a 320x240 sprite doesn't fit in the heap.
+  // The chart only changes once a minute.
+  uint32_t minute = getEpochSeconds() / 60;
+  if (!hasChangedScreen && minute == historyMinute) return;
+  hasChangedScreen = false;
+  historyMinute = minute;
+
+  // Last day, one column per 4.5 minutes
+  drawHistoryChart(tft, 0, 0, 320, 240, 24 * 60);
+}
+
 void esp32_2432S028R_LoadingScreen(void)
 {
   tft.fillScreen(TFT_BLACK);
-  tft.pushImage(0, 33, initWidth, initHeight, initScreen);
+  rlePushImage(tft, 0, 33, initScreen_rle);
   tft.setTextColor(TFT_BLACK);
   tft.drawString(CURRENT_VERSION, 24, 147, FONT2);
   // delay(2000);
   // tft.fillScreen(TFT_BLACK);
-  // tft.pushImage(0, 0, initWidth, initHeight, MinerScreen);
+  // rlePushImage(tft, 0, 0, MinerScreen_rle);
 }
 
 void esp32_2432S028R_SetupScreen(void)
 {
   tft.fillScreen(TFT_BLACK);
-  tft.pushImage(0, 33, setupModeWidth, setupModeHeight, setupModeScreen);
+  rlePushImage(tft, 0, 33, setupModeScreen_rle);
 }
 
 void esp32_2432S028R_AnimateCurrentScreen(unsigned long frame)
@@ -584,7 +606,7 @@ void esp32_2432S028R_DoLedStuff(unsigned long frame)
 
 }
 
-CyclicScreenFunction esp32_2432S028RCyclicScreens[] = {esp32_2432S028R_MinerScreen, esp32_2432S028R_ClockScreen, esp32_2432S028R_GlobalHashScreen, esp32_2432S028R_BTCprice};
+CyclicScreenFunction esp32_2432S028RCyclicScreens[] = {esp32_2432S028R_MinerScreen, esp32_2432S028R_ClockScreen, esp32_2432S028R_GlobalHashScreen, esp32_2432S028R_BTCprice, esp32_2432S028R_HistoryScreen};
 
 DisplayDriver esp32_2432S028RDriver = {
     esp32_2432S028R_Init,
@@ -595,6 +617,7 @@ DisplayDriver esp32_2432S028RDriver = {
     esp32_2432S028RCyclicScreens,
     esp32_2432S028R_AnimateCurrentScreen,
     esp32_2432S028R_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(esp32_2432S028RCyclicScreens),
     0,
     WIDTH,
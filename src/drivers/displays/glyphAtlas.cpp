@@ -0,0 +1,276 @@
+#include "displayDriver.h"
+
+#if defined(T_DISPLAY) || defined(AMOLED_DISPLAY)
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include "glyphAtlas.h"
+
+#define FIRST_CHAR  32
+#define CHARS       96
+#define NOT_LOADED  0xFF
+#define MISSING     0xFE
+
+typedef struct {
+  uint8_t *alpha;                   // width * height coverage, NULL when the glyph has no ink
+  int8_t left;                      // Bitmap offset from the pen position on the baseline
+  int8_t top;
+  uint8_t width;
+  uint8_t height;
+  uint8_t advance;
+} glyph_entry;
+
+typedef struct {
+  unsigned int size;
+  bool usable;                      // Placement checked against OpenFontRender
+  int16_t dx[2], dy[2];             // Left/Right offsets between the atlas layout and OpenFontRender
+  int16_t dw, dh;                   // Box size difference (inclusive/exclusive max)
+  uint8_t index[CHARS];
+} size_entry;
+
+typedef struct {
+  int16_t x0, y0, x1, y1;           // Ink box relative to the pen start on the baseline
+} ink_box;
+
+static FT_Library library = NULL;
+static FT_Face face = NULL;
+
+static glyph_entry glyphs[GLYPH_MAX_GLYPHS];
+static size_entry sizes[GLYPH_MAX_SIZES];
+static int sizeCount = 0;
+
+static glyph_stats stats = {0, 0, 0, 0, 0, 0};
+
+bool glyphAtlasBegin(const unsigned char *font, size_t length)
+{
+#if GLYPH_ATLAS
+  if (face != NULL) return true;
+  if (FT_Init_FreeType(&library) != 0) return false;
+  if (FT_New_Memory_Face(library, font, length, 0, &face) != 0) {
+    Serial.println("[GLYPH] Font load error, atlas disabled");
+    face = NULL;
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+static uint8_t *allocMask(size_t bytes)
+{
+  if (psramFound()) return (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+  if (stats.bytes + bytes > GLYPH_INTERNAL_BYTES) return NULL;
+  return (uint8_t *)malloc(bytes);
+}
+
+static glyph_entry *loadGlyph(size_entry &s, char c)
+{
+  if (c < FIRST_CHAR || c >= FIRST_CHAR + CHARS) return NULL;
+  uint8_t &idx = s.index[c - FIRST_CHAR];
+  if (idx == MISSING) return NULL;
+  if (idx != NOT_LOADED) return &glyphs[idx];
+  if (stats.glyphs >= GLYPH_MAX_GLYPHS) return NULL;
+
+  FT_Set_Pixel_Sizes(face, 0, s.size);
+  FT_UInt charIndex = FT_Get_Char_Index(face, c);
+  if (charIndex == 0 || FT_Load_Glyph(face, charIndex, FT_LOAD_RENDER) != 0) {
+    idx = MISSING;
+    return NULL;
+  }
+
+  FT_GlyphSlot slot = face->glyph;
+  FT_Bitmap &bitmap = slot->bitmap;
+  if (bitmap.pixel_mode != FT_PIXEL_MODE_GRAY || bitmap.width > 255 || bitmap.rows > 255) {
+    idx = MISSING;
+    return NULL;
+  }
+
+  glyph_entry &g = glyphs[stats.glyphs];
+  g.left = slot->bitmap_left;
+  g.top = slot->bitmap_top;
+  g.width = bitmap.width;
+  g.height = bitmap.rows;
+  g.advance = slot->advance.x >> 6;
+  g.alpha = NULL;
+
+  size_t bytes = g.width * g.height;
+  if (bytes) {
+    g.alpha = allocMask(bytes);
+    if (g.alpha == NULL) return NULL;   // Out of budget, try again later
+    for (int row = 0; row < g.height; row++)
+      memcpy(g.alpha + row * g.width, bitmap.buffer + row * bitmap.pitch, g.width);
+    stats.bytes += bytes;
+  }
+
+  idx = stats.glyphs++;
+  return &g;
+}
+
+static bool layoutString(size_entry &s, const char *str, ink_box &box)
+{
+  int16_t pen = 0;
+  box = {INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN};
+
+  for (const char *p = str; *p; p++) {
+    glyph_entry *g = loadGlyph(s, *p);
+    if (g == NULL) return false;
+    if (g->alpha != NULL) {
+      box.x0 = min(box.x0, (int16_t)(pen + g->left));
+      box.x1 = max(box.x1, (int16_t)(pen + g->left + g->width));
+      box.y0 = min(box.y0, (int16_t)(-g->top));
+      box.y1 = max(box.y1, (int16_t)(-g->top + g->height));
+    }
+    pen += g->advance;
+  }
+  return box.x1 > box.x0;
+}
+
+// Top-left of the ink box, where OpenFontRender puts the string
+static void placeString(const size_entry &s, const ink_box &box, int32_t x, int32_t y, Align align, int32_t &ox, int32_t &oy)
+{
+  int a = (align == Align::Right) ? 1 : 0;
+  ox = (a ? x - (box.x1 - box.x0) : x) + s.dx[a];
+  oy = y + s.dy[a];
+}
+
+static FT_BBox atlasBox(const size_entry &s, const ink_box &box, int32_t ox, int32_t oy)
+{
+  FT_BBox b;
+  b.xMin = ox;
+  b.yMin = oy;
+  b.xMax = ox + (box.x1 - box.x0) + s.dw;
+  b.yMax = oy + (box.y1 - box.y0) + s.dh;
+  return b;
+}
+
+// Learn how OpenFontRender places strings at this size, and only use the
+// atlas if the probes land on exactly the same pixels
+static void calibrate(size_entry &s, OpenFontRender &render)
+{
+  static const char *probes[] = {"08", ".", "1", "1.5", "00:00"};
+  const Align aligns[2] = {Align::Left, Align::Right};
+  ink_box box;
+
+  s.usable = false;
+  if (!layoutString(s, probes[0], box)) return;
+
+  for (int a = 0; a < 2; a++) {
+    FT_BBox ref = render.calculateBoundingBox(0, 0, s.size, aligns[a], Layout::Horizontal, probes[0]);
+    s.dx[a] = ref.xMin - (a ? -(box.x1 - box.x0) : 0);
+    s.dy[a] = ref.yMin;
+    s.dw = (ref.xMax - ref.xMin) - (box.x1 - box.x0);
+    s.dh = (ref.yMax - ref.yMin) - (box.y1 - box.y0);
+  }
+
+  for (int p = 1; p < 5; p++) {
+    if (!layoutString(s, probes[p], box)) continue;   // Glyph not in the font
+    for (int a = 0; a < 2; a++) {
+      FT_BBox ref = render.calculateBoundingBox(0, 0, s.size, aligns[a], Layout::Horizontal, probes[p]);
+      int32_t ox, oy;
+      placeString(s, box, 0, 0, aligns[a], ox, oy);
+      FT_BBox mine = atlasBox(s, box, ox, oy);
+      if (mine.xMin != ref.xMin || mine.yMin != ref.yMin || mine.xMax != ref.xMax || mine.yMax != ref.yMax) {
+        Serial.printf("[GLYPH] Size %u doesn't match OpenFontRender layout, not cached\n", s.size);
+        return;
+      }
+    }
+  }
+  s.usable = true;
+}
+
+static size_entry *getSize(unsigned int size, OpenFontRender &render)
+{
+  for (int i = 0; i < sizeCount; i++)
+    if (sizes[i].size == size) return &sizes[i];
+  if (sizeCount >= GLYPH_MAX_SIZES) return NULL;
+
+  size_entry &s = sizes[sizeCount++];
+  s.size = size;
+  memset(s.index, NOT_LOADED, sizeof(s.index));
+  calibrate(s, render);
+  return &s;
+}
+
+static void blendGlyph(TFT_eSprite &sprite, const glyph_entry &g, int32_t gx, int32_t gy, uint16_t color)
+{
+  int32_t w = sprite.width();
+  int32_t h = sprite.height();
+  uint16_t *buf = (uint16_t *)sprite.getPointer();
+  uint16_t swapped = (color >> 8) | (color << 8);   // 16 bit sprites store pixels byte swapped
+
+  for (int row = 0; row < g.height; row++) {
+    int32_t py = gy + row;
+    if (py < 0 || py >= h) continue;
+    const uint8_t *a = g.alpha + row * g.width;
+    for (int col = 0; col < g.width; col++) {
+      int32_t px = gx + col;
+      if (a[col] == 0 || px < 0 || px >= w) continue;
+      uint16_t &pixel = buf[px + py * w];
+      if (a[col] == 255) {
+        pixel = swapped;
+      } else {
+        uint16_t bg = (pixel >> 8) | (pixel << 8);
+        uint16_t c = sprite.alphaBlend(a[col], color, bg);
+        pixel = (c >> 8) | (c << 8);
+      }
+    }
+  }
+}
+
+static void printStats(void)
+{
+  uint32_t total = stats.atlasStrings + stats.fontStrings;
+  if (total == 0 || total % GLYPH_STATS_STRINGS != 0) return;
+  Serial.printf("[GLYPH] atlas %u strings avg %llu us, OpenFontRender %u strings avg %llu us, %u glyphs cached in %u bytes\n",
+                stats.atlasStrings, (unsigned long long)(stats.atlasStrings ? stats.atlasUs / stats.atlasStrings : 0),
+                stats.fontStrings, (unsigned long long)(stats.fontStrings ? stats.fontUs / stats.fontStrings : 0),
+                stats.glyphs, stats.bytes);
+}
+
+void glyphDrawString(TFT_eSprite &sprite, OpenFontRender &render, const char *str,
+                     int32_t x, int32_t y, unsigned int size, uint16_t color, Align align, FT_BBox *drawn)
+{
+  int64_t start = esp_timer_get_time();
+
+  size_entry *s = (face != NULL && sprite.getColorDepth() == 16) ? getSize(size, render) : NULL;
+  ink_box box;
+  if (s != NULL && s->usable && layoutString(*s, str, box)) {
+    int32_t ox, oy;
+    placeString(*s, box, x, y, align, ox, oy);
+
+    // Pen start on the baseline, from the top-left of the ink box
+    int32_t pen = ox - box.x0;
+    int32_t baseline = oy - box.y0;
+    for (const char *p = str; *p; p++) {
+      glyph_entry *g = loadGlyph(*s, *p);
+      if (g->alpha != NULL) blendGlyph(sprite, *g, pen + g->left, baseline - g->top, color);
+      pen += g->advance;
+    }
+
+    stats.atlasStrings++;
+    stats.atlasUs += esp_timer_get_time() - start;
+    printStats();
+    if (drawn != NULL) *drawn = atlasBox(*s, box, ox, oy);
+    return;
+  }
+
+  render.setFontSize(size);
+  if (align == Align::Right)
+    render.rdrawString(str, x, y, color);
+  else
+    render.drawString(str, x, y, color);
+
+  stats.fontStrings++;
+  stats.fontUs += esp_timer_get_time() - start;
+  printStats();
+  if (drawn != NULL) *drawn = render.calculateBoundingBox(x, y, size, align, Layout::Horizontal, str);
+}
+
+glyph_stats getGlyphStats(void)
+{
+  return stats;
+}
+
+#endif
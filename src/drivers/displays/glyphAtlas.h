@@ -0,0 +1,45 @@
+#ifndef GLYPHATLAS_H_
+#define GLYPHATLAS_H_
+
+#include <TFT_eSPI.h>
+#include "OpenFontRender.h"
+
+// Glyph atlas
+// Glyphs of the TrueType font are rasterised once per size into 8 bit alpha
+// masks (PSRAM when available) and blended into the sprite on each draw, so
+// FreeType only runs the first time a glyph shows up. The masks don't depend
+// on the colour, it is applied while blending.
+// When the atlas can't place a string exactly where OpenFontRender would
+// (unknown layout at that size, glyph missing, memory budget reached) the
+// string is drawn by OpenFontRender as before.
+// Build with -D GLYPH_ATLAS=0 to always use OpenFontRender and compare the
+// [GLYPH] timings of both paths.
+
+#ifndef GLYPH_ATLAS
+#define GLYPH_ATLAS 1
+#endif
+
+#define GLYPH_MAX_GLYPHS      160
+#define GLYPH_MAX_SIZES       10
+#define GLYPH_INTERNAL_BYTES  24576   // Alpha mask budget without PSRAM
+#define GLYPH_STATS_STRINGS   600     // Strings between two stats reports
+
+typedef struct {
+  uint32_t glyphs;
+  uint32_t bytes;
+  uint32_t atlasStrings;            // Strings blended from the atlas
+  uint64_t atlasUs;
+  uint32_t fontStrings;             // Strings rendered by OpenFontRender
+  uint64_t fontUs;
+} glyph_stats;
+
+bool glyphAtlasBegin(const unsigned char *font, size_t length);
+
+// Same placement as OpenFontRender drawString/rdrawString (Align::Left/Right)
+// at the given size. drawn receives the bounding box of the string when not NULL
+void glyphDrawString(TFT_eSprite &sprite, OpenFontRender &render, const char *str,
+                     int32_t x, int32_t y, unsigned int size, uint16_t color, Align align, FT_BBox *drawn);
+
+glyph_stats getGlyphStats(void);
+
+#endif // GLYPHATLAS_H_
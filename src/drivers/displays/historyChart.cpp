@@ -0,0 +1,82 @@
+#include "displayDriver.h"
+
+#if defined(T_HMI_DISPLAY) || defined(ESP32_2432S028R) || defined(ESP32_2432S028_2USB)
+
+#include <Arduino.h>
+#include "historyChart.h"
+#include "history.h"
+#include "monitor.h"
+
+#define CHART_GRID    0x2104
+#define CHART_TEXT    0xDEDB
+
+typedef struct {
+  uint32_t from;
+  uint32_t minutes;
+  int32_t columns;
+} chart_query;
+
+static uint32_t peak[HISTORY_CHART_MAX_WIDTH];
+static uint8_t flags[HISTORY_CHART_MAX_WIDTH];    // 1 share, 2 offline, 4 sampled
+
+static bool addSample(const history_sample *s, void *arg)
+{
+  const chart_query *q = (const chart_query *)arg;
+  int32_t col = (int64_t)(s->time - q->from) * q->columns / (q->minutes * 60);
+  if (col < 0 || col >= q->columns) return true;
+
+  if (s->hashrate > peak[col]) peak[col] = s->hashrate;
+  if (s->shares) flags[col] |= 1;
+  if (!(s->state & HISTORY_WIFI)) flags[col] |= 2;
+  flags[col] |= 4;
+  return true;
+}
+
+void drawHistoryChart(TFT_eSPI &gfx, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t minutes)
+{
+  if (w > HISTORY_CHART_MAX_WIDTH) w = HISTORY_CHART_MAX_WIDTH;
+  gfx.fillRect(x, y, w, h, TFT_BLACK);
+
+  uint32_t now = getEpochSeconds();
+  memset(peak, 0, sizeof(peak));
+  memset(flags, 0, sizeof(flags));
+  chart_query q = {now > minutes * 60 ? now - minutes * 60 : 0, minutes, w};
+  uint32_t samples = now ? historyQuery(q.from, now, addSample, &q) : 0;
+
+  gfx.setTextFont(FONT2);
+  gfx.setTextSize(1);
+  gfx.setTextColor(CHART_TEXT, TFT_BLACK);
+  if (samples == 0) {
+    gfx.setTextDatum(MC_DATUM);
+    gfx.drawString("No history yet", x + w / 2, y + h / 2, FONT2);
+    return;
+  }
+
+  uint32_t top = 1;
+  for (int32_t i = 0; i < w; i++)
+    if (peak[i] > top) top = peak[i];
+
+  // Plot area below the caption, 4 px left for the share and WiFi ticks
+  int32_t py = y + 18;
+  int32_t ph = h - 18 - 4;
+  for (int32_t i = 1; i < 4; i++) gfx.drawFastHLine(x, py + ph * i / 4, w, CHART_GRID);
+  for (int32_t i = 1; i < 6; i++) gfx.drawFastVLine(x + w * i / 6, py, ph, CHART_GRID);
+
+  for (int32_t i = 0; i < w; i++) {
+    if (!(flags[i] & 4)) continue;
+    int32_t bar = (int64_t)peak[i] * ph / top;
+    if (bar > 0) gfx.drawFastVLine(x + i, py + ph - bar, bar, TFT_GREEN);
+    if (flags[i] & 1) gfx.drawFastVLine(x + i, py + ph, 4, TFT_YELLOW);
+    else if (flags[i] & 2) gfx.drawFastVLine(x + i, py + ph, 4, TFT_RED);
+  }
+
+  char caption[40];
+  snprintf(caption, sizeof(caption), "Peak %.2f KH/s", top / 1000.0);
+  gfx.setTextDatum(TL_DATUM);
+  gfx.drawString(caption, x + 2, y + 1, FONT2);
+  snprintf(caption, sizeof(caption), "%uh", minutes / 60);
+  gfx.setTextDatum(TR_DATUM);
+  gfx.drawString(caption, x + w - 2, y + 1, FONT2);
+}
+
+#endif
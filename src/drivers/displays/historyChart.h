@@ -0,0 +1,16 @@
+#ifndef HISTORYCHART_H_
+#define HISTORYCHART_H_
+
+#include <TFT_eSPI.h>
+
+// History chart
+// Draws the last minutes of the mining history (history.h) into a box: one
+// column per pixel holds the highest hashrate of the minutes it covers, a
+// yellow tick marks minutes with a 32 bit share and a red one minutes without
+// WiFi. Works on the panel or on a sprite.
+
+#define HISTORY_CHART_MAX_WIDTH   320
+
+void drawHistoryChart(TFT_eSPI &gfx, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t minutes);
+
+#endif // HISTORYCHART_H_
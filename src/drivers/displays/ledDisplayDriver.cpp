@@ -49,16 +49,16 @@ void ledDisplay_NoScreen(unsigned long mElapsed)
 
   // Print hashrate to serial
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Print extended data to serial for no display devices
-  Serial.printf(">>> Valid blocks: %s\n", data.valids.c_str());
-  Serial.printf(">>> Block templates: %s\n", data.templates.c_str());
-  Serial.printf(">>> Best difficulty: %s\n", data.bestDiff.c_str());
-  Serial.printf(">>> 32Bit shares: %s\n", data.completedShares.c_str());
-  Serial.printf(">>> Temperature: %s\n", data.temp.c_str());
-  Serial.printf(">>> Total MHashes: %s\n", data.totalMHashes.c_str());
-  Serial.printf(">>> Time mining: %s\n", data.timeMining.c_str());
+  Serial.printf(">>> Valid blocks: %s\n", data.valids);
+  Serial.printf(">>> Block templates: %s\n", data.templates);
+  Serial.printf(">>> Best difficulty: %s\n", data.bestDiff);
+  Serial.printf(">>> 32Bit shares: %s\n", data.completedShares);
+  Serial.printf(">>> Temperature: %s\n", data.temp);
+  Serial.printf(">>> Total MHashes: %s\n", data.totalMHashes);
+  Serial.printf(">>> Time mining: %s\n", data.timeMining);
 }
 void ledDisplay_LoadingScreen(void)
 {
@@ -130,6 +130,7 @@ DisplayDriver ledDisplayDriver = {
     ledDisplayCyclicScreens,
     ledDisplay_AnimateCurrentScreen,
     ledDisplay_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(ledDisplayCyclicScreens),
     0,
     0,
@@ -10,6 +10,7 @@
 #include "monitor.h"
 #include "drivers/storage/storage.h"
 #include "wManager.h"
+#include "mining.h"
 
 extern monitor_data mMonitor;
 extern TSettings Settings;
@@ -54,8 +55,8 @@ void m5stackDisplay_NoScreen(unsigned long mElapsed)
 
   // Print hashrate to serial
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
-  //Serial.printf(">>> Temperature: %s\n", data.temp.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
+  //Serial.printf(">>> Temperature: %s\n", data.temp);
 
   M5.Lcd.setTextColor(WHITE);
   M5.Lcd.setFreeFont(FMB9);
@@ -65,7 +66,7 @@ void m5stackDisplay_NoScreen(unsigned long mElapsed)
   M5.Lcd.println("   Han ANother SOLOminer");
   M5.Lcd.drawLine(0,25,320,25,GREENYELLOW);
   M5.Lcd.fillRect(0,30,320,20,WHITE);
-  M5.Lcd.progressBar(0,30,320,20, data.currentHashRate.toInt());
+  M5.Lcd.progressBar(0,30,320,20, atoi(data.currentHashRate));
   M5.Lcd.println("");
   M5.Lcd.println("");
   M5.Lcd.print("Avg. hashrate : "); M5.Lcd.setTextColor(GREEN); M5.Lcd.print(data.currentHashRate); M5.Lcd.setTextColor(WHITE); M5.Lcd.println(" KH/s");
@@ -77,7 +78,8 @@ void m5stackDisplay_NoScreen(unsigned long mElapsed)
   M5.Lcd.print("Valid blocks  : "); M5.Lcd.setTextColor(RED); M5.Lcd.println(data.valids); M5.Lcd.setTextColor(WHITE);
   M5.Lcd.println("");
   M5.Lcd.drawLine(0,200,320,200,GREENYELLOW);
-  M5.Lcd.print("Pool: "); M5.Lcd.setTextColor(GREENYELLOW); M5.Lcd.print(Settings.PoolAddress); M5.Lcd.print(":"); M5.Lcd.println(Settings.PoolPort); M5.Lcd.setTextColor(WHITE);
+  pool_settings pool = getPoolSettings();
+  M5.Lcd.print("Pool: "); M5.Lcd.setTextColor(GREENYELLOW); M5.Lcd.print(pool.address); M5.Lcd.print(":"); M5.Lcd.println(pool.port); M5.Lcd.setTextColor(WHITE);
   M5.Lcd.print("IP  : "); M5.Lcd.setTextColor(GREENYELLOW); M5.Lcd.println(WiFi.localIP()); M5.Lcd.setTextColor(WHITE);
   M5.Lcd.println("");
 }
@@ -110,6 +112,7 @@ DisplayDriver m5stackDisplayDriver = {
     m5stackDisplayCyclicScreens,
     m5stackDisplay_AnimateCurrentScreen,
     m5stackDisplay_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(m5stackDisplayCyclicScreens),
     0,
     0,
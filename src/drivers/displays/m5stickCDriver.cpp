@@ -55,7 +55,7 @@ void m5stickCDriver_MinerScreen(unsigned long mElapsed)
   M5.Lcd.setFreeFont(&DSEG7_Classic_Bold_12);
   M5.Lcd.setTextColor(LIGHTBLUE,BLACK);
   M5.Lcd.setCursor(69, 69);
-  M5.Lcd.println(String(data.currentHashRate));
+  M5.Lcd.println(data.currentHashRate);
 
   M5.Lcd.setTextFont(2);
   M5.Lcd.setTextColor(GRAY,BLACK);
@@ -69,7 +69,7 @@ void m5stickCDriver_MinerScreen(unsigned long mElapsed)
   M5.Lcd.setFreeFont(&DSEG7_Classic_Bold_17);
   M5.Lcd.setTextColor(LIGHTBLUE,BLACK);
   M5.Lcd.setCursor(101, 44);
-  M5.Lcd.println(String(data.valids));
+  M5.Lcd.println(data.valids);
   
 }
 
@@ -98,14 +98,14 @@ void m5stickCDriver_ClockScreen(unsigned long mElapsed)
   M5.Lcd.setFreeFont(&DSEG7_Classic_Bold_17);
   M5.Lcd.setTextColor(LIGHTBLUE,BLACK);
   M5.Lcd.setCursor(24, 42);
-  M5.Lcd.println(String(timeMining));
+  M5.Lcd.println(timeMining);
 
   M5.Lcd.drawFastHLine(1, 52, 180, ORANGE);
 
   M5.Lcd.setFreeFont(&DSEG7_Classic_Bold_17);
   M5.Lcd.setTextColor(LIGHTBLUE,BLACK);
   M5.Lcd.setCursor(82, 76);
-  M5.Lcd.println(String(data.currentTime));
+  M5.Lcd.println(data.currentTime);
 
   M5.Lcd.setTextFont(2);
   M5.Lcd.setTextColor(GRAY,BLACK);
@@ -119,7 +119,7 @@ void m5stickCDriver_GlobalHashScreen(unsigned long mElapsed)
   coin_data data = getCoinData(mElapsed);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   M5.Lcd.fillScreen(BLACK);
 
@@ -132,31 +132,31 @@ void m5stickCDriver_GlobalHashScreen(unsigned long mElapsed)
   M5.Lcd.setTextColor(ORANGE,BLACK);
   M5.Lcd.print("BTC    ");
   M5.Lcd.setTextColor(GRAY,BLACK);
-  M5.Lcd.print(data.btcPrice.c_str());
+  M5.Lcd.print(data.btcPrice);
 
   M5.Lcd.setCursor(5, 17);
   M5.Lcd.setTextColor(LIGHTBLUE,BLACK);
   M5.Lcd.print("Fee    ");
   M5.Lcd.setTextColor(GRAY,BLACK);
-  M5.Lcd.print(data.halfHourFee.c_str());
+  M5.Lcd.print(data.halfHourFee);
 
   M5.Lcd.setCursor(5, 33);
   M5.Lcd.setTextColor(ORANGE,BLACK);
   M5.Lcd.print("Diff    ");
   M5.Lcd.setTextColor(GRAY,BLACK);
-  M5.Lcd.print(data.netwrokDifficulty.c_str());
+  M5.Lcd.print(data.netwrokDifficulty);
 
   M5.Lcd.setCursor(5, 49);
   M5.Lcd.setTextColor(LIGHTBLUE,BLACK);
   M5.Lcd.print("GHash  ");
   M5.Lcd.setTextColor(GRAY,BLACK);
-  M5.Lcd.print(data.globalHashRate.c_str());
+  M5.Lcd.print(data.globalHashRate);
 
   M5.Lcd.setCursor(5, 65);
   M5.Lcd.setTextColor(ORANGE,BLACK);
   M5.Lcd.print("Height  ");
   M5.Lcd.setTextColor(GRAY,BLACK);
-  M5.Lcd.print(data.blockHeight.c_str());
+  M5.Lcd.print(data.blockHeight);
 
 }
 
@@ -194,6 +194,7 @@ DisplayDriver m5stickCDriver = {
     m5stickCDriverCyclicScreens,
     m5stickCDriver_AnimateCurrentScreen,
     m5stickCDriver_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(m5stickCDriverCyclicScreens),
     0,
     WIDTH,
@@ -5,6 +5,8 @@
 #include <Arduino.h>
 #include "monitor.h"
 #include "wManager.h"
+#include "fleet.h"
+#include "hashrate.h"
 
 extern monitor_data mMonitor;
 bool ledOn = false;
@@ -31,16 +33,26 @@ void noDisplay_NoScreen(unsigned long mElapsed)
 
   // Print hashrate to serial
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Print extended data to serial for no display devices
-  Serial.printf(">>> Valid blocks: %s\n", data.valids.c_str());
-  Serial.printf(">>> Block templates: %s\n", data.templates.c_str());
-  Serial.printf(">>> Best difficulty: %s\n", data.bestDiff.c_str());
-  Serial.printf(">>> 32Bit shares: %s\n", data.completedShares.c_str());
-  Serial.printf(">>> Temperature: %s\n", data.temp.c_str());
-  Serial.printf(">>> Total MHashes: %s\n", data.totalMHashes.c_str());
-  Serial.printf(">>> Time mining: %s\n", data.timeMining.c_str());
+  Serial.printf(">>> Valid blocks: %s\n", data.valids);
+  Serial.printf(">>> Block templates: %s\n", data.templates);
+  Serial.printf(">>> Best difficulty: %s\n", data.bestDiff);
+  Serial.printf(">>> 32Bit shares: %s\n", data.completedShares);
+  Serial.printf(">>> Temperature: %s\n", data.temp);
+  Serial.printf(">>> Total MHashes: %s\n", data.totalMHashes);
+  Serial.printf(">>> Time mining: %s\n", data.timeMining);
+
+  hashrate_data rate = getHashrate();
+  Serial.printf(">>> Hashrate 1m/15m/1h: %.2f / %.2f / %.2f KH/s (miners: %.2f / %.2f)\n",
+                rate.avg1m / 1000.0, rate.avg15m / 1000.0, rate.avg1h / 1000.0,
+                rate.worker[0] / 1000.0, rate.worker[1] / 1000.0);
+
+  fleet_data fleet = getFleetData();
+  if (fleet.miners > 1)
+    Serial.printf(">>> Fleet: %u miners, %.2f KH/s, %u shares, oldest job %us\n",
+                  fleet.miners, fleet.hashrate / 1000.0, fleet.shares, fleet.maxJobAge);
 }
 void noDisplay_LoadingScreen(void)
 {
@@ -105,6 +117,7 @@ DisplayDriver noDisplayDriver = {
     noDisplayCyclicScreens,
     noDisplay_AnimateCurrentScreen,
     noDisplay_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(noDisplayCyclicScreens),
     0,
     0,
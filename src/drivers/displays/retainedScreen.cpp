@@ -0,0 +1,178 @@
+#include "displayDriver.h"
+
+#ifdef T_DISPLAY
+
+#include <Arduino.h>
+#include "retainedScreen.h"
+
+#define BOX_PADDING 2   // Antialiased glyphs bleed a little out of their box
+
+static retained_screen *activeScreen = NULL;
+static retained_screen *frameScreen = NULL;
+static TFT_eSprite *frameSprite = NULL;
+static bool fullFrame = false;
+static int64_t frameStart = 0;
+
+static retained_rect dirty[RETAINED_MAX_DIRTY];
+static int dirtyCount = 0;
+
+static retained_stats stats = {0, 0, 0, 0, 0, 0};
+
+static bool rectEmpty(const retained_rect &r)
+{
+  return r.x1 <= r.x0 || r.y1 <= r.y0;
+}
+
+static retained_rect clipRect(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+  retained_rect r;
+  r.x0 = max(x0 - BOX_PADDING, (int32_t)0);
+  r.y0 = max(y0 - BOX_PADDING, (int32_t)0);
+  r.x1 = min(x1 + BOX_PADDING, (int32_t)frameSprite->width());
+  r.y1 = min(y1 + BOX_PADDING, (int32_t)frameSprite->height());
+  return r;
+}
+
+static void addDirty(const retained_rect &r)
+{
+  if (rectEmpty(r)) return;
+
+  // Merge with an overlapping rectangle so no pixel is sent twice
+  for (int i = 0; i < dirtyCount; i++) {
+    retained_rect &d = dirty[i];
+    if (r.x0 < d.x1 && d.x0 < r.x1 && r.y0 < d.y1 && d.y0 < r.y1) {
+      d.x0 = min(d.x0, r.x0);
+      d.y0 = min(d.y0, r.y0);
+      d.x1 = max(d.x1, r.x1);
+      d.y1 = max(d.y1, r.y1);
+      return;
+    }
+  }
+
+  if (dirtyCount < RETAINED_MAX_DIRTY) {
+    dirty[dirtyCount++] = r;
+  } else {
+    fullFrame = true;
+  }
+}
+
+// Copy a rectangle of the flash background back into the sprite
+static void restoreBackground(const retained_rect &r)
+{
+  const rle_image &img = *frameScreen->image;
+  int16_t imgX1 = min(r.x1, (int16_t)img.width);
+  int16_t imgY1 = min(r.y1, (int16_t)img.height);
+
+  if (imgX1 > r.x0 && imgY1 > r.y0)
+    rlePushRect(*frameSprite, r.x0, r.y0, img, r.x0, r.y0, imgX1 - r.x0, imgY1 - r.y0);
+
+  // Parts of the sprite not covered by the image
+  if (r.x1 > imgX1) frameSprite->fillRect(max(imgX1, r.x0), r.y0, r.x1 - max(imgX1, r.x0), r.y1 - r.y0, TFT_BLACK);
+  if (r.y1 > imgY1) frameSprite->fillRect(r.x0, max(imgY1, r.y0), r.x1 - r.x0, r.y1 - max(imgY1, r.y0), TFT_BLACK);
+}
+
+/// @brief Start a frame. Returns true when the whole screen is redrawn.
+bool retainedBegin(retained_screen *screen, TFT_eSprite *sprite)
+{
+  frameStart = esp_timer_get_time();
+  frameScreen = screen;
+  frameSprite = sprite;
+  dirtyCount = 0;
+  fullFrame = (screen != activeScreen);
+
+  if (fullFrame) {
+    for (int i = 0; i < RETAINED_MAX_WIDGETS; i++) {
+      screen->widgets[i].value[0] = 0;
+      screen->widgets[i].box = {0, 0, 0, 0};
+    }
+    rlePushImage(*sprite, 0, 0, *screen->image);
+    activeScreen = screen;
+  }
+  return fullFrame;
+}
+
+void retainedEnd(void)
+{
+  uint32_t bytes = 0;
+
+  if (fullFrame) {
+    frameSprite->pushSprite(0, 0);
+    bytes = frameSprite->width() * frameSprite->height() * 2;
+    stats.fullFrames++;
+  } else {
+    for (int i = 0; i < dirtyCount; i++) {
+      const retained_rect &r = dirty[i];
+      frameSprite->pushSprite(r.x0, r.y0, r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0);
+      bytes += (r.x1 - r.x0) * (r.y1 - r.y0) * 2;
+    }
+  }
+
+  stats.frames++;
+  stats.lastBytes = bytes;
+  stats.lastUs = esp_timer_get_time() - frameStart;
+  stats.totalBytes += stats.lastBytes;
+  stats.totalUs += stats.lastUs;
+
+  if (stats.frames % RETAINED_STATS_FRAMES == 0)
+    Serial.printf("[DISPLAY] avg %llu SPI bytes/frame (full frame %d), avg %llu us/frame, %u full frames\n",
+                  (unsigned long long)(stats.totalBytes / stats.frames), frameSprite->width() * frameSprite->height() * 2,
+                  (unsigned long long)(stats.totalUs / stats.frames), stats.fullFrames);
+}
+
+/// @brief Force a full redraw on the next frame (rotation, direct drawing on the panel...)
+void retainedInvalidate(void)
+{
+  activeScreen = NULL;
+}
+
+bool retainedChanged(int id, const char *value)
+{
+  retained_widget &w = frameScreen->widgets[id];
+  if (!fullFrame && strncmp(w.value, value, RETAINED_VALUE_LEN - 1) == 0) return false;
+
+  strncpy(w.value, value, RETAINED_VALUE_LEN - 1);
+  w.value[RETAINED_VALUE_LEN - 1] = 0;
+
+  if (!fullFrame && !rectEmpty(w.box)) {
+    restoreBackground(w.box);
+    addDirty(w.box);
+  }
+  w.box = {0, 0, 0, 0};
+  return true;
+}
+
+void retainedMark(int id, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+  retained_widget &w = frameScreen->widgets[id];
+  w.box = clipRect(x0, y0, x1, y1);
+  if (!fullFrame) addDirty(w.box);
+}
+
+void retainedMarkText(int id, OpenFontRender &render, int32_t x, int32_t y, unsigned int size, Align align, const char *str)
+{
+  FT_BBox box = render.calculateBoundingBox(x, y, size, align, Layout::Horizontal, str);
+  retainedMark(id, box.xMin, box.yMin, box.xMax + 1, box.yMax + 1);
+}
+
+void retainedMarkGfx(int id, int32_t x, int32_t y, uint8_t datum, const char *str, uint8_t font)
+{
+  int32_t w = frameSprite->textWidth(str, font);
+  int32_t h = frameSprite->fontHeight(font);
+
+  switch (datum % 3) {  // Horizontal part of the datum: left, center, right
+    case 1: x -= w / 2; break;
+    case 2: x -= w; break;
+  }
+  switch (datum / 3) {  // Vertical part: top, middle, bottom
+    case 1: y -= h / 2; break;
+    case 2: y -= h; break;
+  }
+  retainedMark(id, x, y, x + w, y + h);
+}
+
+retained_stats getRetainedStats(void)
+{
+  return stats;
+}
+
+#endif
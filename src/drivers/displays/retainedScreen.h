@@ -0,0 +1,57 @@
+#ifndef RETAINEDSCREEN_H_
+#define RETAINEDSCREEN_H_
+
+#include <TFT_eSPI.h>
+#include "OpenFontRender.h"
+#include "rleImage.h"
+
+// Retained mode screens
+// Each screen keeps the last value and bounding box of its widgets. A frame
+// only restores the boxes of the widgets whose value changed from the flash
+// background, re-renders them and pushes those rectangles to the panel.
+// A full frame is drawn when the screen changes or after retainedInvalidate().
+
+#define RETAINED_MAX_WIDGETS  12
+#define RETAINED_VALUE_LEN    24
+#define RETAINED_MAX_DIRTY    (2 * RETAINED_MAX_WIDGETS)
+#define RETAINED_STATS_FRAMES 60    // Frames between two stats reports
+
+typedef struct {
+  int16_t x0, y0, x1, y1;           // Inclusive-exclusive, x1 <= x0 means empty
+} retained_rect;
+
+typedef struct {
+  char value[RETAINED_VALUE_LEN];
+  retained_rect box;
+} retained_widget;
+
+typedef struct {
+  const rle_image *image;           // Background in flash
+  retained_widget widgets[RETAINED_MAX_WIDGETS];
+} retained_screen;
+
+typedef struct {
+  uint32_t frames;
+  uint32_t fullFrames;
+  uint32_t lastBytes;               // Bytes sent to the panel in the last frame
+  uint32_t lastUs;                  // Render and push time of the last frame
+  uint64_t totalBytes;
+  uint64_t totalUs;
+} retained_stats;
+
+#define RETAINED_SCREEN(img) { &img, {} }
+
+// Frame
+bool retainedBegin(retained_screen *screen, TFT_eSprite *sprite);
+void retainedEnd(void);
+void retainedInvalidate(void);
+
+// Widgets: returns true when the value changed and the widget must be drawn
+bool retainedChanged(int id, const char *value);
+void retainedMark(int id, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+void retainedMarkText(int id, OpenFontRender &render, int32_t x, int32_t y, unsigned int size, Align align, const char *str);
+void retainedMarkGfx(int id, int32_t x, int32_t y, uint8_t datum, const char *str, uint8_t font);
+
+retained_stats getRetainedStats(void);
+
+#endif // RETAINEDSCREEN_H_
@@ -0,0 +1,130 @@
+#include "displayDriver.h"
+
+#if defined(T_DISPLAY) || defined(V1_DISPLAY) || defined(T_QT_DISPLAY) || defined(T_HMI_DISPLAY) || defined(ESP32_2432S028R) || defined(ESP32_2432S028_2USB)
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "rleImage.h"
+
+static uint16_t line[RLE_MAX_WIDTH];
+static rle_stats stats = {0, 0, 0, 0, 0, 0};
+
+// Decode pixels sx to sx + w of a row into line
+static void decodeRow(const rle_image &img, int32_t y, int32_t sx, int32_t w)
+{
+  const uint8_t *p = img.data + img.rows[y];
+  int32_t end = sx + w;
+  int32_t x = 0;
+
+  while (x < end) {
+    uint8_t header = *p++;
+    int32_t count = (header & 0x7F) + 1;
+    int32_t from = max(x, sx);
+    int32_t to = min(x + count, end);
+
+    if (header & 0x80) {
+      uint16_t color = p[0] | (p[1] << 8);
+      for (int32_t i = from; i < to; i++) line[i - sx] = color;
+      p += 2;
+    } else {
+      if (to > from) memcpy(line + (from - sx), p + 2 * (from - x), 2 * (to - from));
+      p += 2 * count;
+    }
+    x += count;
+  }
+}
+
+template <typename T>
+static void pushRows(T &target, int32_t x, int32_t y, const rle_image &img, int32_t sx, int32_t sy, int32_t w, int32_t h)
+{
+  if (img.data == NULL) {
+    if (sx == 0 && w == img.width) {
+      target.pushImage(x, y, w, h, img.raw + sy * img.width);
+    } else {
+      for (int32_t row = 0; row < h; row++)
+        target.pushImage(x, y + row, w, 1, img.raw + (sy + row) * img.width + sx);
+    }
+    return;
+  }
+
+  for (int32_t row = 0; row < h; row++) {
+    decodeRow(img, sy + row, sx, w);
+    target.pushImage(x, y + row, w, 1, line);
+  }
+}
+
+static void addStats(bool whole, int64_t start, int32_t w, int32_t h)
+{
+  uint32_t us = esp_timer_get_time() - start;
+
+  if (stats.firstFrameMs == 0) {
+    stats.firstFrameMs = esp_timer_get_time() / 1000;
+    Serial.printf("[IMAGE] First background drawn at %u ms in %u us (%s)\n",
+                  stats.firstFrameMs, us, RLE_IMAGES ? "rle" : "raw");
+  }
+
+  stats.pixels += w * h;
+  stats.us += us;
+  if (!whole) {
+    stats.rects++;
+    return;
+  }
+
+  stats.images++;
+  stats.imageUs += us;
+  if (stats.images % RLE_STATS_IMAGES == 0)
+    Serial.printf("[IMAGE] %u backgrounds avg %llu us, %u restores, %llu ns/pixel (%s)\n",
+                  stats.images, (unsigned long long)(stats.imageUs / stats.images), stats.rects,
+                  (unsigned long long)(stats.pixels ? stats.us * 1000 / stats.pixels : 0), RLE_IMAGES ? "rle" : "raw");
+}
+
+static bool clipRect(int32_t targetWidth, int32_t targetHeight, int32_t &x, int32_t &y, const rle_image &img,
+                     int32_t &sx, int32_t &sy, int32_t &w, int32_t &h)
+{
+  if (x < 0) { sx -= x; w += x; x = 0; }
+  if (y < 0) { sy -= y; h += y; y = 0; }
+  w = min(w, min(targetWidth - x, img.width - sx));
+  w = min(w, (int32_t)RLE_MAX_WIDTH);
+  h = min(h, min(targetHeight - y, img.height - sy));
+  return w > 0 && h > 0;
+}
+
+void rlePushRect(TFT_eSprite &sprite, int32_t x, int32_t y, const rle_image &img, int32_t sx, int32_t sy, int32_t w, int32_t h)
+{
+  int64_t start = esp_timer_get_time();
+  bool whole = (sx == 0 && sy == 0 && w >= img.width && h >= img.height);
+  if (!clipRect(sprite.width(), sprite.height(), x, y, img, sx, sy, w, h)) return;
+
+  pushRows(sprite, x, y, img, sx, sy, w, h);
+  addStats(whole, start, w, h);
+}
+
+void rlePushRect(TFT_eSPI &tft, int32_t x, int32_t y, const rle_image &img, int32_t sx, int32_t sy, int32_t w, int32_t h)
+{
+  int64_t start = esp_timer_get_time();
+  bool whole = (sx == 0 && sy == 0 && w >= img.width && h >= img.height);
+  if (!clipRect(tft.width(), tft.height(), x, y, img, sx, sy, w, h)) return;
+
+  // Keep the bus for the whole image instead of one transaction per row
+  tft.startWrite();
+  pushRows(tft, x, y, img, sx, sy, w, h);
+  tft.endWrite();
+  addStats(whole, start, w, h);
+}
+
+void rlePushImage(TFT_eSprite &sprite, int32_t x, int32_t y, const rle_image &img)
+{
+  rlePushRect(sprite, x, y, img, 0, 0, img.width, img.height);
+}
+
+void rlePushImage(TFT_eSPI &tft, int32_t x, int32_t y, const rle_image &img)
+{
+  rlePushRect(tft, x, y, img, 0, 0, img.width, img.height);
+}
+
+rle_stats getRleStats(void)
+{
+  return stats;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef RLEIMAGE_H_
+#define RLEIMAGE_H_
+
+#include <TFT_eSPI.h>
+
+// Compressed screen backgrounds
+// tools/compress_images.py turns the media headers into run length encoded
+// rows (media/*_rle.h) at build time. Rows are decoded one at a time into a
+// line buffer and pushed to a sprite or straight to a panel window, so a
+// background never needs a full size copy in RAM.
+// Build with -D RLE_IMAGES=0 to link the raw arrays instead and compare the
+// [IMAGE] timings of both paths.
+
+#ifndef RLE_IMAGES
+#define RLE_IMAGES 1
+#endif
+
+#define RLE_MAX_WIDTH     320
+#define RLE_STATS_IMAGES  50      // Backgrounds drawn between two stats reports
+
+typedef struct {
+  const uint8_t *data;              // Packets of all rows, NULL for a raw image
+  const uint32_t *rows;             // Offset of each row in data
+  const uint16_t *raw;              // Uncompressed pixels when built with RLE_IMAGES=0
+  uint16_t width;
+  uint16_t height;
+} rle_image;
+
+typedef struct {
+  uint32_t images;                  // Whole backgrounds drawn
+  uint64_t imageUs;
+  uint32_t rects;                   // Partial restores
+  uint64_t pixels;                  // Pixels of both
+  uint64_t us;
+  uint32_t firstFrameMs;            // Time since boot when the first background was drawn
+} rle_stats;
+
+// Whole image at x, y, clipped to the target
+void rlePushImage(TFT_eSprite &sprite, int32_t x, int32_t y, const rle_image &img);
+void rlePushImage(TFT_eSPI &tft, int32_t x, int32_t y, const rle_image &img);
+
+// w x h pixels of the image starting at sx, sy, drawn at x, y. The rectangle
+// must lie inside the image.
+void rlePushRect(TFT_eSprite &sprite, int32_t x, int32_t y, const rle_image &img, int32_t sx, int32_t sy, int32_t w, int32_t h);
+void rlePushRect(TFT_eSPI &tft, int32_t x, int32_t y, const rle_image &img, int32_t sx, int32_t sy, int32_t w, int32_t h);
+
+rle_stats getRleStats(void);
+
+#endif // RLEIMAGE_H_
@@ -3,13 +3,15 @@
 #ifdef T_DISPLAY
 
 #include <TFT_eSPI.h>
-#include "media/images_320_170.h"
+#include "media/images_320_170_rle.h"
 #include "media/myFonts.h"
 #include "media/Free_Fonts.h"
 #include "version.h"
 #include "monitor.h"
 #include "OpenFontRender.h"
 #include "rotation.h"
+#include "retainedScreen.h"
+#include "glyphAtlas.h"
 
 #define WIDTH 340
 #define HEIGHT 170
@@ -45,6 +47,7 @@ void tDisplay_Init(void)
     Serial.println("Initialise error");
     return;
   }
+  glyphAtlasBegin(DigitalNumbers, sizeof(DigitalNumbers));
 }
 
 void tDisplay_AlternateScreenState(void)
@@ -57,209 +60,216 @@ void tDisplay_AlternateScreenState(void)
 void tDisplay_AlternateRotation(void)
 {
   tft.setRotation( flipRotation(tft.getRotation()) );
+  retainedInvalidate();
+}
+
+// Retained screens, only the widgets whose value changed are redrawn and pushed
+enum { MINER_HASHRATE, MINER_MHASHES, MINER_TEMPLATES, MINER_BESTDIFF, MINER_SHARES, MINER_TIMEMINING, MINER_VALIDS, MINER_TEMP, MINER_TIME };
+enum { CLOCK_HASHRATE, CLOCK_PRICE, CLOCK_BLOCK, CLOCK_TIME };
+enum { GLOBAL_PRICE, GLOBAL_TIME, GLOBAL_FEE, GLOBAL_DIFFICULTY, GLOBAL_HASHRATE, GLOBAL_BLOCK, GLOBAL_PROGRESS };
+enum { PRICE_HASHRATE, PRICE_BLOCK, PRICE_TIME, PRICE_PRICE };
+
+static retained_screen minerScreen = RETAINED_SCREEN(MinerScreen_rle);
+static retained_screen clockScreen = RETAINED_SCREEN(minerClockScreen_rle);
+static retained_screen globalScreen = RETAINED_SCREEN(globalHashScreen_rle);
+static retained_screen priceScreenR = RETAINED_SCREEN(priceScreen_rle);
+
+static void tDisplay_Text(int id, const char *value, unsigned int size, int32_t x, int32_t y, uint16_t color, Align align)
+{
+  if (!retainedChanged(id, value)) return;
+  FT_BBox box;
+  glyphDrawString(background, render, value, x, y, size, color, align, &box);
+  retainedMark(id, box.xMin, box.yMin, box.xMax + 1, box.yMax + 1);
+}
+
+static void tDisplay_GfxText(int id, const char *value, int32_t x, int32_t y, uint8_t datum)
+{
+  if (!retainedChanged(id, value)) return;
+  background.setTextDatum(datum);
+  background.drawString(value, x, y, GFXFF);
+  retainedMarkGfx(id, x, y, datum, value, GFXFF);
 }
 
 void tDisplay_MinerScreen(unsigned long mElapsed)
 {
   mining_data data = getMiningData(mElapsed);
 
-  // Print background screen
-  background.pushImage(0, 0, MinerWidth, MinerHeight, MinerScreen);
+  // Print background screen (only when coming from another screen)
+  bool full = retainedBegin(&minerScreen, &background);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Hashrate
-  render.setFontSize(35);
-  render.setCursor(19, 118);
   render.setFontColor(TFT_BLACK);
-
-  render.rdrawString(data.currentHashRate.c_str(), 118, 114, TFT_BLACK);
+  tDisplay_Text(MINER_HASHRATE, data.currentHashRate, 35, 118, 114, TFT_BLACK, Align::Right);
   // Total hashes
-  render.setFontSize(18);
-  render.rdrawString(data.totalMHashes.c_str(), 268, 138, TFT_BLACK);
+  tDisplay_Text(MINER_MHASHES, data.totalMHashes, 18, 268, 138, TFT_BLACK, Align::Right);
   // Block templates
-  render.setFontSize(18);
-  render.drawString(data.templates.c_str(), 186, 20, 0xDEDB);
+  tDisplay_Text(MINER_TEMPLATES, data.templates, 18, 186, 20, 0xDEDB, Align::Left);
   // Best diff
-  render.drawString(data.bestDiff.c_str(), 186, 48, 0xDEDB);
+  tDisplay_Text(MINER_BESTDIFF, data.bestDiff, 18, 186, 48, 0xDEDB, Align::Left);
   // 32Bit shares
-  render.setFontSize(18);
-  render.drawString(data.completedShares.c_str(), 186, 76, 0xDEDB);
+  tDisplay_Text(MINER_SHARES, data.completedShares, 18, 186, 76, 0xDEDB, Align::Left);
   // Hores
-  render.setFontSize(14);
-  render.rdrawString(data.timeMining.c_str(), 315, 104, 0xDEDB);
+  tDisplay_Text(MINER_TIMEMINING, data.timeMining, 14, 315, 104, 0xDEDB, Align::Right);
 
   // Valid Blocks
-  render.setFontSize(24);
-  render.drawString(data.valids.c_str(), 285, 56, 0xDEDB);
+  tDisplay_Text(MINER_VALIDS, data.valids, 24, 285, 56, 0xDEDB, Align::Left);
 
   // Print Temp
-  render.setFontSize(10);
-  render.rdrawString(data.temp.c_str(), 239, 1, TFT_BLACK);
+  tDisplay_Text(MINER_TEMP, data.temp, 10, 239, 1, TFT_BLACK, Align::Right);
 
-  render.setFontSize(4);
-  render.rdrawString(String(0).c_str(), 244, 3, TFT_BLACK);
+  if (full) {
+    render.setFontSize(4);
+    render.rdrawString("0", 244, 3, TFT_BLACK);
+  }
 
   // Print Hour
-  render.setFontSize(10);
-  render.rdrawString(data.currentTime.c_str(), 286, 1, TFT_BLACK);
+  tDisplay_Text(MINER_TIME, data.currentTime, 10, 286, 1, TFT_BLACK, Align::Right);
 
-  // Push prepared background to screen
-  background.pushSprite(0, 0);
+  // Push changed regions to screen
+  retainedEnd();
 }
 
 void tDisplay_ClockScreen(unsigned long mElapsed)
 {
   clock_data data = getClockData(mElapsed);
 
-  // Print background screen
-  background.pushImage(0, 0, minerClockWidth, minerClockHeight, minerClockScreen);
+  // Print background screen (only when coming from another screen)
+  retainedBegin(&clockScreen, &background);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Hashrate
-  render.setFontSize(25);
-  render.setCursor(19, 122);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 94, 129, TFT_BLACK);
+  tDisplay_Text(CLOCK_HASHRATE, data.currentHashRate, 25, 94, 129, TFT_BLACK, Align::Right);
 
   // Print BTC Price
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
-  background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 202, 3, GFXFF);
+  tDisplay_GfxText(CLOCK_PRICE, data.btcPrice, 202, 3, TL_DATUM);
 
   // Print BlockHeight
-  render.setFontSize(18);
-  render.rdrawString(data.blockHeight.c_str(), 254, 140, TFT_BLACK);
+  tDisplay_Text(CLOCK_BLOCK, data.blockHeight, 18, 254, 140, TFT_BLACK, Align::Right);
 
   // Print Hour
   background.setFreeFont(FF23);
   background.setTextSize(2);
   background.setTextColor(0xDEDB, TFT_BLACK);
+  tDisplay_GfxText(CLOCK_TIME, data.currentTime, 130, 50, TL_DATUM);
 
-  background.drawString(data.currentTime.c_str(), 130, 50, GFXFF);
-
-  // Push prepared background to screen
-  background.pushSprite(0, 0);
+  // Push changed regions to screen
+  retainedEnd();
 }
 
 void tDisplay_GlobalHashScreen(unsigned long mElapsed)
 {
   coin_data data = getCoinData(mElapsed);
 
-  // Print background screen
-  background.pushImage(0, 0, globalHashWidth, globalHashHeight, globalHashScreen);
+  // Print background screen (only when coming from another screen)
+  retainedBegin(&globalScreen, &background);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Print BTC Price
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
-  background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 198, 3, GFXFF);
+  tDisplay_GfxText(GLOBAL_PRICE, data.btcPrice, 198, 3, TL_DATUM);
 
   // Print Hour
-  background.setFreeFont(FSSB9);
-  background.setTextSize(1);
-  background.setTextDatum(TL_DATUM);
-  background.setTextColor(TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), 268, 3, GFXFF);
+  tDisplay_GfxText(GLOBAL_TIME, data.currentTime, 268, 3, TL_DATUM);
 
   // Print Last Pool Block
   background.setFreeFont(FSS9);
-  background.setTextDatum(TR_DATUM);
   background.setTextColor(0x9C92);
-  background.drawString(data.halfHourFee.c_str(), 302, 52, GFXFF);
+  tDisplay_GfxText(GLOBAL_FEE, data.halfHourFee, 302, 52, TR_DATUM);
 
   // Print Difficulty
-  background.setFreeFont(FSS9);
-  background.setTextDatum(TR_DATUM);
-  background.setTextColor(0x9C92);
-  background.drawString(data.netwrokDifficulty.c_str(), 302, 88, GFXFF);
+  tDisplay_GfxText(GLOBAL_DIFFICULTY, data.netwrokDifficulty, 302, 88, TR_DATUM);
 
   // Print Global Hashrate
-  render.setFontSize(17);
-  render.rdrawString(data.globalHashRate.c_str(), 274, 145, TFT_BLACK);
+  tDisplay_Text(GLOBAL_HASHRATE, data.globalHashRate, 17, 274, 145, TFT_BLACK, Align::Right);
 
   // Print BlockHeight
-  render.setFontSize(28);
-  render.rdrawString(data.blockHeight.c_str(), 140, 104, 0xDEDB);
-
-  // Draw percentage rectangle
-  int x2 = 2 + (138 * data.progressPercent / 100);
-  background.fillRect(2, 149, x2, 168, 0xDEDB);
-
-  // Print Remaining BLocks
-  background.setTextFont(FONT2);
-  background.setTextSize(1);
-  background.setTextDatum(MC_DATUM);
-  background.setTextColor(TFT_BLACK);
-  background.drawString(data.remainingBlocks.c_str(), 72, 159, FONT2);
+  tDisplay_Text(GLOBAL_BLOCK, data.blockHeight, 28, 140, 104, 0xDEDB, Align::Right);
+
+  // Percentage rectangle and remaining blocks share the same area
+  char progress[RETAINED_VALUE_LEN];
+  snprintf(progress, sizeof(progress), "%d %s", (int)data.progressPercent, data.remainingBlocks);
+  if (retainedChanged(GLOBAL_PROGRESS, progress)) {
+    // Draw percentage rectangle
+    int x2 = 2 + (138 * data.progressPercent / 100);
+    background.fillRect(2, 149, x2, 168, 0xDEDB);
+
+    // Print Remaining BLocks
+    background.setTextFont(FONT2);
+    background.setTextSize(1);
+    background.setTextDatum(MC_DATUM);
+    background.setTextColor(TFT_BLACK);
+    background.drawString(data.remainingBlocks, 72, 159, FONT2);
+    retainedMark(GLOBAL_PROGRESS, 0, 147, max(2 + x2, 140), HEIGHT);
+  }
 
-  // Push prepared background to screen
-  background.pushSprite(0, 0);
+  // Push changed regions to screen
+  retainedEnd();
 }
 
 
 void tDisplay_BTCprice(unsigned long mElapsed)
 {
   clock_data data = getClockData(mElapsed);
-  data.currentDate ="01/12/2023";
+  strcpy(data.currentDate, "01/12/2023");
   
   //if(data.currentDate.indexOf("12/2023")>) { tDisplay_ChristmasContent(data); return; }
 
-  // Print background screen
-  background.pushImage(0, 0, priceScreenWidth, priceScreenHeight, priceScreen);
+  // Print background screen (only when coming from another screen)
+  retainedBegin(&priceScreenR, &background);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Hashrate
-  render.setFontSize(25);
-  render.setCursor(19, 122);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 94, 129, TFT_BLACK);
+  tDisplay_Text(PRICE_HASHRATE, data.currentHashRate, 25, 94, 129, TFT_BLACK, Align::Right);
 
   // Print BlockHeight
-  render.setFontSize(18);
-  render.rdrawString(data.blockHeight.c_str(), 254, 138, TFT_WHITE);
+  tDisplay_Text(PRICE_BLOCK, data.blockHeight, 18, 254, 138, TFT_WHITE, Align::Right);
 
   // Print Hour
   
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
-  background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), 222, 3, GFXFF);
+  tDisplay_GfxText(PRICE_TIME, data.currentTime, 222, 3, TL_DATUM);
 
   // Print BTC Price 
   background.setFreeFont(FF24);
-  background.setTextDatum(TR_DATUM);
   background.setTextSize(1);
   background.setTextColor(0xDEDB, TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 300, 58, GFXFF);
+  tDisplay_GfxText(PRICE_PRICE, data.btcPrice, 300, 58, TR_DATUM);
 
-  // Push prepared background to screen
-  background.pushSprite(0, 0);
+  // Push changed regions to screen
+  retainedEnd();
 }
 
 void tDisplay_LoadingScreen(void)
 {
+  retainedInvalidate();
   tft.fillScreen(TFT_BLACK);
-  tft.pushImage(0, 0, initWidth, initHeight, initScreen);
+  rlePushImage(tft, 0, 0, initScreen_rle);
   tft.setTextColor(TFT_BLACK);
   tft.drawString(CURRENT_VERSION, 24, 147, FONT2);
 }
 
 void tDisplay_SetupScreen(void)
 {
-  tft.pushImage(0, 0, setupModeWidth, setupModeHeight, setupModeScreen);
+  retainedInvalidate();
+  rlePushImage(tft, 0, 0, setupModeScreen_rle);
 }
 
 void tDisplay_AnimateCurrentScreen(unsigned long frame)
@@ -281,6 +291,7 @@ DisplayDriver tDisplayDriver = {
     tDisplayCyclicScreens,
     tDisplay_AnimateCurrentScreen,
     tDisplay_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(tDisplayCyclicScreens),
     0,
     WIDTH,
@@ -5,13 +5,14 @@
 #include <xpt2046.h> // https://github.com/liangyingy/arduino_xpt2046_library
 #include <TFT_eSPI.h>
 #include <TFT_eTouch.h>
-#include "media/images_320_170.h"
-#include "media/images_bottom_320_70.h"
+#include "media/images_320_170_rle.h"
+#include "media/images_bottom_320_70_rle.h"
 #include "media/myFonts.h"
 #include "media/Free_Fonts.h"
 #include "version.h"
 #include "monitor.h"
 #include "OpenFontRender.h"
+#include "historyChart.h"
 #ifdef TOUCH_ENABLE
 #include "TouchHandler.h"
 #endif
@@ -92,8 +93,8 @@ void t_hmiDisplay_Init(void)
   pinMode(LED_PIN, OUTPUT);
   pinMode(BK_LIGHT_PIN, OUTPUT);
   digitalWrite(BK_LIGHT_PIN, BK_LIGHT_LEVEL);
-  pData.bestDifficulty = "0";
-  pData.workersHash = "0";
+  strcpy(pData.bestDifficulty, "0");
+  strcpy(pData.workersHash, "0");
   pData.workersCount = 0;
 }
 
@@ -116,15 +117,17 @@ void printPoolData()
   // Serial.println(ESP.getFreeHeap()); 
   pData = getPoolData();
 
-  background.pushImage(0, 170, 320, 70, bottonPoolScreen);
+  rlePushImage(background, 0, 170, bottonPoolScreen_rle);
   render.setLineSpaceRatio(1);
   
   render.setFontSize(24);
-  render.drawString(String(pData.workersCount).c_str(), 146, 170+35, TFT_BLACK);
+  char workersCount[8];
+  snprintf(workersCount, sizeof(workersCount), "%d", pData.workersCount);
+  render.drawString(workersCount, 146, 170+35, TFT_BLACK);
 
   render.setFontSize(18);
-  render.drawString(pData.workersHash.c_str(), 216, 170+34, TFT_BLACK);
-  render.drawString(pData.bestDifficulty.c_str(), 5, 170+34, TFT_BLACK);
+  render.drawString(pData.workersHash, 216, 170+34, TFT_BLACK);
+  render.drawString(pData.bestDifficulty, 5, 170+34, TFT_BLACK);
   // printBatteryVoltage();
 }
 
@@ -137,67 +140,69 @@ void printMemPoolFees(unsigned long mElapsed)
   coin_data data = getCoinData(mElapsed);
 
   render.setFontSize(18);
-  background.pushImage(0, 170, 320, 70, bottomMemPoolFees);
+  rlePushImage(background, 0, 170, bottomMemPoolFees_rle);
   if (showbtcprice)
   {
     // XXX -- remove when bitmap is done
     background.fillRect( 105, 170,  110, 20, TFT_BLACK);
     
-    String st = data.btcPrice;
-    if (st.length()) st.remove(st.length()-1);
-    render.drawString(st.c_str(),  125, 170,  TFT_WHITE);
+    // Price without the trailing $
+    char st[sizeof(data.btcPrice)];
+    strlcpy(st, data.btcPrice, sizeof(st));
+    if (strlen(st)) st[strlen(st)-1] = 0;
+    render.drawString(st,  125, 170,  TFT_WHITE);
   }
-  render.drawString(data.economyFee.c_str(), 140, 170+38, TFT_BLACK);
+  render.drawString(data.economyFee, 140, 170+38, TFT_BLACK);
 
   render.setFontSize(18);
   // XXX - less than sign in DigitalNumbers
   // render.drawChar('<', 245, 170+32, TFT_RED);
-  render.drawString(data.minimumFee.c_str(), 250, 170+32, TFT_RED);
-  render.drawString(data.fastestFee.c_str(), 30, 170+32, TFT_BLACK);
+  render.drawString(data.minimumFee, 250, 170+32, TFT_RED);
+  render.drawString(data.fastestFee, 30, 170+32, TFT_BLACK);
   // printBatteryVoltage();
 }
 
 void t_hmiDisplay_MinerScreen(unsigned long mElapsed)
 {
   mining_data data = getMiningData(mElapsed);
-  background.pushImage(0, 0, MinerWidth, 170, MinerScreen);
+  rlePushImage(background, 0, 0, MinerScreen_rle);
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
    // Hashrate
   render.setFontSize(35);
   render.setCursor(19, 118);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 118, 114, TFT_BLACK);
+  render.rdrawString(data.currentHashRate, 118, 114, TFT_BLACK);
   
   // Total hashes
   render.setFontSize(18);
-  render.rdrawString(data.totalMHashes.c_str(), 268, 138, TFT_BLACK);
+  render.rdrawString(data.totalMHashes, 268, 138, TFT_BLACK);
   // Block templates
   render.setFontSize(18);
-  render.drawString(data.templates.c_str(), 186, 20, 0xDEDB);
+  render.drawString(data.templates, 186, 20, 0xDEDB);
   // Best diff
-  render.drawString(data.bestDiff.c_str(), 186, 48, 0xDEDB);
+  render.drawString(data.bestDiff, 186, 48, 0xDEDB);
   // 32Bit shares
   render.setFontSize(18);
-  render.drawString(data.completedShares.c_str(), 186, 76, 0xDEDB);
+  render.drawString(data.completedShares, 186, 76, 0xDEDB);
   // Hores
   render.setFontSize(14);
-  render.rdrawString(data.timeMining.c_str(), 315, 104, 0xDEDB);
+  render.rdrawString(data.timeMining, 315, 104, 0xDEDB);
 
   // Valid Blocks
   render.setFontSize(24);
-  render.drawString(data.valids.c_str(), 285, 56, 0xDEDB);
+  render.drawString(data.valids, 285, 56, 0xDEDB);
 
   // Print Temp
   render.setFontSize(10);
-  render.rdrawString(data.temp.c_str(), 239, 1, TFT_BLACK);
+  render.rdrawString(data.temp, 239, 1, TFT_BLACK);
 
   render.setFontSize(4);
   render.rdrawString(String(0).c_str(), 244, 3, TFT_BLACK);
 
   // Print Hour
   render.setFontSize(10);
-  render.rdrawString(data.currentTime.c_str(), 286, 1, TFT_BLACK);
+  render.rdrawString(data.currentTime, 286, 1, TFT_BLACK);
 
   if (lowerScreen == 1)
     printPoolData();
@@ -213,34 +218,34 @@ void t_hmiDisplay_ClockScreen(unsigned long mElapsed)
   clock_data data = getClockData(mElapsed);
 
   // Print background screen
-  background.pushImage(0, 0, minerClockWidth, 170 /*minerClockHeight*/, minerClockScreen);
+  rlePushImage(background, 0, 0, minerClockScreen_rle);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Hashrate
   render.setFontSize(25);
   render.setCursor(19, 122);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 94, 129, TFT_BLACK);
+  render.rdrawString(data.currentHashRate, 94, 129, TFT_BLACK);
 
   // Print BTC Price
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 202, 3, GFXFF);
+  background.drawString(data.btcPrice, 202, 3, GFXFF);
 
   // Print BlockHeight
   render.setFontSize(18);
-  render.rdrawString(data.blockHeight.c_str(), 254, 140, TFT_BLACK);
+  render.rdrawString(data.blockHeight, 254, 140, TFT_BLACK);
 
   // Print Hour
   background.setFreeFont(FF23);
   background.setTextSize(2);
   background.setTextColor(0xDEDB, TFT_BLACK);
 
-  background.drawString(data.currentTime.c_str(), 130, 50, GFXFF);
+  background.drawString(data.currentTime, 130, 50, GFXFF);
   if (lowerScreen == 1)
     printMemPoolFees(mElapsed);
   else
@@ -254,44 +259,44 @@ void t_hmiDisplay_GlobalHashScreen(unsigned long mElapsed)
   coin_data data = getCoinData(mElapsed);
 
   // Print background screen
-  background.pushImage(0, 0, globalHashWidth, 170 /* globalHashHeight */, globalHashScreen);
+  rlePushImage(background, 0, 0, globalHashScreen_rle);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Print BTC Price
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 198, 3, GFXFF);
+  background.drawString(data.btcPrice, 198, 3, GFXFF);
 
   // Print Hour
   background.setFreeFont(FSSB9);
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), 268, 3, GFXFF);
+  background.drawString(data.currentTime, 268, 3, GFXFF);
 
   // Print Last Pool Block
   background.setFreeFont(FSS9);
   background.setTextDatum(TR_DATUM);
   background.setTextColor(0x9C92);
-  background.drawString(data.halfHourFee.c_str(), 302, 52, GFXFF);
+  background.drawString(data.halfHourFee, 302, 52, GFXFF);
 
   // Print Difficulty
   background.setFreeFont(FSS9);
   background.setTextDatum(TR_DATUM);
   background.setTextColor(0x9C92);
-  background.drawString(data.netwrokDifficulty.c_str(), 302, 88, GFXFF);
+  background.drawString(data.netwrokDifficulty, 302, 88, GFXFF);
 
   // Print Global Hashrate
   render.setFontSize(17);
-  render.rdrawString(data.globalHashRate.c_str(), 274, 145, TFT_BLACK);
+  render.rdrawString(data.globalHashRate, 274, 145, TFT_BLACK);
 
   // Print BlockHeight
   render.setFontSize(28);
-  render.rdrawString(data.blockHeight.c_str(), 140, 104, 0xDEDB);
+  render.rdrawString(data.blockHeight, 140, 104, 0xDEDB);
 
   // Draw percentage rectangle
   int x2 = 2 + (138 * data.progressPercent / 100);
@@ -302,7 +307,7 @@ void t_hmiDisplay_GlobalHashScreen(unsigned long mElapsed)
   background.setTextSize(1);
   background.setTextDatum(MC_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.remainingBlocks.c_str(), 72, 159, FONT2);
+  background.drawString(data.remainingBlocks, 72, 159, FONT2);
 
   if (lowerScreen == 1)
     printMemPoolFees(mElapsed);
@@ -319,20 +324,20 @@ void t_hmiDisplay_BTCprice(unsigned long mElapsed)
   clock_data data = getClockData(mElapsed);
 
   // Print background screen
-  background.pushImage(0, 0, priceScreenWidth, 170 /*priceScreenHeight*/, priceScreen);
+  rlePushImage(background, 0, 0, priceScreen_rle);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
   // Hashrate
   render.setFontSize(25);
   render.setCursor(19, 122);
   render.setFontColor(TFT_BLACK);
-  render.rdrawString(data.currentHashRate.c_str(), 94, 129, TFT_BLACK);
+  render.rdrawString(data.currentHashRate, 94, 129, TFT_BLACK);
 
   // Print BlockHeight
   render.setFontSize(18);
-  render.rdrawString(data.blockHeight.c_str(), 254, 138, TFT_WHITE);
+  render.rdrawString(data.blockHeight, 254, 138, TFT_WHITE);
 
   // Print Hour
   
@@ -340,14 +345,14 @@ void t_hmiDisplay_BTCprice(unsigned long mElapsed)
   background.setTextSize(1);
   background.setTextDatum(TL_DATUM);
   background.setTextColor(TFT_BLACK);
-  background.drawString(data.currentTime.c_str(), 222, 3, GFXFF);
+  background.drawString(data.currentTime, 222, 3, GFXFF);
 
   // Print BTC Price 
   background.setFreeFont(FF24);
   background.setTextDatum(TR_DATUM);
   background.setTextSize(1);
   background.setTextColor(0xDEDB, TFT_BLACK);
-  background.drawString(data.btcPrice.c_str(), 300, 58, GFXFF);
+  background.drawString(data.btcPrice, 300, 58, GFXFF);
   if (lowerScreen == 1)
     printPoolData();
   else
@@ -357,18 +362,28 @@ void t_hmiDisplay_BTCprice(unsigned long mElapsed)
 }
 
 
+void t_hmiDisplay_HistoryScreen(unsigned long mElapsed)
+{
+  // Last day, one column per 4.5 minutes
+  background.fillSprite(TFT_BLACK);
+  drawHistoryChart(background, 0, 0, WIDTH, HEIGHT, 24 * 60);
+
+  // Push prepared background to screen
+  background.pushSprite(0, 0);
+}
+
 void t_hmiDisplay_LoadingScreen(void)
 {
   tft.fillScreen(TFT_BLACK);
-  // tft.pushImage(0, 0, initWidth, initHeight, initScreen);
-  tft.pushImage(0, 0, initWidth, initHeight, initScreen);
+  // rlePushImage(tft, 0, 0, initScreen_rle);
+  rlePushImage(tft, 0, 0, initScreen_rle);
   tft.setTextColor(TFT_BLACK);
   tft.drawString(CURRENT_VERSION, 24, 147, FONT2);
   delay(2000);
   tft.fillScreen(TFT_BLACK);
   // tft.pushImage(0, 0, initWidth, initHeight, MinerScreen);
-  tft.pushImage(0, 0, initWidth, 170, MinerScreen);
-  tft.pushImage(0, 170, initWidth, 70, bottonPoolScreen);
+  rlePushImage(tft, 0, 0, MinerScreen_rle);
+  rlePushImage(tft, 0, 170, bottonPoolScreen_rle);
   if (showbtcprice)
   {
     // blackout title
@@ -379,7 +394,7 @@ void t_hmiDisplay_LoadingScreen(void)
 
 void t_hmiDisplay_SetupScreen(void)
 {
-  tft.pushImage(0, 0, setupModeWidth, setupModeHeight, setupModeScreen);
+  rlePushImage(tft, 0, 0, setupModeScreen_rle);
 }
 
 void t_hmiDisplay_AnimateCurrentScreen(unsigned long frame)
@@ -390,7 +405,7 @@ void t_hmiDisplay_DoLedStuff(unsigned long frame)
 {
 }
 
-CyclicScreenFunction t_hmiDisplayCyclicScreens[] = {t_hmiDisplay_MinerScreen, t_hmiDisplay_ClockScreen, t_hmiDisplay_GlobalHashScreen, t_hmiDisplay_BTCprice};
+CyclicScreenFunction t_hmiDisplayCyclicScreens[] = {t_hmiDisplay_MinerScreen, t_hmiDisplay_ClockScreen, t_hmiDisplay_GlobalHashScreen, t_hmiDisplay_BTCprice, t_hmiDisplay_HistoryScreen};
 
 DisplayDriver t_hmiDisplayDriver = {
     t_hmiDisplay_Init,
@@ -401,6 +416,7 @@ DisplayDriver t_hmiDisplayDriver = {
     t_hmiDisplayCyclicScreens,
     t_hmiDisplay_AnimateCurrentScreen,
     t_hmiDisplay_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(t_hmiDisplayCyclicScreens),
     0,
     WIDTH,
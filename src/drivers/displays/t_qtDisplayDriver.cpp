@@ -3,7 +3,7 @@
 #ifdef T_QT_DISPLAY
 
 #include <TFT_eSPI.h>
-#include "media/images_128_128.h"
+#include "media/images_128_128_rle.h"
 #include "media/myFonts.h"
 #include "media/Free_Fonts.h"
 #include "version.h"
@@ -54,20 +54,20 @@ void t_qtDisplay_MinerScreen(unsigned long mElapsed)
   mining_data data = getMiningData(mElapsed);
 
   // Print background screen
-  background.pushImage(0, 0, MinerWidth, MinerHeight, MinerScreen);
+  rlePushImage(background, 0, 0, MinerScreen_rle);
 
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
 
     //Hashrate
     render.setFontSize(32);
     render.setCursor(0, 0);
     render.setFontColor(TFT_BLACK);    
-    render.rdrawString(data.currentHashRate.c_str(), 114, 24, TFT_DARKGREY);
+    render.rdrawString(data.currentHashRate, 114, 24, TFT_DARKGREY);
 
     //Valid Blocks
     render.setFontSize(22);
-    render.drawString(data.valids.c_str(), 15, 92, TFT_BLACK);
+    render.drawString(data.valids, 15, 92, TFT_BLACK);
     
     //Mining Time
     char timeMining[15]; 
@@ -91,21 +91,21 @@ void t_qtDisplay_ClockScreen(unsigned long mElapsed)
     clock_data_t data = getClockData_t(mElapsed);
 
     // Print background screen
-    background.pushImage(0, 0, minerClockWidth, minerClockHeight, minerClockScreen);
+    rlePushImage(background, 0, 0, minerClockScreen_rle);
 
     // Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-    //             data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+    //             data.completedShares, data.totalKHashes, data.currentHashRate);
 
     render.setCursor(0, 0);
 
     //Hashrate
     render.setFontSize(18);
     render.setFontColor(TFT_BLACK);    
-    render.cdrawString(data.currentHashRate.c_str(), 64, 74, TFT_DARKGREY);
+    render.cdrawString(data.currentHashRate, 64, 74, TFT_DARKGREY);
 
     //Valid Blocks
     render.setFontSize(15);
-    render.rdrawString(data.valids.c_str(), 96, 54, TFT_BLACK);
+    render.rdrawString(data.valids, 96, 54, TFT_BLACK);
 
     if (data.currentHours > 12)
         data.currentHours -= 12;
@@ -134,7 +134,7 @@ void t_qtDisplay_ClockScreen(unsigned long mElapsed)
     background.fillCircle(65, 65, 3, TFT_RED);
 
     //Push prepared background to screen
-    background.pushSprite(0,0);      
+    background.pushSprite(0,0);
 }
 
 void t_qtDisplay_GlobalHashScreen(unsigned long mElapsed)
@@ -145,14 +145,14 @@ void t_qtDisplay_GlobalHashScreen(unsigned long mElapsed)
 void t_qtDisplay_LoadingScreen(void)
 {
   tft.fillScreen(TFT_BLACK);
-  tft.pushImage(0, 0, initWidth, initHeight, initScreen);
+  rlePushImage(tft, 0, 0, initScreen_rle);
   tft.setTextColor(TFT_GOLD);
   tft.drawString(CURRENT_VERSION, 2, 100, FONT2); 
 }
 
 void t_qtDisplay_SetupScreen(void)
 {
-  tft.pushImage(0, 0, setupModeWidth, setupModeHeight, setupModeScreen);
+  rlePushImage(tft, 0, 0, setupModeScreen_rle);
 }
 
 void t_qtDisplay_AnimateCurrentScreen(unsigned long frame)
@@ -174,6 +174,7 @@ DisplayDriver t_qtDisplayDriver = {
     t_qtDisplayCyclicScreens,
     t_qtDisplay_AnimateCurrentScreen,
     t_qtDisplay_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(t_qtDisplayCyclicScreens),
     0,
     WIDTH,
@@ -4,8 +4,11 @@
 
 #define LGFX_USE_V1
 
+#include <atomic>
 #include <WiFi.h>
 #include <Wire.h>
+#include <esp_heap_caps.h>
+#include <soc/soc_memory_layout.h>
 #include <SPI.h>
 #include <LovyanGFX.hpp>
 #include <lvgl.h>
@@ -14,6 +17,7 @@
 #include "drivers/storage/storage.h"
 #include "wManager.h"
 #include "ui.h"
+#include "history.h"
 
 extern monitor_data mMonitor;
 extern TSettings Settings;
@@ -195,10 +199,49 @@ LGFX tft;
 /* Change to your screen resolution */
 static const uint32_t screenWidth = 480;
 static const uint32_t screenHeight = 320;
+
+// Draw buffers. The S3 DMA reads PSRAM, so the PLUS gets two whole frames
+// there. The ESP32 SPI DMA only reads internal RAM, it keeps SCR lines.
+#ifdef PLUS
+#define LVGL_BUFFER_LINES screenHeight
+#define LVGL_BUFFER_CAPS  (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define LVGL_BUFFER_LINES SCR
+#define LVGL_BUFFER_CAPS  (MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL)
+#endif
+
+#define LVGL_TASK_PERIOD_ms   5
+#define LVGL_STATS_REFRESHES  100   // Refreshes between two stats reports
+#define HISTORY_POINTS        96    // Stats screen chart, last day in 15 minute points
+
 static lv_disp_draw_buf_t draw_buf;
 static lv_disp_drv_t disp_drv;
-static lv_color_t disp_draw_buf[screenWidth * SCR];
-static lv_color_t disp_draw_buf2[screenWidth * SCR];
+static lv_disp_drv_t *flushing = NULL;   // Flush waiting for its DMA transfer
+
+// Screen data from the monitor task. Only the LVGL task touches LVGL: the
+// monitor fills the back slot and swaps it with the middle one, the LVGL
+// task takes the middle slot when it holds a new update. Neither side waits.
+typedef struct {
+  mining_data data;
+} wt32_update;
+
+#define UPDATE_NEW 0x04
+static wt32_update updates[3];
+static uint8_t backSlot = 0;              // Monitor task
+static uint8_t frontSlot = 1;             // LVGL task
+static std::atomic<uint8_t> middleSlot(2);
+static std::atomic<bool> loadingRequested(false);
+
+typedef struct {
+  uint32_t refreshes;
+  uint64_t refreshMs;
+  uint32_t maxRefreshMs;
+  uint64_t pixels;
+  size_t minInternalFree;
+  uint32_t flushes;             // Flushes of the refresh in progress
+} lvgl_stats;
+
+static lvgl_stats stats = {0, 0, 0, 0, SIZE_MAX, 0};
 
 /* Display flushing */
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
@@ -210,7 +253,50 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
 
   tft.pushImageDMA(area->x1, area->y1, area->x2 - area->x1 + 1, area->y2 - area->y1 + 1, (lgfx::swap565_t *)&color_p->full);
 
-  lv_disp_flush_ready(disp); /* tell lvgl that flushing is done */
+  // Ready once the transfer is over, LVGL draws into the other buffer meanwhile
+  flushing = disp;
+  stats.flushes++;
+}
+
+static void checkFlush(void)
+{
+  if (flushing != NULL && !tft.dmaBusy())
+  {
+    lv_disp_flush_ready(flushing);
+    flushing = NULL;
+  }
+}
+
+/* Called by LVGL while it waits for a buffer still being sent */
+void my_disp_wait(lv_disp_drv_t *disp)
+{
+  checkFlush();
+  if (flushing != NULL) vTaskDelay(1);    // Let the miners run until the DMA is done
+}
+
+void my_disp_monitor(lv_disp_drv_t *disp, uint32_t time, uint32_t px)
+{
+  stats.refreshes++;
+  stats.refreshMs += time;
+  stats.maxRefreshMs = max(stats.maxRefreshMs, time);
+  stats.pixels += px;
+  size_t internalFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  stats.minInternalFree = min(stats.minInternalFree, internalFree);
+
+#ifdef LVGL_PERF
+  // Redraw area of every refresh, to spot widgets invalidating more than they changed
+  Serial.printf("[LVGL] refresh %u ms, %u px (%u%% of the screen) in %u flushes, internal RAM free %u\n",
+                time, px, px * 100 / (screenWidth * screenHeight), stats.flushes, internalFree);
+#endif
+  stats.flushes = 0;
+
+  if (stats.refreshes % LVGL_STATS_REFRESHES == 0)
+  {
+    Serial.printf("[LVGL] avg refresh %llu ms (max %u), avg %llu px, internal RAM free %u (min %u)\n",
+                  stats.refreshMs / stats.refreshes, stats.maxRefreshMs, stats.pixels / stats.refreshes,
+                  internalFree, stats.minInternalFree);
+    stats.maxRefreshMs = 0;
+  }
 }
 
 /*Read the touchpad*/
@@ -242,9 +328,130 @@ void onBrightnessChange(lv_event_t *e)
   tft.setBrightness(brightness);
 }
 
+// lv_label_set_text invalidates the label even when the text is the same,
+// which redraws the sky background and the big fonts behind it for nothing
+static void setLabelText(lv_obj_t *label, const char *text)
+{
+  if (strcmp(lv_label_get_text(label), text) == 0) return;
+  lv_label_set_text(label, text);
+}
+
+static void applyUpdate(const mining_data &data)
+{
+  setLabelText(ui_lblhashrate, data.currentHashRate);
+  lv_bar_set_value(ui_barhashrate, atoi(data.currentHashRate) * 10, LV_ANIM_ON);   // No-op when unchanged
+  setLabelText(ui_lblvalid, data.valids);
+  setLabelText(ui_lbltemplates, data.templates);
+  setLabelText(ui_lbltotalhashrate, data.totalKHashes);
+  setLabelText(ui_lblbestdiff, data.bestDiff);
+  setLabelText(ui_lblshares32, data.completedShares);
+  setLabelText(ui_lblclock, data.timeMining);
+  setLabelText(ui_lbltemperature, data.temp);
+  setLabelText(ui_lblclock2, data.currentTime);
+}
+
+static void applyLoadingScreen(void)
+{
+  setLabelText(ui_lblssid, "SSID HanSoloAP");
+  setLabelText(ui_lblpassword, "Password MineYourCoins");
+  setLabelText(ui_lblversion, "Version 1.6.4 (RC1)");
+  _ui_screen_change(&ui_HomeScreen, LV_SCR_LOAD_ANIM_FADE_ON, 500, 0, &ui_HomeScreen_screen_init);
+}
+
+// The stats screen shows the mining history of the last day
+static lv_obj_t *historyChart = NULL;
+static lv_chart_series_t *historySeries = NULL;
+static lv_obj_t *historyPeak = NULL;
+static uint32_t historyMinute = 0;
+static uint32_t historyPoints[HISTORY_POINTS];
+
+typedef struct {
+  uint32_t from;
+  uint32_t span;                        // Seconds per point
+} history_points;
+
+static bool addHistoryPoint(const history_sample *s, void *arg)
+{
+  const history_points *p = (const history_points *)arg;
+  uint32_t i = (s->time - p->from) / p->span;
+  if (i < HISTORY_POINTS && s->hashrate > historyPoints[i]) historyPoints[i] = s->hashrate;
+  return true;
+}
+
+static void createHistoryChart(void)
+{
+  setLabelText(ui_Label13, "Hashrate 24h");
+  lv_obj_add_flag(ui_Image2, LV_OBJ_FLAG_HIDDEN);
+
+  historyChart = lv_chart_create(ui_StatsScreen);
+  lv_obj_set_size(historyChart, 440, 200);
+  lv_obj_align(historyChart, LV_ALIGN_CENTER, 0, -8);
+  lv_chart_set_type(historyChart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(historyChart, HISTORY_POINTS);
+  lv_chart_set_div_line_count(historyChart, 5, 7);
+  lv_obj_set_style_size(historyChart, 0, LV_PART_INDICATOR);   // No point markers
+  historySeries = lv_chart_add_series(historyChart, lv_color_hex(0x2EFF00), LV_CHART_AXIS_PRIMARY_Y);
+  lv_chart_set_all_value(historyChart, historySeries, LV_CHART_POINT_NONE);
+  lv_chart_set_range(historyChart, LV_CHART_AXIS_PRIMARY_Y, 0, 1000);
+
+  historyPeak = lv_label_create(historyChart);
+  lv_obj_align(historyPeak, LV_ALIGN_TOP_LEFT, 0, 0);
+  lv_label_set_text(historyPeak, "No history yet");
+}
+
+// Once a minute, only the new sample changes the chart
+static void updateHistoryChart(void)
+{
+  uint32_t now = getEpochSeconds();
+  if (now == 0 || now / 60 == historyMinute) return;
+  historyMinute = now / 60;
+
+  history_points p = {now - HISTORY_POINTS * 900, 900};
+  memset(historyPoints, 0, sizeof(historyPoints));
+  historyQuery(p.from, now, addHistoryPoint, &p);
+
+  uint32_t top = 1000;
+  for (uint32_t i = 0; i < HISTORY_POINTS; i++)
+    if (historyPoints[i] > top) top = historyPoints[i];
+
+  // Values in H/s overflow lv_coord_t, the chart works in thousandths of the peak
+  for (uint32_t i = 0; i < HISTORY_POINTS; i++)
+    historySeries->y_points[i] = historyPoints[i] ? (lv_coord_t)((uint64_t)historyPoints[i] * 1000 / top) : LV_CHART_POINT_NONE;
+  lv_chart_refresh(historyChart);
+
+  char peak[32];
+  snprintf(peak, sizeof(peak), "Peak %.2f KH/s", top / 1000.0);
+  setLabelText(historyPeak, peak);
+}
+
+// Owner of LVGL: builds the UI, applies the updates and runs the timers
+void runLvgl(void *name)
+{
+  Serial.printf("[LVGL] started on core %d\n", xPortGetCoreID());
+  ui_init();
+  createHistoryChart();
+
+  while (1)
+  {
+    if (loadingRequested.exchange(false)) applyLoadingScreen();
+    updateHistoryChart();
+
+    if (middleSlot.load() & UPDATE_NEW)
+    {
+      frontSlot = middleSlot.exchange(frontSlot) & 0x03;
+      applyUpdate(updates[frontSlot].data);
+    }
+
+    checkFlush();
+    lv_timer_handler();
+    vTaskDelay(LVGL_TASK_PERIOD_ms / portTICK_PERIOD_MS);
+  }
+}
+
 void wt32Display_Init(void)
 {
   Serial.println("M5stack display driver initialized");
+  size_t internalBefore = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
   tft.init();
   tft.initDMA();
   tft.startWrite();
@@ -259,20 +466,36 @@ void wt32Display_Init(void)
   Serial.print("\tHeight: ");
   Serial.println(screenHeight);
 
-  if (!disp_draw_buf)
+  uint32_t lines = LVGL_BUFFER_LINES;
+  lv_color_t *buf1 = (lv_color_t *)heap_caps_malloc(screenWidth * lines * sizeof(lv_color_t), LVGL_BUFFER_CAPS);
+  lv_color_t *buf2 = (lv_color_t *)heap_caps_malloc(screenWidth * lines * sizeof(lv_color_t), LVGL_BUFFER_CAPS);
+  if (buf1 == NULL || buf2 == NULL)
+  {
+    // No PSRAM left, fall back to small internal buffers
+    free(buf1);
+    free(buf2);
+    lines = SCR;
+    buf1 = (lv_color_t *)heap_caps_malloc(screenWidth * lines * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    buf2 = (lv_color_t *)heap_caps_malloc(screenWidth * lines * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  }
+
+  if (buf1 == NULL || buf2 == NULL)
   {
     Serial.println("LVGL disp_draw_buf allocate failed!");
   }
   else
   {
-    Serial.print("Display buffer size: ");
-    lv_disp_draw_buf_init(&draw_buf, disp_draw_buf, disp_draw_buf2, screenWidth * SCR);
+    Serial.printf("[LVGL] Display buffers 2 x %u lines (%u bytes each) in %s\n", lines,
+                  screenWidth * lines * sizeof(lv_color_t), esp_ptr_external_ram(buf1) ? "PSRAM" : "internal RAM");
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, screenWidth * lines);
     /* Initialize the display */
     lv_disp_drv_init(&disp_drv);
     /* Change the following line to your display resolution */
     disp_drv.hor_res = screenWidth;
     disp_drv.ver_res = screenHeight;
     disp_drv.flush_cb = my_disp_flush;
+    disp_drv.wait_cb = my_disp_wait;
+    disp_drv.monitor_cb = my_disp_monitor;
     disp_drv.draw_buf = &draw_buf;
     lv_disp_drv_register(&disp_drv);
     /* Initialize the input device driver */
@@ -282,9 +505,10 @@ void wt32Display_Init(void)
     indev_drv.read_cb = my_touchpad_read;
     lv_indev_drv_register(&indev_drv);
 
-    ui_init();
-    lv_timer_handler();
-  }  
+    xTaskCreatePinnedToCore(runLvgl, "Lvgl", 8192, NULL, 2, NULL, 1);
+  }
+  Serial.printf("[LVGL] Internal RAM used by the display: %u bytes\n",
+                internalBefore - heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
 }
 
 void wt32Display_AlternateScreenState(void)
@@ -301,19 +525,12 @@ void wt32Display_NoScreen(unsigned long mElapsed)
 
   // Print hashrate to serial
   Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
-  //Serial.printf(">>> Temperature: %s\n", data.temp.c_str());
-
-  lv_label_set_text(ui_lblhashrate, data.currentHashRate.c_str());
-  lv_bar_set_value(ui_barhashrate, data.currentHashRate.toInt() * 10, LV_ANIM_ON);
-  lv_label_set_text(ui_lblvalid, data.valids.c_str());
-  lv_label_set_text(ui_lbltemplates, data.templates.c_str());
-  lv_label_set_text(ui_lbltotalhashrate, data.totalKHashes.c_str());
-  lv_label_set_text(ui_lblbestdiff, data.bestDiff.c_str());
-  lv_label_set_text(ui_lblshares32, data.completedShares.c_str());
-  lv_label_set_text(ui_lblclock, data.timeMining.c_str());
-  lv_label_set_text(ui_lbltemperature, data.temp.c_str());
-  lv_label_set_text(ui_lblclock2, data.currentTime.c_str());
+                data.completedShares, data.totalKHashes, data.currentHashRate);
+  //Serial.printf(">>> Temperature: %s\n", data.temp);
+
+  // Hand the data to the LVGL task
+  updates[backSlot].data = data;
+  backSlot = middleSlot.exchange(backSlot | UPDATE_NEW) & 0x03;
 
   /*
   M5.Lcd.print("Pool: "); M5.Lcd.setTextColor(GREENYELLOW); M5.Lcd.print(Settings.PoolAddress); M5.Lcd.print(":"); M5.Lcd.println(Settings.PoolPort); M5.Lcd.setTextColor(WHITE);
@@ -323,10 +540,7 @@ void wt32Display_NoScreen(unsigned long mElapsed)
 void wt32Display_LoadingScreen(void)
 {
   Serial.println("Initializing...");
-  lv_label_set_text(ui_lblssid, "SSID HanSoloAP");
-  lv_label_set_text(ui_lblpassword, "Password MineYourCoins");
-  lv_label_set_text(ui_lblversion, "Version 1.6.4 (RC1)");
-  _ui_screen_change(&ui_HomeScreen, LV_SCR_LOAD_ANIM_FADE_ON, 500, 0, &ui_HomeScreen_screen_init);
+  loadingRequested = true;
 }
 
 void wt32Display_SetupScreen(void)
@@ -336,8 +550,7 @@ void wt32Display_SetupScreen(void)
 
 void wt32Display_DoLedStuff(unsigned long frame)
 {
-  // we will use led function to update lvgl
-  lv_timer_handler();
+  // LVGL runs in its own task
 }
 
 void wt32Display_AnimateCurrentScreen(unsigned long frame)
@@ -355,6 +568,7 @@ DisplayDriver wt32DisplayDriver = {
     wt32DisplayCyclicScreens,
     wt32Display_AnimateCurrentScreen,
     wt32Display_DoLedStuff,
+    NULL,
     SCREENS_ARRAY_SIZE(wt32DisplayCyclicScreens),
     0,
     0,
@@ -68,6 +68,55 @@ void SDCard::terminate()
 #endif   
 }
 
+/// @brief Unmount and mount the card again, after it was removed or a write failed.
+/// @return true when a card is mounted
+bool SDCard::remount()
+{
+    iSD_->end();
+    cardInitialized_ = false;
+    return initSDcard();
+}
+
+/// @brief Append data to a file in one write, the file is created if needed.
+/// Quiet on failure, the caller retries after remount().
+/// @return true if all bytes were written
+bool SDCard::appendFile(const char* path, const uint8_t* data, size_t len)
+{
+    if (!cardInitialized_ || cardBusy_ || iSD_->cardType() == CARD_NONE) return false;
+    cardBusy_ = true;
+    File file = iSD_->open(path, FILE_APPEND);
+    size_t written = file ? file.write(data, len) : 0;
+    if (file) file.close();
+    cardBusy_ = false;
+    return written == len;
+}
+
+/// @return size of the file in bytes, 0 if it doesn't exist
+size_t SDCard::fileSize(const char* path)
+{
+    if (!cardInitialized_ || cardBusy_ || !iSD_->exists(path)) return 0;
+    cardBusy_ = true;
+    File file = iSD_->open(path, FILE_READ);
+    size_t size = file ? file.size() : 0;
+    if (file) file.close();
+    cardBusy_ = false;
+    return size;
+}
+
+/// @brief Rename a file, an existing target is replaced.
+bool SDCard::renameFile(const char* from, const char* to)
+{
+    if (!cardInitialized_ || cardBusy_ || !iSD_->exists(from)) return false;
+    if (iSD_->exists(to)) iSD_->remove(to);
+    return iSD_->rename(from, to);
+}
+
+bool SDCard::removeFile(const char* path)
+{
+    if (!cardInitialized_ || cardBusy_ || !iSD_->exists(path)) return false;
+    return iSD_->remove(path);
+}
+
 /// @brief Transfer settings from config file on a SD card to the device.
 /// @param nvMemory* where to save
 /// @param TSettings* passing a struct is required, to save memory
@@ -227,4 +276,9 @@ bool SDCard::initSDcard() { return false; }
 bool SDCard::cardAvailable() { return false; }
 bool SDCard::cardBusy() { return false; }
 void SDCard::terminate() {}
+bool SDCard::remount() { return false; }
+bool SDCard::appendFile(const char* path, const uint8_t* data, size_t len) { return false; }
+size_t SDCard::fileSize(const char* path) { return 0; }
+bool SDCard::renameFile(const char* from, const char* to) { return false; }
+bool SDCard::removeFile(const char* path) { return false; }
 #endif //BUILD_SDMMC
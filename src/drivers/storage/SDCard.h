@@ -59,6 +59,11 @@ public:
     bool cardAvailable();
     bool cardBusy();
     void terminate(); 
+    bool remount();
+    bool appendFile(const char* path, const uint8_t* data, size_t len);
+    size_t fileSize(const char* path);
+    bool renameFile(const char* from, const char* to);
+    bool removeFile(const char* path);
 #ifdef SDMMC_1BIT_FIX
     bool initSDcard();
 private:
@@ -0,0 +1,212 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <esp_rom_crc.h>
+#include <nvs.h>
+#include "fastBoot.h"
+#include "drivers/storage/nvMemory.h"
+#include "drivers/storage/storage.h"
+
+#define RECORD_KEY "fastboot"
+
+extern nvMemory nvMem;
+extern TSettings Settings;
+
+static const char *stageNames[BOOT_STAGES] = {"setup", "wifi begin", "splash", "wifi", "tasks", "pool", "subscribed", "job", "hash"};
+
+static boot_timeline timeline;
+static portMUX_TYPE bootMux = portMUX_INITIALIZER_UNLOCKED;
+
+static fast_boot_record cache;
+static bool cacheValid = false;
+static bool started = false;
+static bool crashReset = false;
+
+static uint32_t recordCrc(const fast_boot_record *r)
+{
+  return esp_rom_crc32_le(0, (const uint8_t *)r, offsetof(fast_boot_record, crc));
+}
+
+static uint32_t wifiCrc(void)
+{
+  uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)Settings.WifiSSID.c_str(), Settings.WifiSSID.length());
+  return esp_rom_crc32_le(crc, (const uint8_t *)Settings.WifiPW.c_str(), Settings.WifiPW.length());
+}
+
+static uint32_t poolCrc(void)
+{
+  uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)Settings.PoolAddress.c_str(), Settings.PoolAddress.length());
+  return esp_rom_crc32_le(crc, (const uint8_t *)&Settings.PoolPort, sizeof(Settings.PoolPort));
+}
+
+static bool readRecord(fast_boot_record *r)
+{
+  nvs_handle_t handle;
+  if (nvs_open("state", NVS_READONLY, &handle) != ESP_OK) return false;
+  size_t size = sizeof(fast_boot_record);
+  esp_err_t err = nvs_get_blob(handle, RECORD_KEY, r, &size);
+  nvs_close(handle);
+  return err == ESP_OK && size == sizeof(fast_boot_record) && r->version == FASTBOOT_RECORD_VERSION &&
+         r->size == sizeof(fast_boot_record) && r->crc == recordCrc(r);
+}
+
+static void writeRecord(fast_boot_record *r)
+{
+  r->version = FASTBOOT_RECORD_VERSION;
+  r->size = sizeof(fast_boot_record);
+  r->crc = recordCrc(r);
+
+  nvs_handle_t handle;
+  if (nvs_open("state", NVS_READWRITE, &handle) != ESP_OK) return;
+  esp_err_t err = nvs_set_blob(handle, RECORD_KEY, r, sizeof(fast_boot_record));
+  if (err == ESP_OK) err = nvs_commit(handle);
+  nvs_close(handle);
+  if (err != ESP_OK) Serial.printf("[BOOT] Saving the fast boot record failed (%s)\n", esp_err_to_name(err));
+}
+
+// Runs in the WiFi event task
+static void onGotIp(arduino_event_id_t event)
+{
+  bootMark(BOOT_WIFI_CONNECTED);
+}
+
+void fastBootBegin(void)
+{
+  esp_reset_reason_t reason = esp_reset_reason();
+  timeline.resetReason = reason;
+  crashReset = reason == ESP_RST_BROWNOUT || reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+               reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT || reason == ESP_RST_SW;
+
+  WiFi.onEvent(onGotIp, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+
+  nvMem.loadConfig(&Settings);
+  bool hasCredentials = Settings.WifiSSID.length() > 0 && Settings.WifiSSID != String(DEFAULT_SSID) &&
+                        Settings.WifiPW.length() > 0 && Settings.WifiPW != String(DEFAULT_WIFIPW);
+  if (!hasCredentials) return;
+
+  memset(&cache, 0, sizeof(cache));
+  cacheValid = readRecord(&cache) && cache.wifiCrc == wifiCrc() && cache.channel != 0;
+
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(true);
+  if (cacheValid) {
+    WiFi.begin(Settings.WifiSSID.c_str(), Settings.WifiPW.c_str(), cache.channel, cache.bssid, true);
+    timeline.wifiCached = true;
+  } else {
+    WiFi.begin(Settings.WifiSSID.c_str(), Settings.WifiPW.c_str());
+  }
+  started = true;
+  bootMark(BOOT_WIFI_BEGIN);
+
+  Serial.printf("[BOOT] WiFi started before the splash (%s), reset reason %d\n",
+                cacheValid ? "cached channel and BSSID" : "no cache", reason);
+}
+
+/// @brief Shows the splash for ms, only FASTBOOT_SPLASH_MIN_ms after a crash reset once WiFi is up
+void fastBootSplash(uint32_t ms)
+{
+  uint32_t start = millis();
+  uint32_t minimum = (started && crashReset) ? FASTBOOT_SPLASH_MIN_ms : ms;
+  while (millis() - start < ms) {
+    if (millis() - start >= minimum && WiFi.status() == WL_CONNECTED) break;
+    delay(20);
+  }
+  bootMark(BOOT_SPLASH_DONE);
+}
+
+bool fastBootStarted(void)
+{
+  return started;
+}
+
+bool fastBootCached(void)
+{
+  return cacheValid;
+}
+
+/// @brief Waits for the connection started by fastBootBegin(). A failing cache is forgotten.
+bool fastBootWait(void)
+{
+  uint32_t timeout = cacheValid ? FASTBOOT_CONNECT_ms : FASTBOOT_WIFI_ms;
+  uint32_t start = timeline.stageMs[BOOT_WIFI_BEGIN];
+  while (WiFi.status() != WL_CONNECTED) {
+    if (esp_timer_get_time() / 1000 - start > timeout) {
+      if (cacheValid) {
+        Serial.printf("[BOOT] Cached WiFi connection failed, forgetting it\n");
+        memset(&cache, 0, sizeof(cache));
+        writeRecord(&cache);
+        cacheValid = false;
+        timeline.wifiCached = false;
+      }
+      return false;
+    }
+    delay(20);
+  }
+  fastBootSaveWifi();
+  return true;
+}
+
+/// @brief Saves the access point in use when it differs from the cache
+void fastBootSaveWifi(void)
+{
+  if (WiFi.status() != WL_CONNECTED) return;
+
+  fast_boot_record r = cache;
+  r.wifiCrc = wifiCrc();
+  memcpy(r.bssid, WiFi.BSSID(), sizeof(r.bssid));
+  r.channel = WiFi.channel();
+  r.version = FASTBOOT_RECORD_VERSION;
+  r.size = sizeof(fast_boot_record);
+  r.crc = recordCrc(&r);
+  if (cacheValid && r.crc == cache.crc) return;
+
+  writeRecord(&r);
+  cache = r;
+  cacheValid = true;
+  Serial.printf("[BOOT] Saved WiFi channel %u and BSSID %s for the next boot\n", r.channel, WiFi.BSSIDstr().c_str());
+}
+
+bool fastBootPoolIp(IPAddress &ip)
+{
+  if (!cacheValid || cache.poolIp == 0 || cache.poolCrc != poolCrc()) return false;
+  ip = IPAddress(cache.poolIp);
+  timeline.poolCached = true;
+  return true;
+}
+
+void fastBootSavePool(const IPAddress &ip)
+{
+  if (!cacheValid) return;   // Saved with the WiFi entry
+  uint32_t crc = poolCrc();
+  if (cache.poolCrc == crc && cache.poolIp == (uint32_t)ip) return;
+  cache.poolCrc = crc;
+  cache.poolIp = ip;
+  writeRecord(&cache);
+}
+
+void bootMark(boot_stage stage)
+{
+  uint32_t now = esp_timer_get_time() / 1000;
+  portENTER_CRITICAL(&bootMux);
+  bool first = timeline.stageMs[stage] == 0;
+  if (first) timeline.stageMs[stage] = now ? now : 1;
+  portEXIT_CRITICAL(&bootMux);
+
+  if (!first || stage != BOOT_FIRST_HASH) return;
+
+  boot_timeline t = getBootTimeline();
+  String stages;
+  for (int i = 0; i < BOOT_STAGES; i++)
+    if (t.stageMs[i]) stages += String(i ? ", " : "") + stageNames[i] + " " + String(t.stageMs[i]);
+  Serial.printf("[BOOT] First hash %u ms after app start (%s WiFi, %s pool IP), reset reason %d: %s ms\n",
+                t.stageMs[BOOT_FIRST_HASH], t.wifiCached ? "cached" : "scanned",
+                t.poolCached ? "cached" : "resolved", t.resetReason, stages.c_str());
+}
+
+boot_timeline getBootTimeline(void)
+{
+  portENTER_CRITICAL(&bootMux);
+  boot_timeline copy = timeline;
+  portEXIT_CRITICAL(&bootMux);
+  return copy;
+}
@@ -0,0 +1,69 @@
+#ifndef FASTBOOT_H
+#define FASTBOOT_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Fast boot
+// The BSSID and channel of the last WiFi connection and the IP of the pool
+// are kept in NVS (written only when they change). At boot WiFi is started
+// before the display, straight to the cached access point without a scan, so
+// it connects while the splash is shown. The address always comes from DHCP,
+// a pinned address would never be renewed and could be handed to another
+// device once its lease runs out. After a crash, watchdog or brownout reset
+// the splash is cut short once connected. A cached connection that fails
+// within FASTBOOT_CONNECT_ms is forgotten and the normal connection runs. The
+// stratum task connects to the cached pool IP, DNS is only asked when that fails.
+// The boot is timed from app start (esp_timer, the ~0.3 s of ROM and second
+// stage bootloader come before) to the first nonce hashed.
+
+#define FASTBOOT_RECORD_VERSION   2
+#define FASTBOOT_CONNECT_ms       3000      // Cached connection gets this long
+#define FASTBOOT_WIFI_ms          15000     // Uncached connection, as connectToSavedNetwork
+#define FASTBOOT_SPLASH_MIN_ms    500       // Splash after a crash reset, once connected
+
+typedef enum {
+  BOOT_SETUP,                     // setup() entered
+  BOOT_WIFI_BEGIN,
+  BOOT_SPLASH_DONE,
+  BOOT_WIFI_CONNECTED,            // Got an IP
+  BOOT_TASKS_STARTED,             // setup() done
+  BOOT_POOL_CONNECTED,
+  BOOT_SUBSCRIBED,
+  BOOT_FIRST_JOB,
+  BOOT_FIRST_HASH,
+  BOOT_STAGES
+} boot_stage;
+
+typedef struct __attribute__((packed)) {
+  uint16_t version;
+  uint16_t size;                  // sizeof(fast_boot_record)
+  uint32_t wifiCrc;               // SSID and password the entry belongs to
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t poolCrc;               // Pool address and port poolIp belongs to
+  uint32_t poolIp;                // 0 if unknown
+  uint32_t crc;                   // CRC32 of the fields above
+} fast_boot_record;
+
+typedef struct {
+  uint32_t stageMs[BOOT_STAGES];  // Since app start, 0 if not reached yet
+  bool wifiCached;                // Connected straight to the cached BSSID
+  bool poolCached;                // Without DNS
+  int resetReason;                // esp_reset_reason_t
+} boot_timeline;
+
+void fastBootBegin(void);                   // setup(), before the display
+void fastBootSplash(uint32_t ms);           // Instead of the splash delay
+bool fastBootStarted(void);                 // WiFi already started with the saved settings
+bool fastBootCached(void);
+bool fastBootWait(void);                    // wifiManager.init(), true once connected
+void fastBootSaveWifi(void);                // After each connection
+bool fastBootPoolIp(IPAddress &ip);
+void fastBootSavePool(const IPAddress &ip);
+
+void bootMark(boot_stage stage);            // First time only
+boot_timeline getBootTimeline(void);
+
+#endif // FASTBOOT_H
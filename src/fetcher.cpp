@@ -0,0 +1,544 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ArduinoJson.h>
+#include <WiFiClientSecure.h>
+#include "HTTPClient.h"
+#include "fetcher.h"
+#include "monitor.h"
+#include "utils.h"
+#include "drivers/storage/storage.h"
+
+extern TSettings Settings;
+
+typedef struct {
+  bool valid;
+  unsigned long lastSuccess;
+  unsigned long nextAttempt;
+  unsigned long lastWanted;
+  uint16_t failures;
+  int lastError;
+  uint32_t notModified;
+  uint32_t peakHeap;
+  char etag[64];                // Validators of the last 200 response
+  char lastModified[32];
+} source_state;
+
+typedef bool (*FetchFunction)(fetch_cache &work, source_state &s, int &error);
+
+typedef struct {
+  const char *name;
+  unsigned long period_s;
+  FetchFunction fetch;
+} fetch_source;
+
+static bool fetchPrice(fetch_cache &work, source_state &s, int &error);
+static bool fetchHeight(fetch_cache &work, source_state &s, int &error);
+static bool fetchGlobal(fetch_cache &work, source_state &s, int &error);
+static bool fetchFees(fetch_cache &work, source_state &s, int &error);
+static bool fetchPool(fetch_cache &work, source_state &s, int &error);
+
+static const fetch_source sources[FETCH_SOURCES] = {
+  {"price",  UPDATE_BTC_min * 60,    fetchPrice},
+  {"height", UPDATE_Height_min * 60, fetchHeight},
+  {"global", UPDATE_Global_min * 60, fetchGlobal},
+  {"fees",   UPDATE_Global_min * 60, fetchFees},
+  {"pool",   UPDATE_POOL_min * 60,   fetchPool},
+};
+
+static SemaphoreHandle_t cacheLock = NULL;
+static fetch_cache cache = {0, 793261, "", "", 0, 0, 0, 0, 0, 0, "0", "0"};
+static source_state state[FETCH_SOURCES];
+
+typedef struct {
+  char host[64];                // host[:port], empty when the slot is free
+  WiFiClientSecure *client;
+  HTTPClient *http;             // Kept with its client, destroying it closes the socket
+  unsigned long lastUsed;
+} pooled_connection;
+
+static pooled_connection connections[FETCH_MAX_CONNECTIONS];
+static HTTPClient plainHttp;
+static fetch_pool_stats poolStats = {0, 0, 0, 0, 0, 0, 0, 0};
+static uint32_t fetchMinHeap = 0;
+static unsigned long hourStart = 0;
+
+static void hostFromUrl(const String &url, char *host, size_t size)
+{
+  int start = url.indexOf("://");
+  start = (start < 0) ? 0 : start + 3;
+  int end = url.indexOf('/', start);
+  if (end < 0) end = url.length();
+  strlcpy(host, url.substring(start, end).c_str(), size);
+}
+
+static void closeConnection(pooled_connection &c)
+{
+  if (c.http != NULL) delete c.http;
+  c.http = NULL;
+  if (c.client != NULL) {
+    c.client->stop();
+    delete c.client;
+  }
+  c.client = NULL;
+  c.host[0] = 0;
+}
+
+// Kept-alive TLS connection to the host of url, the least recently used one
+// is dropped when every slot is taken
+static pooled_connection *getConnection(const String &url)
+{
+  char host[64];
+  hostFromUrl(url, host, sizeof(host));
+
+  pooled_connection *slot = NULL;
+  for (int i = 0; i < FETCH_MAX_CONNECTIONS; i++) {
+    if (strcmp(connections[i].host, host) == 0) return &connections[i];
+    if (slot == NULL || connections[i].host[0] == 0 ||
+        (slot->host[0] != 0 && connections[i].lastUsed < slot->lastUsed))
+      slot = &connections[i];
+  }
+
+  closeConnection(*slot);
+  slot->client = new WiFiClientSecure;
+  slot->client->setInsecure();
+  slot->client->setHandshakeTimeout(FETCH_TIMEOUT_ms / 1000);
+  slot->http = new HTTPClient;
+  strlcpy(slot->host, host, sizeof(slot->host));
+  return slot;
+}
+
+// Idle sockets still hold a TLS context (~40KB), let them go
+static void closeIdleConnections(void)
+{
+  unsigned long now = millis();
+  for (int i = 0; i < FETCH_MAX_CONNECTIONS; i++)
+    if (connections[i].host[0] && now - connections[i].lastUsed > FETCH_KEEPALIVE_s * 1000UL)
+      closeConnection(connections[i]);
+}
+
+static void sampleHeap(void)
+{
+  fetchMinHeap = min(fetchMinHeap, ESP.getFreeHeap());
+}
+
+static void beginConditional(HTTPClient *http, const source_state &s)
+{
+  static const char *headerKeys[] = {"ETag", "Last-Modified", "Transfer-Encoding"};
+  http->collectHeaders(headerKeys, 3);
+  if (s.etag[0]) http->addHeader("If-None-Match", s.etag);
+  if (s.lastModified[0]) http->addHeader("If-Modified-Since", s.lastModified);
+}
+
+static void saveValidators(HTTPClient *http, source_state &s)
+{
+  strlcpy(s.etag, http->header("ETag").c_str(), sizeof(s.etag));
+  strlcpy(s.lastModified, http->header("Last-Modified").c_str(), sizeof(s.lastModified));
+}
+
+// Sends a conditional GET and returns the client holding the response, call
+// end() on it once the body is read so the connection can serve the next request
+static HTTPClient *httpGet(const String &url, source_state &s, int &httpCode)
+{
+  HTTPClient *http = &plainHttp;
+
+  // Plain http (local pools) does not go through the pool
+  if (!url.startsWith("https://")) {
+    plainHttp.setConnectTimeout(FETCH_CONNECT_TIMEOUT_ms);
+    plainHttp.setTimeout(FETCH_TIMEOUT_ms);
+    plainHttp.setReuse(false);
+    plainHttp.begin(url);
+    beginConditional(http, s);
+    httpCode = plainHttp.GET();
+  } else {
+    pooled_connection *c = getConnection(url);
+    http = c->http;
+    for (int attempt = 0; attempt < 2; attempt++) {
+      bool reused = c->client->connected();
+      if (reused) poolStats.reused++;
+      else poolStats.handshakes++;
+
+      http->setConnectTimeout(FETCH_CONNECT_TIMEOUT_ms);
+      http->setTimeout(FETCH_TIMEOUT_ms);
+      http->setReuse(true);
+      http->begin(*c->client, url);
+      beginConditional(http, s);
+      httpCode = http->GET();
+      sampleHeap();
+
+      // The server may have dropped a kept-alive socket, retry once on a new one
+      if (httpCode > 0 || !reused) break;
+      http->end();
+      c->client->stop();
+    }
+    c->lastUsed = millis();
+  }
+
+  if (httpCode == HTTP_CODE_OK) saveValidators(http, s);
+  return http;
+}
+
+// Response body as a Stream for ArduinoJson. Undoes chunked transfer encoding
+// and stops at the end of the body so a kept-alive connection stays in sync.
+class BodyStream : public Stream {
+public:
+  BodyStream(HTTPClient *http) : _stream(http->getStream())
+  {
+    _chunked = http->header("Transfer-Encoding").equalsIgnoreCase("chunked");
+    _left = _chunked ? 0 : http->getSize();
+    _done = !_chunked && _left == 0;
+    _stream.setTimeout(FETCH_TIMEOUT_ms);
+    setTimeout(0);  // The socket already waits, don't spin on the end of the body
+  }
+
+  int available()
+  {
+    if (!fill()) return 0;
+    int n = _stream.available();
+    return (_left > 0 && n > _left) ? _left : n;
+  }
+
+  int read()
+  {
+    if (!fill()) return -1;
+    uint8_t c;
+    if (_stream.readBytes(&c, 1) != 1) {
+      _done = true;
+      return -1;
+    }
+    if (_left > 0) _left--;
+    poolStats.bytes++;
+    return c;
+  }
+
+  int peek()
+  {
+    return fill() ? _stream.peek() : -1;
+  }
+
+  size_t write(uint8_t c)
+  {
+    return 0;
+  }
+
+  // Skip what the parser did not need, up to the end of the body
+  void drain()
+  {
+    if (_left < 0) return;  // No length, the server closes the connection
+    while (read() >= 0);
+  }
+
+private:
+  bool fill()
+  {
+    if (_done) return false;
+    if (!_chunked) {
+      if (_left == 0) _done = true;
+      return !_done;
+    }
+    if (_left > 0) return true;
+
+    // Chunk size line, after the CRLF that ends the previous chunk
+    String line;
+    for (int i = 0; i < 2 && line.length() == 0; i++) {
+      line = _stream.readStringUntil('\n');
+      line.trim();
+    }
+    _left = strtol(line.c_str(), NULL, 16);
+    if (_left <= 0) {
+      // Last chunk, skip the optional trailer up to the empty line
+      while (_stream.readStringUntil('\n').length() > 1);
+      _done = true;
+    }
+    return !_done;
+  }
+
+  Stream &_stream;
+  bool _chunked;
+  bool _done;
+  int _left;
+};
+
+static bool fetchPrice(fetch_cache &work, source_state &s, int &error)
+{
+  int httpCode;
+  HTTPClient *http = httpGet(getBTCAPI, s, httpCode);
+
+  if (httpCode == HTTP_CODE_OK) {
+    StaticJsonDocument<32> filter;
+    filter["last_trade_price"] = true;
+
+    BodyStream body(http);
+    StaticJsonDocument<64> doc;
+    deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    body.drain();
+    if (doc.containsKey("last_trade_price")) work.btcPrice = doc["last_trade_price"];
+  }
+  http->end();
+
+  error = httpCode;
+  return httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_NOT_MODIFIED;
+}
+
+static bool fetchHeight(fetch_cache &work, source_state &s, int &error)
+{
+  int httpCode;
+  HTTPClient *http = httpGet(getHeightAPI, s, httpCode);
+
+  if (httpCode == HTTP_CODE_OK) {
+    char text[16] = {0};
+    BodyStream body(http);
+    body.readBytes(text, sizeof(text) - 1);
+    body.drain();
+    work.blockHeight = strtoul(text, NULL, 10);
+  }
+  http->end();
+
+  error = httpCode;
+  return httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_NOT_MODIFIED;
+}
+
+static bool fetchGlobal(fetch_cache &work, source_state &s, int &error)
+{
+  int httpCode;
+  HTTPClient *http = httpGet(getGlobalHash, s, httpCode);
+
+  if (httpCode == HTTP_CODE_OK) {
+    // The 3 day hashrate history is skipped while it streams by
+    StaticJsonDocument<64> filter;
+    filter["currentHashrate"] = true;
+    filter["currentDifficulty"] = true;
+
+    BodyStream body(http);
+    StaticJsonDocument<96> doc;
+    deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    body.drain();
+    sampleHeap();
+
+    String temp = "";
+    if (doc.containsKey("currentHashrate")) temp = String(doc["currentHashrate"].as<float>());
+    if(temp.length()>18 + 3) //Exahashes more than 18 digits + 3 digits decimals
+      strlcpy(work.globalHash, temp.substring(0,temp.length()-18 - 3).c_str(), sizeof(work.globalHash));
+    if (doc.containsKey("currentDifficulty")) temp = String(doc["currentDifficulty"].as<float>());
+    if(temp.length()>10 + 3){ //Terahash more than 10 digits + 3 digit decimals
+      temp = temp.substring(0,temp.length()-10 - 3);
+      temp = temp.substring(0,temp.length()-2) + "." + temp.substring(temp.length()-2,temp.length()) + "T";
+      strlcpy(work.difficulty, temp.c_str(), sizeof(work.difficulty));
+    }
+  }
+  http->end();
+
+  error = httpCode;
+  return httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_NOT_MODIFIED;
+}
+
+static bool fetchFees(fetch_cache &work, source_state &s, int &error)
+{
+  int httpCode;
+  HTTPClient *http = httpGet(getFees, s, httpCode);
+
+  if (httpCode == HTTP_CODE_OK) {
+    StaticJsonDocument<128> filter;
+    filter["halfHourFee"] = true;
+    filter["fastestFee"] = true;
+    filter["hourFee"] = true;
+    filter["economyFee"] = true;
+    filter["minimumFee"] = true;
+
+    BodyStream body(http);
+    StaticJsonDocument<128> doc;
+    deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    body.drain();
+    if (doc.containsKey("halfHourFee")) work.halfHourFee = doc["halfHourFee"].as<int>();
+    if (doc.containsKey("fastestFee"))  work.fastestFee = doc["fastestFee"].as<int>();
+    if (doc.containsKey("hourFee"))     work.hourFee = doc["hourFee"].as<int>();
+    if (doc.containsKey("economyFee"))  work.economyFee = doc["economyFee"].as<int>();
+    if (doc.containsKey("minimumFee"))  work.minimumFee = doc["minimumFee"].as<int>();
+  }
+  http->end();
+
+  error = httpCode;
+  return httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_NOT_MODIFIED;
+}
+
+static bool fetchPool(fetch_cache &work, source_state &s, int &error)
+{
+  pool_settings pool = getPoolSettings();
+  String btcWallet = pool.wallet;
+  if (btcWallet.indexOf(".")>0) btcWallet = btcWallet.substring(0,btcWallet.indexOf("."));
+
+  int httpCode;
+#ifdef NERDMINER_T_HMI
+  String poolAPIUrl = getPoolAPIUrl(pool);
+  Serial.println("Pool API : " + poolAPIUrl+btcWallet);
+  HTTPClient *http = httpGet(poolAPIUrl+btcWallet, s, httpCode);
+#else
+  HTTPClient *http = httpGet(String(getPublicPool)+btcWallet, s, httpCode);
+#endif
+
+  if (httpCode == HTTP_CODE_OK) {
+    StaticJsonDocument<300> filter;
+    filter["bestDifficulty"] = true;
+    filter["workersCount"] = true;
+    filter["workers"][0]["sessionId"] = true;
+    filter["workers"][0]["hashRate"] = true;
+
+    BodyStream body(http);
+    DynamicJsonDocument doc(2048);
+    deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    body.drain();
+    sampleHeap();
+
+    if (doc.containsKey("workersCount")) work.workersCount = doc["workersCount"].as<int>();
+    const JsonArray& workers = doc["workers"].as<JsonArray>();
+    float totalhashs = 0;
+    for (const JsonObject& worker : workers) {
+      totalhashs += worker["hashRate"].as<double>();
+    }
+    suffix_string(totalhashs, work.workersHash, sizeof(work.workersHash), 0);
+
+    if (doc.containsKey("bestDifficulty"))
+      suffix_string(doc["bestDifficulty"].as<double>(), work.bestDifficulty, sizeof(work.bestDifficulty), 0);
+    Serial.println("\n####### Pool Data OK!");
+  } else if (httpCode != HTTP_CODE_NOT_MODIFIED) {
+    Serial.println("\n####### Pool Data HTTP Error!");
+    strcpy(work.bestDifficulty, "P");
+    strcpy(work.workersHash, "E");
+    work.workersCount = 0;
+  }
+  http->end();
+
+  error = httpCode;
+  return httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_NOT_MODIFIED;
+}
+
+static bool isWanted(const source_state &s, unsigned long now)
+{
+  return s.lastWanted != 0 && (now - s.lastWanted) < FETCH_IDLE_s * 1000UL;
+}
+
+void runFetcher(void *name)
+{
+  Serial.printf("\n[FETCH] Started. Running %s on core %d\n", (char *)name, xPortGetCoreID());
+
+  if (cacheLock == NULL) cacheLock = xSemaphoreCreateMutex();
+  poolStats.minFreeHeap = ESP.getFreeHeap();
+
+  while (true) {
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+
+    if (millis() - hourStart >= 3600000UL) {
+      poolStats.lastHourHandshakes = poolStats.handshakes - poolStats.hourHandshakes;
+      poolStats.hourHandshakes = poolStats.handshakes;
+      poolStats.lastHourBytes = poolStats.bytes - poolStats.hourBytes;
+      poolStats.hourBytes = poolStats.bytes;
+      hourStart = millis();
+      Serial.printf("[FETCH] last hour: %u TLS handshakes, %u body bytes. %u requests reused a connection, min free heap %u\n",
+                    poolStats.lastHourHandshakes, poolStats.lastHourBytes, poolStats.reused, poolStats.minFreeHeap);
+    }
+
+    closeIdleConnections();
+    if (WiFi.status() != WL_CONNECTED) continue;
+    updateTime();
+
+    for (int i = 0; i < FETCH_SOURCES; i++) {
+      unsigned long now = millis();
+      source_state &s = state[i];
+      if (!isWanted(s, now)) continue;
+      if (s.nextAttempt != 0 && (long)(now - s.nextAttempt) < 0) continue;
+
+      xSemaphoreTake(cacheLock, portMAX_DELAY);
+      fetch_cache work = cache;
+      xSemaphoreGive(cacheLock);
+
+      int error = 0;
+      unsigned long start = millis();
+      uint32_t heapBefore = ESP.getFreeHeap();
+      fetchMinHeap = heapBefore;
+      bool ok = sources[i].fetch(work, s, error);
+      sampleHeap();
+      unsigned long took = millis() - start;
+
+      xSemaphoreTake(cacheLock, portMAX_DELAY);
+      cache = work;
+      s.peakHeap = max(s.peakHeap, heapBefore - fetchMinHeap);
+      poolStats.minFreeHeap = min(poolStats.minFreeHeap, fetchMinHeap);
+      if (error == HTTP_CODE_NOT_MODIFIED) s.notModified++;
+      if (ok) {
+        s.valid = true;
+        s.failures = 0;
+        s.lastSuccess = millis();
+        s.nextAttempt = s.lastSuccess + sources[i].period_s * 1000UL;
+      } else {
+        // Exponential backoff
+        s.failures++;
+        s.lastError = error;
+        unsigned long backoff = FETCH_BACKOFF_MIN_s << min((int)s.failures - 1, 6);
+        backoff = min(backoff, (unsigned long)FETCH_BACKOFF_MAX_s);
+        s.nextAttempt = millis() + backoff * 1000UL;
+      }
+      xSemaphoreGive(cacheLock);
+
+      Serial.printf("[FETCH] %s %s in %lu ms (code %d)\n", sources[i].name, ok ? "updated" : "failed", took, error);
+    }
+  }
+}
+
+fetch_cache getFetchCache(uint32_t sourcesMask)
+{
+  if (cacheLock == NULL) cacheLock = xSemaphoreCreateMutex();
+
+  xSemaphoreTake(cacheLock, portMAX_DELAY);
+  unsigned long now = millis();
+  for (int i = 0; i < FETCH_SOURCES; i++)
+    if (sourcesMask & FETCH_MASK(i)) state[i].lastWanted = now ? now : 1;
+  fetch_cache copy = cache;
+  xSemaphoreGive(cacheLock);
+  return copy;
+}
+
+fetch_status getFetchStatus(FetchSource source)
+{
+  fetch_status status = {false, 0, 0, 0, 0, 0};
+  if (cacheLock == NULL) return status;
+
+  xSemaphoreTake(cacheLock, portMAX_DELAY);
+  const source_state &s = state[source];
+  status.valid = s.valid;
+  status.age = s.valid ? (millis() - s.lastSuccess) / 1000 : 0;
+  status.failures = s.failures;
+  status.lastError = s.lastError;
+  status.notModified = s.notModified;
+  status.peakHeap = s.peakHeap;
+  xSemaphoreGive(cacheLock);
+  return status;
+}
+
+fetch_pool_stats getFetchPoolStats(void)
+{
+  return poolStats;
+}
+
+String getFetchJson(void)
+{
+  String json = "{";
+  json += "\"handshakes\":" + String(poolStats.handshakes) + ",";
+  json += "\"handshakesLastHour\":" + String(poolStats.lastHourHandshakes) + ",";
+  json += "\"reused\":" + String(poolStats.reused) + ",";
+  json += "\"bytes\":" + String(poolStats.bytes) + ",";
+  json += "\"bytesLastHour\":" + String(poolStats.lastHourBytes) + ",";
+  json += "\"minFreeHeap\":" + String(poolStats.minFreeHeap) + ",";
+  for (int i = 0; i < FETCH_SOURCES; i++) {
+    fetch_status st = getFetchStatus((FetchSource)i);
+    json += "\"" + String(sources[i].name) + "\":{";
+    json += "\"valid\":" + String(st.valid ? "true" : "false") + ",";
+    json += "\"age\":" + String(st.age) + ",";
+    json += "\"failures\":" + String(st.failures) + ",";
+    json += "\"lastError\":" + String(st.lastError) + ",";
+    json += "\"notModified\":" + String(st.notModified) + ",";
+    json += "\"peakHeap\":" + String(st.peakHeap);
+    json += "}";
+    if (i < FETCH_SOURCES - 1) json += ",";
+  }
+  json += "}";
+  return json;
+}
@@ -0,0 +1,78 @@
+#ifndef FETCHER_H
+#define FETCHER_H
+
+#include <Arduino.h>
+
+// API fetcher
+// The HTTPS calls to mempool.space, blockchain.com and the pool API run in
+// their own low priority task. Results go into a cache that the screens read
+// without blocking, each source has its own refresh period, timeout and
+// exponential backoff on errors. A source is only refreshed while some
+// screen keeps asking for it.
+// Requests to the same host share a kept-alive HTTPS connection. Bodies are
+// parsed straight from the socket through ArduinoJson filters and unchanged
+// payloads are skipped with ETag/If-Modified-Since.
+
+#define FETCH_CONNECT_TIMEOUT_ms  5000
+#define FETCH_TIMEOUT_ms          5000
+#define FETCH_BACKOFF_MIN_s       15
+#define FETCH_BACKOFF_MAX_s       600
+#define FETCH_IDLE_s              300   // Stop refreshing a source nobody read for this long
+#define FETCH_MAX_CONNECTIONS     3     // Kept-alive TLS connections, one per host
+#define FETCH_KEEPALIVE_s         150   // Close a pooled connection unused for this long
+
+enum FetchSource {
+  FETCH_PRICE,
+  FETCH_HEIGHT,
+  FETCH_GLOBAL,
+  FETCH_FEES,
+  FETCH_POOL,
+  FETCH_SOURCES
+};
+
+typedef struct {
+  unsigned int btcPrice;
+  unsigned long blockHeight;
+  char globalHash[24];          // Exahashes
+  char difficulty[24];
+  int halfHourFee;
+  int fastestFee;
+  int hourFee;
+  int economyFee;
+  int minimumFee;
+  int workersCount;             // Workers using your address on the pool
+  char workersHash[16];
+  char bestDifficulty[16];
+} fetch_cache;
+
+typedef struct {
+  bool valid;                   // At least one successful fetch
+  uint32_t age;                 // Seconds since the last success
+  uint16_t failures;            // Consecutive errors
+  int lastError;                // HTTP code or HTTPClient error of the last failure
+  uint32_t notModified;         // Fetches answered 304 thanks to ETag/Last-Modified
+  uint32_t peakHeap;            // Most heap a single fetch of this source took
+} fetch_status;
+
+typedef struct {
+  uint32_t handshakes;          // TLS handshakes since boot
+  uint32_t hourHandshakes;      // Value of handshakes when the current hour started
+  uint32_t lastHourHandshakes;
+  uint32_t reused;              // Requests sent on a kept-alive connection
+  uint32_t minFreeHeap;         // Lowest free heap seen during a fetch
+  uint32_t bytes;               // Body bytes downloaded since boot
+  uint32_t hourBytes;           // Value of bytes when the current hour started
+  uint32_t lastHourBytes;
+} fetch_pool_stats;
+
+void runFetcher(void *name);
+
+// Readers never block on the network. Reading a source also keeps it scheduled.
+fetch_cache getFetchCache(uint32_t sourcesMask);
+fetch_status getFetchStatus(FetchSource source);
+fetch_pool_stats getFetchPoolStats(void);
+String getFetchJson(void);
+
+#define FETCH_MASK(source) (1UL << (source))
+
+#endif // FETCHER_H
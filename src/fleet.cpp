@@ -0,0 +1,232 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <ESPmDNS.h>
+#include "fleet.h"
+#include "monitor.h"
+#include "minerStats.h"
+#include "hashrate.h"
+#include "version.h"
+
+extern unsigned long mLastJob;
+extern monitor_data mMonitor;
+
+static WiFiUDP fleetUDP;
+static const IPAddress fleetGroup(FLEET_MCAST_IP);
+static SemaphoreHandle_t fleetLock = NULL;
+static fleet_peer peers[FLEET_MAX_PEERS];
+static fleet_beacon localBeacon;
+
+static void buildLocalBeacon(fleet_beacon *b)
+{
+  unsigned long now = millis();
+  miner_stats stats = getMinerStats();
+
+  memset(b, 0, sizeof(fleet_beacon));
+  b->magic = FLEET_BEACON_MAGIC;
+  b->version = FLEET_BEACON_VERSION;
+  b->status = mMonitor.NerdStatus;
+  WiFi.macAddress(b->mac);
+  b->temperature = (int8_t)temperatureRead();
+  b->hashrate = (uint32_t)getHashrate().avg1m;
+  b->shares = stats.shares;
+  b->valids = stats.valids;
+  b->templates = stats.templates;
+  b->bestDiff = (float)stats.best_diff;
+  b->jobAge = (mLastJob == 0) ? 0xFFFF : min((now - mLastJob) / 1000, 0xFFFFUL);
+  b->uptime = stats.upTime;
+}
+
+static void storePeer(uint32_t ip, const fleet_beacon *b)
+{
+  unsigned long now = millis();
+  int freeSlot = -1;
+  int oldest = 0;
+
+  xSemaphoreTake(fleetLock, portMAX_DELAY);
+  for (int i = 0; i < FLEET_MAX_PEERS; i++) {
+    bool alive = peers[i].lastSeen != 0 && (now - peers[i].lastSeen) < FLEET_PEER_TIMEOUT_ms;
+    if (alive && memcmp(peers[i].beacon.mac, b->mac, 6) == 0) {
+      freeSlot = i;
+      break;
+    }
+    if (!alive && freeSlot < 0) freeSlot = i;
+    if (peers[i].lastSeen < peers[oldest].lastSeen) oldest = i;
+  }
+  if (freeSlot < 0) freeSlot = oldest;
+
+  peers[freeSlot].ip = ip;
+  peers[freeSlot].lastSeen = now;
+  peers[freeSlot].beacon = *b;
+  xSemaphoreGive(fleetLock);
+}
+
+static void receiveBeacons(void)
+{
+  int size;
+  while ((size = fleetUDP.parsePacket()) > 0) {
+    fleet_beacon b;
+    if (size != sizeof(fleet_beacon)) {
+      fleetUDP.flush();
+      continue;
+    }
+    fleetUDP.read((uint8_t *)&b, sizeof(b));
+    if (b.magic != FLEET_BEACON_MAGIC || b.version != FLEET_BEACON_VERSION) continue;
+    if (memcmp(b.mac, localBeacon.mac, 6) == 0) continue; // Our own beacon looped back
+
+    storePeer((uint32_t)fleetUDP.remoteIP(), &b);
+  }
+}
+
+static void sendBeacon(void)
+{
+  fleet_beacon b;
+  buildLocalBeacon(&b);
+
+  xSemaphoreTake(fleetLock, portMAX_DELAY);
+  localBeacon = b;
+  xSemaphoreGive(fleetLock);
+
+  fleetUDP.beginMulticastPacket();
+  fleetUDP.write((const uint8_t *)&b, sizeof(b));
+  fleetUDP.endPacket();
+}
+
+static void startDiscovery(void)
+{
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  char hostname[24];
+  snprintf(hostname, sizeof(hostname), "nerdminer-%02x%02x%02x", mac[3], mac[4], mac[5]);
+
+  if (MDNS.begin(hostname)) {
+    MDNS.addService("http", "tcp", 80);
+    MDNS.addService("nerdminer", "udp", FLEET_PORT);
+    MDNS.addServiceTxt("nerdminer", "udp", "version", CURRENT_VERSION);
+    Serial.printf("[FLEET] mDNS started as %s.local\n", hostname);
+  } else {
+    Serial.println("[FLEET] mDNS start failed");
+  }
+
+  fleetUDP.beginMulticast(fleetGroup, FLEET_PORT);
+}
+
+void runFleet(void *name)
+{
+  Serial.printf("\n[FLEET] Started. Running %s on core %d\n", (char *)name, xPortGetCoreID());
+
+  fleetLock = xSemaphoreCreateMutex();
+  WiFi.macAddress(localBeacon.mac);
+
+  bool started = false;
+  unsigned long lastBeacon = 0;
+
+  while (true) {
+    if (WiFi.status() != WL_CONNECTED) {
+      if (started) {
+        fleetUDP.stop();
+        MDNS.end();
+        started = false;
+      }
+      vTaskDelay(1000 / portTICK_PERIOD_MS);
+      continue;
+    }
+
+    if (!started) {
+      startDiscovery();
+      started = true;
+      lastBeacon = 0;
+    }
+
+    receiveBeacons();
+
+    if (lastBeacon == 0 || millis() - lastBeacon >= FLEET_BEACON_INTERVAL_ms) {
+      lastBeacon = millis();
+      sendBeacon();
+    }
+
+    vTaskDelay(250 / portTICK_PERIOD_MS);
+  }
+}
+
+/// @brief Copy the peers heard recently, not including this device.
+size_t getFleetPeers(fleet_peer *out, size_t maxPeers)
+{
+  if (fleetLock == NULL) return 0;
+
+  size_t n = 0;
+  unsigned long now = millis();
+  xSemaphoreTake(fleetLock, portMAX_DELAY);
+  for (int i = 0; i < FLEET_MAX_PEERS && n < maxPeers; i++) {
+    if (peers[i].lastSeen == 0 || (now - peers[i].lastSeen) >= FLEET_PEER_TIMEOUT_ms) continue;
+    out[n++] = peers[i];
+  }
+  xSemaphoreGive(fleetLock);
+  return n;
+}
+
+/// @brief Fleet totals including this device, from the beacons only.
+fleet_data getFleetData(void)
+{
+  fleet_data data = {0, 0, 0, 0, 0.0, 0};
+  if (fleetLock == NULL) return data;
+
+  fleet_peer list[FLEET_MAX_PEERS + 1];
+  size_t n = getFleetPeers(list, FLEET_MAX_PEERS);
+
+  xSemaphoreTake(fleetLock, portMAX_DELAY);
+  list[n++].beacon = localBeacon;
+  xSemaphoreGive(fleetLock);
+
+  for (size_t i = 0; i < n; i++) {
+    const fleet_beacon &b = list[i].beacon;
+    data.miners++;
+    data.hashrate += b.hashrate;
+    data.shares += b.shares;
+    data.valids += b.valids;
+    if (b.bestDiff > data.bestDiff) data.bestDiff = b.bestDiff;
+    if (b.jobAge != 0xFFFF && b.jobAge > data.maxJobAge) data.maxJobAge = b.jobAge;
+  }
+  return data;
+}
+
+String getFleetJson(void)
+{
+  fleet_peer list[FLEET_MAX_PEERS];
+  size_t n = getFleetPeers(list, FLEET_MAX_PEERS);
+  fleet_data totals = getFleetData();
+
+  DynamicJsonDocument doc(512 + n * 256);
+  doc["miners"] = totals.miners;
+  doc["hashrate"] = totals.hashrate;
+  doc["shares"] = totals.shares;
+  doc["valids"] = totals.valids;
+  doc["bestDiff"] = totals.bestDiff;
+  doc["maxJobAge"] = totals.maxJobAge;
+
+  JsonArray jsonPeers = doc.createNestedArray("peers");
+  for (size_t i = 0; i < n; i++) {
+    const fleet_beacon &b = list[i].beacon;
+    char mac[18];
+    snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x", b.mac[0], b.mac[1], b.mac[2], b.mac[3], b.mac[4], b.mac[5]);
+
+    JsonObject p = jsonPeers.createNestedObject();
+    p["mac"] = mac;
+    p["ip"] = IPAddress(list[i].ip).toString();
+    p["status"] = b.status;
+    p["hashrate"] = b.hashrate;
+    p["shares"] = b.shares;
+    p["valids"] = b.valids;
+    p["templates"] = b.templates;
+    p["bestDiff"] = b.bestDiff;
+    p["temperature"] = b.temperature;
+    p["jobAge"] = b.jobAge;
+    p["uptime"] = b.uptime;
+    p["lastSeen"] = (millis() - list[i].lastSeen) / 1000;
+  }
+
+  String json;
+  serializeJson(doc, json);
+  return json;
+}
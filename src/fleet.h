@@ -0,0 +1,57 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <Arduino.h>
+
+// Fleet discovery
+// Every miner announces itself over mDNS (_nerdminer._udp) and multicasts a
+// compact stats beacon on the LAN. Any device can aggregate the beacons it
+// hears into fleet totals without asking an external API.
+
+#define FLEET_MCAST_IP          239, 78, 77, 50
+#define FLEET_PORT              47700
+#define FLEET_BEACON_INTERVAL_ms 10000
+#define FLEET_PEER_TIMEOUT_ms   (4 * FLEET_BEACON_INTERVAL_ms)
+#define FLEET_MAX_PEERS         32
+
+#define FLEET_BEACON_MAGIC      0x4D4E  // "NM"
+#define FLEET_BEACON_VERSION    1
+
+typedef struct __attribute__((packed)) {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t status;           // NMState
+  uint8_t mac[6];
+  int8_t temperature;       // Celsius
+  uint8_t reserved;
+  uint32_t hashrate;        // H/s
+  uint32_t shares;          // 32 bit shares
+  uint32_t valids;          // Valid blocks
+  uint32_t templates;
+  float bestDiff;
+  uint16_t jobAge;          // Seconds since last mining.notify
+  uint32_t uptime;          // Seconds
+} fleet_beacon;
+
+typedef struct {
+  uint32_t ip;
+  unsigned long lastSeen;
+  fleet_beacon beacon;
+} fleet_peer;
+
+typedef struct {
+  uint8_t miners;           // Including this device
+  uint32_t hashrate;        // H/s
+  uint32_t shares;
+  uint32_t valids;
+  double bestDiff;
+  uint16_t maxJobAge;       // Oldest job in the fleet, seconds
+} fleet_data;
+
+void runFleet(void *name);
+
+fleet_data getFleetData(void);
+size_t getFleetPeers(fleet_peer *peers, size_t maxPeers);
+String getFleetJson(void);
+
+#endif // FLEET_H
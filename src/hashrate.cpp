@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "hashrate.h"
+
+#define WINDOWS 3
+static const float windowSeconds[WINDOWS] = {60, 15 * 60, 60 * 60};
+
+typedef struct {
+  float value;      // Biased average
+  float weight;     // Share of the window already covered by samples
+} ema;
+
+static ema total[WINDOWS];
+static ema perWorker[STATS_MAX_WORKERS];
+static float lastRate = 0;
+
+static uint64_t lastHashes[STATS_MAX_WORKERS];
+static int64_t lastSample = 0;
+
+static esp_timer_handle_t sampleTimer = NULL;
+static portMUX_TYPE hashrateMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void emaUpdate(ema *e, float rate, float seconds, float window)
+{
+  float alpha = 1.0f - expf(-seconds / window);
+  e->value += alpha * (rate - e->value);
+  e->weight += alpha * (1.0f - e->weight);
+}
+
+static float emaValue(const ema *e)
+{
+  return (e->weight > 0) ? e->value / e->weight : 0;
+}
+
+static void sampleHashrate(void *arg)
+{
+  int64_t now = esp_timer_get_time();
+  float seconds = (now - lastSample) / 1000000.0f;
+  if (seconds <= 0) return;
+
+  float rates[STATS_MAX_WORKERS];
+  float sum = 0;
+  for (uint8_t i = 0; i < STATS_MAX_WORKERS; i++) {
+    worker_counters c;
+    getWorkerCounters(i, &c);
+    rates[i] = (c.hashes - lastHashes[i]) / seconds;
+    lastHashes[i] = c.hashes;
+    sum += rates[i];
+  }
+  lastSample = now;
+
+  portENTER_CRITICAL(&hashrateMux);
+  for (int w = 0; w < WINDOWS; w++)
+    emaUpdate(&total[w], sum, seconds, windowSeconds[w]);
+  for (uint8_t i = 0; i < STATS_MAX_WORKERS; i++)
+    emaUpdate(&perWorker[i], rates[i], seconds, windowSeconds[0]);
+  lastRate = sum;
+  portEXIT_CRITICAL(&hashrateMux);
+}
+
+void setupHashrate(void)
+{
+  if (sampleTimer != NULL) return;
+
+  for (uint8_t i = 0; i < STATS_MAX_WORKERS; i++) {
+    worker_counters c;
+    getWorkerCounters(i, &c);
+    lastHashes[i] = c.hashes;
+  }
+  lastSample = esp_timer_get_time();
+
+  const esp_timer_create_args_t args = {
+    .callback = &sampleHashrate,
+    .arg = NULL,
+    .dispatch_method = ESP_TIMER_TASK,
+    .name = "hashrate"
+  };
+  esp_timer_create(&args, &sampleTimer);
+  esp_timer_start_periodic(sampleTimer, HASHRATE_SAMPLE_ms * 1000);
+}
+
+hashrate_data getHashrate(void)
+{
+  hashrate_data data;
+
+  portENTER_CRITICAL(&hashrateMux);
+  data.current = lastRate;
+  data.avg1m = emaValue(&total[0]);
+  data.avg15m = emaValue(&total[1]);
+  data.avg1h = emaValue(&total[2]);
+  for (uint8_t i = 0; i < STATS_MAX_WORKERS; i++)
+    data.worker[i] = emaValue(&perWorker[i]);
+  portEXIT_CRITICAL(&hashrateMux);
+
+  return data;
+}
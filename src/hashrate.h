@@ -0,0 +1,26 @@
+#ifndef HASHRATE_H
+#define HASHRATE_H
+
+#include <Arduino.h>
+#include "minerStats.h"
+
+// Hashrate estimator
+// A periodic esp_timer samples the exact per-worker hash counters and keeps
+// exponentially weighted averages over 1 minute, 15 minutes and 1 hour.
+// Weights use the real time between samples, so a late sample does not skew
+// the result, and the averages are bias corrected while they warm up.
+
+#define HASHRATE_SAMPLE_ms  1000
+
+typedef struct {
+  float current;                        // Last sample interval, H/s
+  float avg1m;                          // H/s
+  float avg15m;                         // H/s
+  float avg1h;                          // H/s
+  float worker[STATS_MAX_WORKERS];      // 1 minute average per miner task, H/s
+} hashrate_data;
+
+void setupHashrate(void);
+hashrate_data getHashrate(void);
+
+#endif // HASHRATE_H
@@ -0,0 +1,403 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <SPIFFS.h>
+#include <esp_timer.h>
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include "history.h"
+#include "minerStats.h"
+#include "monitor.h"
+
+#define HISTORY_MAGIC     0x4831      // Format version 1
+#define MAX_SAMPLE_BYTES  16          // State byte and four varints
+
+typedef struct __attribute__((packed)) {
+  uint16_t magic;
+  uint16_t count;                     // Samples, one minute apart
+  uint16_t used;                      // Bytes of data
+  uint16_t reserved;
+  uint32_t sequence;                  // The file slot is sequence % HISTORY_FILE_BLOCKS
+  uint32_t start;                     // Time of the first sample
+  uint32_t crc;                       // CRC32 of the header above and the used data
+} block_header;
+
+// Every sample is the state byte followed by varints: hashrate (10 H/s
+// units), temperature and RSSI as zigzag deltas to the previous sample of
+// the block, shares as a count. The first sample is relative to zero.
+typedef struct {
+  block_header h;
+  uint8_t data[HISTORY_BLOCK_SIZE - sizeof(block_header)];
+} history_block;
+
+extern monitor_data mMonitor;
+
+// Block being filled, kept across software resets and checked by its CRC at boot
+RTC_NOINIT_ATTR static history_block current;
+static history_sample lastSample;       // Base of the deltas of the next sample
+
+static history_block *ring = NULL;      // Closed blocks
+static uint32_t ringBlocks = 0;
+static uint32_t ringCount = 0;
+static uint32_t ringNext = 0;
+
+static File file;
+static bool fileReady = false;
+static uint32_t fileFirst = 1;          // Oldest sequence that may still be in the file
+static history_block scratch;           // File reads
+
+static uint32_t nextSequence = 1;
+static uint32_t spillMinutes = 0;
+static uint32_t lastMinute = 0;
+static uint64_t lastHashes = 0;
+static uint32_t lastShares = 0;
+static int64_t lastSampleUs = 0;
+
+static history_status status = {0, 0, 0, 0, 0, 0};
+static SemaphoreHandle_t historyLock = NULL;
+
+static uint32_t blockCrc(const history_block *b)
+{
+  uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&b->h, offsetof(block_header, crc));
+  return esp_rom_crc32_le(crc, b->data, b->h.used);
+}
+
+static bool blockValid(const history_block *b)
+{
+  return b->h.magic == HISTORY_MAGIC && b->h.count > 0 && b->h.count <= HISTORY_BLOCK_SAMPLES &&
+         b->h.used <= sizeof(b->data) && b->h.crc == blockCrc(b);
+}
+
+static uint32_t blockEnd(const block_header *h)
+{
+  return h->start + h->count * 60;
+}
+
+static uint32_t zigzag(int32_t v)
+{
+  return (v << 1) ^ (v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v)
+{
+  return (v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static uint8_t *putVarint(uint8_t *p, uint32_t v)
+{
+  while (v >= 0x80) {
+    *p++ = v | 0x80;
+    v >>= 7;
+  }
+  *p++ = v;
+  return p;
+}
+
+static const uint8_t *getVarint(const uint8_t *p, const uint8_t *end, uint32_t *v)
+{
+  *v = 0;
+  for (int shift = 0; p < end && shift < 35; shift += 7) {
+    uint8_t b = *p++;
+    *v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return p;
+  }
+  return NULL;
+}
+
+static size_t encodeSample(uint8_t *out, const history_sample *s, const history_sample *prev)
+{
+  uint8_t *p = out;
+  *p++ = s->state;
+  p = putVarint(p, zigzag((int32_t)(s->hashrate / 10) - (int32_t)(prev->hashrate / 10)));
+  p = putVarint(p, s->shares);
+  p = putVarint(p, zigzag(s->temperature - prev->temperature));
+  p = putVarint(p, zigzag(s->rssi - prev->rssi));
+  return p - out;
+}
+
+// Calls fn for the samples of the block within from..to, false once past to or stopped by fn
+static bool decodeBlock(const history_block *b, uint32_t from, uint32_t to, history_callback fn, void *arg, uint32_t *visited)
+{
+  const uint8_t *p = b->data;
+  const uint8_t *end = b->data + b->h.used;
+  int32_t units = 0, temperature = 0, rssi = 0;
+
+  for (uint16_t i = 0; i < b->h.count && p < end; i++) {
+    history_sample s;
+    uint32_t v;
+    s.state = *p++;
+    if ((p = getVarint(p, end, &v)) == NULL) break;
+    units += unzigzag(v);
+    if ((p = getVarint(p, end, &v)) == NULL) break;
+    s.shares = v;
+    if ((p = getVarint(p, end, &v)) == NULL) break;
+    temperature += unzigzag(v);
+    if ((p = getVarint(p, end, &v)) == NULL) break;
+    rssi += unzigzag(v);
+
+    s.time = b->h.start + i * 60;
+    s.hashrate = units * 10;
+    s.temperature = temperature;
+    s.rssi = rssi;
+    if (s.time > to) return false;
+    if (s.time < from) continue;
+    (*visited)++;
+    if (!fn(&s, arg)) return false;
+  }
+  return true;
+}
+
+static uint32_t fileOffset(uint32_t sequence)
+{
+  return (sequence % HISTORY_FILE_BLOCKS) * HISTORY_BLOCK_SIZE;
+}
+
+static void writeBlock(const history_block *b)
+{
+  if (!fileReady) return;
+  file.seek(fileOffset(b->h.sequence));
+  if (file.write((const uint8_t *)b, HISTORY_BLOCK_SIZE) != HISTORY_BLOCK_SIZE) {
+    Serial.printf("[HISTORY] Writing block %u failed\n", b->h.sequence);
+    return;
+  }
+  file.flush();
+  status.flashWrites++;
+  if (b->h.sequence >= fileFirst + HISTORY_FILE_BLOCKS) fileFirst = b->h.sequence - HISTORY_FILE_BLOCKS + 1;
+}
+
+static bool readHeader(uint32_t sequence, block_header *h)
+{
+  file.seek(fileOffset(sequence));
+  return file.read((uint8_t *)h, sizeof(block_header)) == sizeof(block_header) &&
+         h->magic == HISTORY_MAGIC && h->sequence == sequence;
+}
+
+static bool readBlock(uint32_t sequence, history_block *b)
+{
+  file.seek(fileOffset(sequence));
+  return file.read((uint8_t *)b, HISTORY_BLOCK_SIZE) == HISTORY_BLOCK_SIZE &&
+         b->h.sequence == sequence && blockValid(b);
+}
+
+static const history_block *ringAt(uint32_t i)
+{
+  return &ring[(ringNext + ringBlocks - ringCount + i) % ringBlocks];
+}
+
+static void pushRing(const history_block *b)
+{
+  if (ringBlocks == 0) return;
+  ring[ringNext] = *b;
+  ringNext = (ringNext + 1) % ringBlocks;
+  if (ringCount < ringBlocks) ringCount++;
+}
+
+static void closeBlock(void)
+{
+  if (current.h.magic != HISTORY_MAGIC || current.h.count == 0) return;
+  pushRing(&current);
+  writeBlock(&current);
+  current.h.magic = 0;
+}
+
+static void startBlock(uint32_t time)
+{
+  memset(&current, 0, sizeof(current));
+  current.h.magic = HISTORY_MAGIC;
+  current.h.sequence = nextSequence++;
+  current.h.start = time;
+  memset(&lastSample, 0, sizeof(lastSample));
+  spillMinutes = 0;
+}
+
+static void append(const history_sample *s)
+{
+  uint8_t encoded[MAX_SAMPLE_BYTES];
+  bool contiguous = current.h.magic == HISTORY_MAGIC && s->time == blockEnd(&current.h);
+  size_t n = encodeSample(encoded, s, &lastSample);
+
+  if (!contiguous || current.h.count >= HISTORY_BLOCK_SAMPLES || current.h.used + n > sizeof(current.data)) {
+    closeBlock();
+    startBlock(s->time);
+    n = encodeSample(encoded, s, &lastSample);
+  }
+
+  memcpy(current.data + current.h.used, encoded, n);
+  current.h.used += n;
+  current.h.count++;
+  current.h.crc = blockCrc(&current);
+  lastSample = *s;
+  status.samples++;
+
+  // A power cut loses at most HISTORY_SPILL_min minutes
+  if (++spillMinutes >= HISTORY_SPILL_min && current.h.count < HISTORY_BLOCK_SAMPLES) {
+    writeBlock(&current);
+    spillMinutes = 0;
+  }
+}
+
+static void openFile(void)
+{
+  const uint32_t size = HISTORY_FILE_BLOCKS * HISTORY_BLOCK_SIZE;
+
+  // Mounted by nvMemory when the config was loaded, mounting again is a no-op
+  if (!SPIFFS.begin(false)) {
+    Serial.printf("[HISTORY] SPIFFS not mounted, history kept in RAM only\n");
+    return;
+  }
+
+  if (SPIFFS.exists(HISTORY_FILE)) {
+    file = SPIFFS.open(HISTORY_FILE, "r+");
+    if (file && file.size() != size) {
+      file.close();
+      SPIFFS.remove(HISTORY_FILE);
+    }
+  }
+
+  if (!file) {
+    if (SPIFFS.totalBytes() - SPIFFS.usedBytes() < size + size / 8) {
+      Serial.printf("[HISTORY] Not enough SPIFFS space for %u bytes, history kept in RAM only\n", size);
+      return;
+    }
+    file = SPIFFS.open(HISTORY_FILE, "w+");
+    uint8_t zero[64] = {};
+    for (uint32_t written = 0; file && written < size; written += sizeof(zero))
+      file.write(zero, sizeof(zero));
+    file.flush();
+  }
+
+  fileReady = file;
+  status.fileBytes = fileReady ? size : 0;
+}
+
+static void restore(void)
+{
+  uint32_t newest = 0;
+  if (fileReady) {
+    for (uint32_t slot = 0; slot < HISTORY_FILE_BLOCKS; slot++) {
+      block_header h;
+      file.seek(slot * HISTORY_BLOCK_SIZE);
+      if (file.read((uint8_t *)&h, sizeof(h)) == sizeof(h) && h.magic == HISTORY_MAGIC &&
+          h.sequence % HISTORY_FILE_BLOCKS == slot && h.sequence > newest)
+        newest = h.sequence;
+    }
+  }
+
+  // The RTC copy of the block being filled is newer than its last spill
+  if (blockValid(&current) && current.h.sequence >= newest) {
+    Serial.printf("[HISTORY] Recovered %u samples kept over the reset\n", current.h.count);
+    newest = current.h.sequence;
+    writeBlock(&current);
+    if (!fileReady) pushRing(&current);
+  }
+  current.h.magic = 0;
+
+  nextSequence = newest + 1;
+  fileFirst = newest >= HISTORY_FILE_BLOCKS ? newest - HISTORY_FILE_BLOCKS + 1 : 1;
+  if (!fileReady) return;
+
+  uint32_t first = max(fileFirst, newest + 1 > ringBlocks ? newest + 1 - ringBlocks : 1);
+  for (uint32_t seq = first; seq <= newest; seq++)
+    if (readBlock(seq, &scratch)) pushRing(&scratch);
+}
+
+void setupHistory(void)
+{
+  historyLock = xSemaphoreCreateMutex();
+
+  ringBlocks = psramFound() ? HISTORY_RAM_BLOCKS_PSRAM : HISTORY_RAM_BLOCKS;
+  size_t bytes = ringBlocks * sizeof(history_block);
+  ring = (history_block *)(psramFound() ? heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM) : malloc(bytes));
+  if (ring == NULL) ringBlocks = 0;
+  status.ramBlocks = ringBlocks;
+  status.ramBytes = ringBlocks * sizeof(history_block) + sizeof(current);
+
+  openFile();
+  restore();
+  Serial.printf("[HISTORY] %u blocks in %s, %u blocks restored, %u bytes of file\n", ringBlocks,
+                psramFound() ? "PSRAM" : "RAM", ringCount, status.fileBytes);
+}
+
+/// @brief Records a sample when a new minute started
+void historyUpdate(void)
+{
+  uint32_t now = getEpochSeconds();
+  if (now == 0 || historyLock == NULL) return;
+
+  uint32_t minute = now / 60;
+  if (minute == lastMinute) return;
+
+  miner_stats stats = getMinerStats();
+  int64_t nowUs = esp_timer_get_time();
+
+  // The first minute only sets the base, a clock going back restarts it
+  if (lastMinute != 0 && minute > lastMinute) {
+    float seconds = (nowUs - lastSampleUs) / 1000000.0f;
+    bool wifi = WiFi.status() == WL_CONNECTED;
+    history_sample s;
+    s.time = minute * 60;
+    s.hashrate = (seconds > 0 && stats.hashes >= lastHashes) ? (stats.hashes - lastHashes) / seconds : 0;
+    s.shares = stats.shares >= lastShares ? min(stats.shares - lastShares, (uint32_t)0xFFFF) : 0;
+    s.temperature = temperatureRead();
+    s.rssi = wifi ? WiFi.RSSI() : 0;
+    s.state = (mMonitor.NerdStatus & 0x0F) | (wifi ? HISTORY_WIFI : 0);
+
+    xSemaphoreTake(historyLock, portMAX_DELAY);
+    append(&s);
+    xSemaphoreGive(historyLock);
+  }
+
+  lastMinute = minute;
+  lastHashes = stats.hashes;
+  lastShares = stats.shares;
+  lastSampleUs = nowUs;
+}
+
+uint32_t historyQuery(uint32_t from, uint32_t to, history_callback fn, void *arg)
+{
+  if (historyLock == NULL) return 0;
+
+  uint32_t visited = 0;
+  bool more = true;
+  xSemaphoreTake(historyLock, portMAX_DELAY);
+
+  // Only ranges older than the RAM ring read the file
+  uint32_t ringFirst = ringCount ? ringAt(0)->h.sequence : nextSequence;
+  bool inRing = ringCount && from >= ringAt(0)->h.start;
+  for (uint32_t seq = fileFirst; more && fileReady && !inRing && seq < ringFirst; seq++) {
+    block_header h;
+    if (!readHeader(seq, &h) || blockEnd(&h) <= from) continue;
+    if (h.start > to) {
+      more = false;
+      break;
+    }
+    if (readBlock(seq, &scratch)) more = decodeBlock(&scratch, from, to, fn, arg, &visited);
+  }
+
+  for (uint32_t i = 0; more && i < ringCount; i++) {
+    const history_block *b = ringAt(i);
+    if (blockEnd(&b->h) > from) more = decodeBlock(b, from, to, fn, arg, &visited);
+  }
+
+  if (more && current.h.magic == HISTORY_MAGIC) decodeBlock(&current, from, to, fn, arg, &visited);
+
+  xSemaphoreGive(historyLock);
+  return visited;
+}
+
+history_status getHistoryStatus(void)
+{
+  if (historyLock == NULL) return status;
+
+  xSemaphoreTake(historyLock, portMAX_DELAY);
+  history_status copy = status;
+  copy.oldest = 0;
+  for (uint32_t seq = fileFirst; fileReady && seq < nextSequence && copy.oldest == 0; seq++) {
+    block_header h;
+    if (readHeader(seq, &h)) copy.oldest = h.start;
+  }
+  if (copy.oldest == 0 && ringCount) copy.oldest = ringAt(0)->h.start;
+  if (copy.oldest == 0 && current.h.magic == HISTORY_MAGIC) copy.oldest = current.h.start;
+  xSemaphoreGive(historyLock);
+  return copy;
+}
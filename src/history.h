@@ -0,0 +1,60 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+
+// Mining history
+// Once a minute the monitor records the hashrate, the 32 bit shares found,
+// the chip temperature, the WiFi RSSI and the miner state. Samples are
+// delta / varint encoded into blocks of HISTORY_BLOCK_SIZE bytes holding up
+// to one hour each (about 6 bytes per sample). The block being filled lives
+// in RTC memory so it survives a crash or watchdog reset, closed blocks are
+// kept in a RAM ring (PSRAM when present) and every block is also written to
+// a fixed size ring file on SPIFFS, so the history survives power cuts.
+//
+// Budget per day of history (24 blocks):
+//   RAM    24 x 512 B = 12 KB; the ring holds HISTORY_RAM_BLOCKS blocks
+//   SPIFFS the file is HISTORY_FILE_BLOCKS x 512 B = 84 KB (7 days), fixed
+//   writes 24 closed blocks + 24 x (60 / HISTORY_SPILL_min - 1) spills of the
+//          current block = 48 x 512 B = 24 KB written per day
+// Older data is overwritten, neither memory nor the file ever grows.
+
+#define HISTORY_BLOCK_SIZE        512
+#define HISTORY_BLOCK_SAMPLES     60          // One hour per block
+#define HISTORY_RAM_BLOCKS        4           // Without PSRAM, 4 hours
+#define HISTORY_RAM_BLOCKS_PSRAM  48          // 2 days
+#define HISTORY_FILE_BLOCKS       (7 * 24)    // 7 days
+#define HISTORY_SPILL_min         30          // Current block written to the file this often
+#define HISTORY_QUERY_MAX         1440        // Samples per web request, one day
+#define HISTORY_FILE              "/history.bin"
+
+#define HISTORY_WIFI              0x10        // State flag, WiFi connected
+
+typedef struct {
+  uint32_t time;                // Local time, seconds since 1970
+  uint32_t hashrate;            // H/s, 10 H/s resolution
+  uint16_t shares;              // 32 bit shares found during the minute
+  int8_t temperature;           // Celsius
+  int8_t rssi;                  // dBm, 0 while disconnected
+  uint8_t state;                // NMState | HISTORY_WIFI
+} history_sample;
+
+typedef struct {
+  uint32_t samples;             // Recorded since boot
+  uint32_t ramBlocks;           // Ring size
+  uint32_t ramBytes;
+  uint32_t fileBytes;           // 0 when SPIFFS is not available
+  uint32_t flashWrites;         // Block writes since boot
+  uint32_t oldest;              // Time of the oldest sample kept, 0 if none
+} history_status;
+
+typedef bool (*history_callback)(const history_sample *s, void *arg);
+
+void setupHistory(void);
+void historyUpdate(void);       // Monitor loop
+
+// Calls fn for every sample from from to to (seconds), oldest first, until it returns false
+uint32_t historyQuery(uint32_t from, uint32_t to, history_callback fn, void *arg);
+history_status getHistoryStatus(void);
+
+#endif // HISTORY_H
@@ -0,0 +1,135 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include "inputEvents.h"
+#include "drivers/devices/device.h"
+
+static QueueHandle_t inputQueue = NULL;
+
+// One queued event per source until the loop takes it, a bouncing contact
+// or a PENIRQ glitching during the SPI reads wakes the loop only once
+static volatile bool pending[INPUT_PORTAL + 1];
+
+static input_stats stats = {0, {}, 0, 0, 0};
+static portMUX_TYPE inputMux = portMUX_INITIALIZER_UNLOCKED;
+
+static int64_t periodStart = 0;
+static uint32_t periodWakeups = 0;
+static int64_t periodBusy = 0;
+
+#if defined(PIN_BUTTON_1) || defined(TOUCH_IRQ)
+static void IRAM_ATTR postFromIsr(input_event event)
+{
+  if (pending[event]) return;
+  pending[event] = true;
+
+  BaseType_t woken = pdFALSE;
+  uint8_t e = event;
+  xQueueSendFromISR(inputQueue, &e, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+#endif
+
+#ifdef PIN_BUTTON_1
+static void IRAM_ATTR onButton(void)
+{
+  postFromIsr(INPUT_BUTTON);
+}
+#endif
+
+#if defined(TOUCH_ENABLE) && defined(TOUCH_IRQ)
+static void IRAM_ATTR onTouch(void)
+{
+  postFromIsr(INPUT_TOUCH);
+}
+#endif
+
+void postInput(input_event event)
+{
+  if (inputQueue == NULL || pending[event]) return;
+  pending[event] = true;
+
+  uint8_t e = event;
+  xQueueSend(inputQueue, &e, 0);
+}
+
+// Runs in the WiFi event task
+static void onWifiEvent(arduino_event_id_t event)
+{
+  postInput(INPUT_WIFI);
+}
+
+void setupInput(void)
+{
+  inputQueue = xQueueCreate(INPUT_QUEUE_LENGTH, sizeof(uint8_t));
+
+  // OneButton already configured the pins. GPIO 36/39 may fire spurious
+  // edges while the ADC or WiFi runs, that only costs a wakeup.
+#ifdef PIN_BUTTON_1
+  attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_1), onButton, CHANGE);
+#endif
+#ifdef PIN_BUTTON_2
+  attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_2), onButton, CHANGE);
+#endif
+
+  // The XPT2046 pulls PENIRQ low while the panel is pressed
+#if defined(TOUCH_ENABLE) && defined(TOUCH_IRQ)
+  attachInterrupt(digitalPinToInterrupt(TOUCH_IRQ), onTouch, FALLING);
+#endif
+
+  WiFi.onEvent(onWifiEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  WiFi.onEvent(onWifiEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  WiFi.onEvent(onWifiEvent, ARDUINO_EVENT_WIFI_AP_STACONNECTED);
+
+  periodStart = esp_timer_get_time();
+}
+
+/// @brief Blocks the calling task until an input event arrives or the timeout expires (INPUT_FOREVER: never)
+input_event waitInput(uint32_t timeoutMs)
+{
+  uint8_t e;
+  TickType_t ticks = timeoutMs == INPUT_FOREVER ? portMAX_DELAY : timeoutMs / portTICK_PERIOD_MS;
+  if (xQueueReceive(inputQueue, &e, ticks) != pdTRUE) return INPUT_TIMEOUT;
+
+  pending[e] = false;
+  return (input_event)e;
+}
+
+/// @brief Adds a loop iteration woken by event that kept the task busy for busyUs
+void inputAccount(input_event event, int64_t busyUs)
+{
+  portENTER_CRITICAL(&inputMux);
+  stats.wakeups++;
+  stats.events[event]++;
+  stats.busyUs += busyUs;
+  portEXIT_CRITICAL(&inputMux);
+
+  periodWakeups++;
+  periodBusy += busyUs;
+
+  int64_t now = esp_timer_get_time();
+  if (now - periodStart < INPUT_STATS_ms * 1000LL) return;
+
+  float seconds = (now - periodStart) / 1000000.0f;
+  portENTER_CRITICAL(&inputMux);
+  stats.wakeupsPerSecond = periodWakeups / seconds;
+  stats.loadPermille = periodBusy * 1000 / (now - periodStart);
+  portEXIT_CRITICAL(&inputMux);
+
+  Serial.printf("[INPUT] loop %.1f wakeups/s, busy %.1f ms/s (%u.%u%% of a core), %u button, %u touch, %u wifi, %u portal, %u timeout wakeups since boot\n",
+                stats.wakeupsPerSecond, periodBusy / seconds / 1000, stats.loadPermille / 10, stats.loadPermille % 10,
+                stats.events[INPUT_BUTTON], stats.events[INPUT_TOUCH], stats.events[INPUT_WIFI], stats.events[INPUT_PORTAL],
+                stats.events[INPUT_TIMEOUT]);
+
+  periodStart = now;
+  periodWakeups = 0;
+  periodBusy = 0;
+}
+
+input_stats getInputStats(void)
+{
+  portENTER_CRITICAL(&inputMux);
+  input_stats copy = stats;
+  portEXIT_CRITICAL(&inputMux);
+  return copy;
+}
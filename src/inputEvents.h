@@ -0,0 +1,44 @@
+#ifndef INPUTEVENTS_H
+#define INPUTEVENTS_H
+
+#include <Arduino.h>
+
+// Input events
+// Button edges, the touch controller PENIRQ, WiFi events and work the web
+// server leaves for the loop are posted to a queue from their interrupt /
+// event handlers, so the Arduino loop task blocks on it instead of waking
+// every 50 ms. Debouncing stays in the loop: OneButton is ticked quickly only
+// while a button gesture is in progress. The captive portal DNS still needs
+// to be polled while the access point is up; otherwise the loop only wakes on
+// a timeout for a pending STA connection attempt and a delayed restart, and
+// blocks with no timeout at all when none is pending.
+
+#define INPUT_QUEUE_LENGTH  8
+#define INPUT_TICK_ms       10          // Button pressed or gesture pending
+#define INPUT_PORTAL_ms     50          // Access point up, DNS requests are answered from the loop
+#define INPUT_FOREVER       UINT32_MAX  // Nothing due, only an event wakes the loop
+#define INPUT_STATS_ms      60000       // Loop report period
+
+typedef enum {
+  INPUT_TIMEOUT = 0,
+  INPUT_BUTTON,
+  INPUT_TOUCH,
+  INPUT_WIFI,
+  INPUT_PORTAL                          // Settings saved, restart or reset requested
+} input_event;
+
+typedef struct {
+  uint32_t wakeups;                     // Since boot
+  uint32_t events[INPUT_PORTAL + 1];    // Wakeups per cause
+  uint64_t busyUs;                      // Loop task CPU time
+  float wakeupsPerSecond;               // Last report period
+  uint16_t loadPermille;                // Last report period, share of one core
+} input_stats;
+
+void setupInput(void);
+void postInput(input_event event);      // From a task, not an interrupt
+input_event waitInput(uint32_t timeoutMs);
+void inputAccount(input_event event, int64_t busyUs);
+input_stats getInputStats(void);
+
+#endif // INPUTEVENTS_H
@@ -0,0 +1,257 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <stdarg.h>
+#include "journal.h"
+#include "monitor.h"
+#include "drivers/storage/SDCard.h"
+
+#define ROTATED_FILE "/journal.%d.log"
+
+extern SDCard SDCrd;
+
+static const char *typeNames[] = {"BOOT", "SHARE", "RESULT", "POOL", "WIFI", "BENCH"};
+
+static uint8_t *ring = NULL;            // ringBlocks x JOURNAL_BLOCK_SIZE
+static uint16_t *used = NULL;           // Bytes filled in each block
+static uint32_t ringBlocks = 0;
+static uint32_t head = 0;               // Block being filled, counts up
+static uint32_t tail = 0;               // Oldest block not completely on the card
+static uint32_t written = 0;            // Bytes of the tail block already on the card
+
+static journal_stats stats;
+static portMUX_TYPE journalMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t journalTask = NULL;
+
+// Journal task only
+static size_t fileSize = 0;
+static int64_t lastRetry = 0;
+
+void journalEvent(journal_type type, const char *format, ...)
+{
+  if (ring == NULL) return;
+  int64_t start = esp_timer_get_time();
+
+  char line[JOURNAL_LINE_MAX];
+  int len = snprintf(line, sizeof(line), "%u %lu %s ", getEpochSeconds(), millis(), typeNames[type]);
+  va_list args;
+  va_start(args, format);
+  len += vsnprintf(line + len, sizeof(line) - len, format, args);
+  va_end(args);
+  if (len > (int)sizeof(line) - 2) len = sizeof(line) - 2;   // Truncated
+  line[len++] = '\n';
+
+  bool blockFull = false;
+  portENTER_CRITICAL(&journalMux);
+  // Free bytes up to the block before the tail, the head never reaches the tail
+  uint32_t space = (tail + ringBlocks - 1 - head) * JOURNAL_BLOCK_SIZE + JOURNAL_BLOCK_SIZE - used[head % ringBlocks];
+  if ((uint32_t)len >= space) {
+    stats.dropped++;
+  } else {
+    const char *p = line;
+    while (len > 0) {
+      uint32_t h = head % ringBlocks;
+      uint32_t n = min((uint32_t)len, (uint32_t)(JOURNAL_BLOCK_SIZE - used[h]));
+      memcpy(ring + h * JOURNAL_BLOCK_SIZE + used[h], p, n);
+      used[h] += n;
+      p += n;
+      len -= n;
+      if (used[h] == JOURNAL_BLOCK_SIZE) {
+        head++;
+        used[head % ringBlocks] = 0;
+        blockFull = true;
+      }
+    }
+    stats.events++;
+  }
+  portEXIT_CRITICAL(&journalMux);
+
+  if (blockFull && journalTask) xTaskNotifyGive(journalTask);
+
+  uint32_t us = esp_timer_get_time() - start;
+  portENTER_CRITICAL(&journalMux);
+  if (us > stats.maxEnqueueUs) stats.maxEnqueueUs = us;
+  portEXIT_CRITICAL(&journalMux);
+}
+
+// journal.log -> journal.1.log -> ... -> journal.<JOURNAL_FILES>.log, the oldest is replaced
+static void rotateFiles(void)
+{
+  char from[24], to[24];
+  for (int i = JOURNAL_FILES - 1; i >= 1; i--) {
+    snprintf(from, sizeof(from), ROTATED_FILE, i);
+    snprintf(to, sizeof(to), ROTATED_FILE, i + 1);
+    SDCrd.renameFile(from, to);
+  }
+  snprintf(to, sizeof(to), ROTATED_FILE, 1);
+  SDCrd.renameFile(JOURNAL_FILE, to);
+  Serial.printf("[JOURNAL] Rotated %s after %u bytes\n", JOURNAL_FILE, fileSize);
+  fileSize = 0;
+}
+
+static bool mountCard(void)
+{
+  if (!SDCrd.remount()) return false;
+  fileSize = SDCrd.fileSize(JOURNAL_FILE);
+  // A partial block left by the last boot would shift every block off its 4 KB boundary
+  if (fileSize % JOURNAL_BLOCK_SIZE) rotateFiles();
+  Serial.printf("[JOURNAL] Card mounted, %s is %u bytes\n", JOURNAL_FILE, fileSize);
+  return true;
+}
+
+/// @brief Writes the closed blocks, and the filled part of the current one when partial is set
+static void flushRing(bool partial)
+{
+  while (true) {
+    portENTER_CRITICAL(&journalMux);
+    uint32_t t = tail % ringBlocks;
+    bool closed = tail != head;
+    uint32_t from = written;
+    uint32_t to = used[t];
+    bool ready = stats.cardReady;
+    portEXIT_CRITICAL(&journalMux);
+
+    if (to == from || (!closed && !partial)) return;
+    if (SDCrd.cardBusy()) return;
+
+    if (!ready) {
+      int64_t now = esp_timer_get_time();
+      if (lastRetry != 0 && now - lastRetry < JOURNAL_RETRY_s * 1000000LL) return;
+      lastRetry = now;
+      if (!mountCard()) return;
+      portENTER_CRITICAL(&journalMux);
+      stats.cardReady = true;
+      portEXIT_CRITICAL(&journalMux);
+    }
+
+    if (from == 0 && fileSize >= JOURNAL_FILE_MAX) rotateFiles();
+
+    int64_t start = esp_timer_get_time();
+    bool ok = SDCrd.appendFile(JOURNAL_FILE, ring + t * JOURNAL_BLOCK_SIZE + from, to - from);
+    uint32_t us = esp_timer_get_time() - start;
+
+    portENTER_CRITICAL(&journalMux);
+    if (ok) {
+      written = to;
+      if (closed) {
+        tail++;
+        written = 0;
+        stats.blocks++;
+      }
+      stats.writes++;
+      stats.bytes += to - from;
+      if (us > stats.maxWriteUs) stats.maxWriteUs = us;
+    } else {
+      stats.writeErrors++;
+      stats.cardReady = false;
+    }
+    portEXIT_CRITICAL(&journalMux);
+
+    if (!ok) {
+      // Removed or failing card, the block stays in the ring until a remount works
+      Serial.printf("[JOURNAL] Write failed, keeping the events in RAM, retry in %d s\n", JOURNAL_RETRY_s);
+      lastRetry = esp_timer_get_time();
+      return;
+    }
+    fileSize += to - from;
+  }
+}
+
+static void runJournal(void *name)
+{
+  Serial.printf("[JOURNAL] Started on core %d, %u blocks of %u bytes\n", xPortGetCoreID(), ringBlocks, JOURNAL_BLOCK_SIZE);
+  int64_t lastFlush = esp_timer_get_time();
+  int64_t lastStats = lastFlush;
+
+  while (true) {
+    // Woken when a block is full, else once per flush period
+    ulTaskNotifyTake(pdTRUE, JOURNAL_FLUSH_s * 1000 / portTICK_PERIOD_MS);
+
+    int64_t now = esp_timer_get_time();
+    bool partial = now - lastFlush >= JOURNAL_FLUSH_s * 1000000LL;
+    if (partial) lastFlush = now;
+    flushRing(partial);
+
+    if (now - lastStats >= JOURNAL_STATS_s * 1000000LL) {
+      lastStats = now;
+      journal_stats s = getJournalStats();
+      Serial.printf("[JOURNAL] %u events, %u dropped, %u blocks (%llu bytes) written, %u write errors, %u bytes pending, worst enqueue %u us, worst write %u us, card %s\n",
+                    s.events, s.dropped, s.blocks, s.bytes, s.writeErrors, s.pending, s.maxEnqueueUs, s.maxWriteUs, s.cardReady ? "ready" : "missing");
+    }
+  }
+}
+
+// Runs in the WiFi event task
+static void onWifiEvent(arduino_event_id_t event, arduino_event_info_t info)
+{
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+    journalEvent(JOURNAL_WIFI, "connected ip=%s rssi=%d", WiFi.localIP().toString().c_str(), WiFi.RSSI());
+  else
+    journalEvent(JOURNAL_WIFI, "disconnected reason=%u", info.wifi_sta_disconnected.reason);
+}
+
+#ifdef JOURNAL_BENCH
+// Floods the journal: the events queued per second once the ring is full is
+// what the card sustains, the worst enqueue latency includes lock contention
+// with the writer
+static void runJournalBench(void *name)
+{
+  vTaskDelay(5000 / portTICK_PERIOD_MS);
+  journal_stats before = getJournalStats();
+  int64_t start = esp_timer_get_time();
+  uint32_t offered = 0;
+
+  while (esp_timer_get_time() - start < JOURNAL_BENCH_s * 1000000LL) {
+    journalEvent(JOURNAL_BENCH, "seq=%u job=%08x nonce=%08x diff=%.6f", offered, offered * 2654435761u, offered, offered / 1000.0);
+    if ((++offered & 63) == 0) vTaskDelay(1);
+  }
+
+  float seconds = (esp_timer_get_time() - start) / 1000000.0f;
+  journal_stats after = getJournalStats();
+  uint32_t queued = after.events - before.events;
+  uint64_t cardBytes = after.bytes - before.bytes;
+  float lineBytes = queued ? (float)((int64_t)cardBytes + after.pending - (int64_t)before.pending) / queued : 0;
+  if (lineBytes <= 0) lineBytes = 1;
+  Serial.printf("[JOURNAL] Bench: %u events offered (%.0f/s), %u queued, %u dropped, card %.1f KB/s = %.0f events/s sustained, worst enqueue %u us, worst write %u us\n",
+                offered, offered / seconds, queued, after.dropped - before.dropped, cardBytes / seconds / 1024,
+                cardBytes / lineBytes / seconds, after.maxEnqueueUs, after.maxWriteUs);
+  vTaskDelete(NULL);
+}
+#endif
+
+void setupJournal(void)
+{
+#if defined(BUILD_SDMMC_1) || defined(BUILD_SDMMC_4) || defined(BUILD_SDSPI)
+  ringBlocks = psramFound() ? JOURNAL_BLOCKS_PSRAM : JOURNAL_BLOCKS;
+  uint32_t caps = psramFound() ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+  ring = (uint8_t *)heap_caps_malloc(ringBlocks * JOURNAL_BLOCK_SIZE, caps);
+  used = (uint16_t *)calloc(ringBlocks, sizeof(uint16_t));
+  if (ring == NULL || used == NULL) {
+    Serial.printf("[JOURNAL] No memory for %u blocks, journal disabled\n", ringBlocks);
+    free(ring);
+    free(used);
+    ring = NULL;
+    return;
+  }
+
+  memset(&stats, 0, sizeof(stats));
+  xTaskCreatePinnedToCore(runJournal, "Journal", 4096, NULL, 1, &journalTask, 0);
+
+  WiFi.onEvent(onWifiEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  WiFi.onEvent(onWifiEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+
+#ifdef JOURNAL_BENCH
+  xTaskCreate(runJournalBench, "JournalBench", 4096, NULL, 1, NULL);
+#endif
+#endif
+}
+
+journal_stats getJournalStats(void)
+{
+  portENTER_CRITICAL(&journalMux);
+  journal_stats copy = stats;
+  copy.pending = ring ? (head - tail) * JOURNAL_BLOCK_SIZE + used[head % ringBlocks] - written : 0;
+  portEXIT_CRITICAL(&journalMux);
+  return copy;
+}
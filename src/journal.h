@@ -0,0 +1,59 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <Arduino.h>
+
+// Share and event journal
+// Every submitted share, pool reply, pool and WiFi event is appended as one
+// text line ("<epoch> <uptime ms> <TYPE> <text>") to a journal on the SD card.
+// journalEvent() only copies the line into a RAM ring of JOURNAL_BLOCK_SIZE
+// blocks, it never touches the card. The Journal task writes each block with
+// one append, so the card sees whole, 4 KB aligned blocks under load; a block
+// that fills slowly is flushed in parts every JOURNAL_FLUSH_s, the parts add up
+// to the same aligned block in the file.
+// The file is rotated by size (journal.log, journal.1.log ... JOURNAL_FILES).
+// While the card is missing, busy or failing, blocks stay in the ring and the
+// card is remounted every JOURNAL_RETRY_s; when the ring is full new events are
+// dropped and counted.
+// Build with -D JOURNAL_BENCH=1 to flood the journal for JOURNAL_BENCH_s after
+// boot and report the sustained event rate and the worst enqueue latency.
+
+#define JOURNAL_BLOCK_SIZE    4096
+#define JOURNAL_BLOCKS        2           // Without PSRAM, 8 KB
+#define JOURNAL_BLOCKS_PSRAM  16          // 64 KB
+#define JOURNAL_LINE_MAX      160
+#define JOURNAL_FLUSH_s       30
+#define JOURNAL_RETRY_s       60
+#define JOURNAL_FILE_MAX      (256 * JOURNAL_BLOCK_SIZE)   // 1 MB, whole blocks
+#define JOURNAL_FILES         8           // Rotated files kept besides the current one
+#define JOURNAL_FILE          "/journal.log"
+#define JOURNAL_STATS_s       600
+#define JOURNAL_BENCH_s       10
+
+typedef enum {
+  JOURNAL_BOOT,
+  JOURNAL_SHARE,                  // Submitted to the pool
+  JOURNAL_RESULT,                 // Pool reply to a submit
+  JOURNAL_POOL,                   // Connect, subscribe, disconnect
+  JOURNAL_WIFI,
+  JOURNAL_BENCH
+} journal_type;
+
+typedef struct {
+  uint32_t events;                // Queued since boot
+  uint32_t dropped;               // Ring full
+  uint32_t blocks;                // Full blocks written
+  uint32_t writes;                // Card appends, full and partial blocks
+  uint32_t writeErrors;
+  uint64_t bytes;                 // Written to the card
+  uint32_t pending;               // Bytes waiting in the ring
+  uint32_t maxEnqueueUs;          // Worst journalEvent() call
+  uint32_t maxWriteUs;            // Worst card append
+  bool cardReady;
+} journal_stats;
+
+void setupJournal(void);
+void journalEvent(journal_type type, const char *format, ...) __attribute__((format(printf, 2, 3)));
+journal_stats getJournalStats(void);
+
+#endif // JOURNAL_H
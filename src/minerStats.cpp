@@ -0,0 +1,133 @@
+#include <Arduino.h>
+#include "minerStats.h"
+
+typedef struct {
+  volatile uint32_t seq;    // Odd while the owner is writing
+  worker_counters c;
+} __attribute__((aligned(STATS_CACHE_LINE))) worker_slot;
+
+static worker_slot slots[STATS_MAX_WORKERS];
+
+// Restored totals and the slot values at the last reset, written rarely
+static volatile uint32_t baseSeq = 0;
+static miner_stats base = {0, 0, 0, 0, 0.0, 0, 0};
+static worker_counters resetOffset[STATS_MAX_WORKERS];
+static volatile uint32_t templates = 0;
+static volatile uint32_t generation = 0;
+
+static portMUX_TYPE slotMux = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE baseMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void readSlot(uint8_t worker, worker_counters *out)
+{
+  uint32_t seq;
+  do {
+    seq = slots[worker].seq;
+    __sync_synchronize();
+    memcpy(out, (const void *)&slots[worker].c, sizeof(worker_counters));
+    __sync_synchronize();
+  } while ((seq & 1) || seq != slots[worker].seq);
+}
+
+static void readBase(miner_stats *out, worker_counters *offsets)
+{
+  uint32_t seq;
+  do {
+    seq = baseSeq;
+    __sync_synchronize();
+    memcpy(out, &base, sizeof(miner_stats));
+    memcpy(offsets, resetOffset, sizeof(resetOffset));
+    __sync_synchronize();
+  } while ((seq & 1) || seq != baseSeq);
+}
+
+void statsWorkerBegin(uint8_t worker, worker_counters *local)
+{
+  // Only the owner writes its slot, so it can read it without the seqlock
+  memcpy(local, (const void *)&slots[worker].c, sizeof(worker_counters));
+}
+
+void statsWorkerPublish(uint8_t worker, worker_counters *local)
+{
+  if (local->generation != generation) {
+    // Stats were reset: hashes and shares are offset by the reset, best diff starts over
+    local->best_diff = 0.0;
+    local->generation = generation;
+  }
+
+  portENTER_CRITICAL(&slotMux);
+  slots[worker].seq++;
+  __sync_synchronize();
+  memcpy((void *)&slots[worker].c, local, sizeof(worker_counters));
+  __sync_synchronize();
+  slots[worker].seq++;
+  portEXIT_CRITICAL(&slotMux);
+}
+
+/// @brief Raw counters of one worker since boot, not affected by statsReset().
+void getWorkerCounters(uint8_t worker, worker_counters *out)
+{
+  readSlot(worker, out);
+}
+
+void statsAddTemplate(void)
+{
+  __atomic_add_fetch(&templates, 1, __ATOMIC_RELAXED);
+}
+
+miner_stats getMinerStats(void)
+{
+  miner_stats stats;
+  worker_counters offsets[STATS_MAX_WORKERS];
+  readBase(&stats, offsets);
+
+  for (uint8_t i = 0; i < STATS_MAX_WORKERS; i++) {
+    worker_counters c;
+    readSlot(i, &c);
+    stats.hashes += c.hashes - offsets[i].hashes;
+    stats.shares += c.shares - offsets[i].shares;
+    stats.valids += c.valids - offsets[i].valids;
+    if (c.generation == generation && c.best_diff > stats.best_diff)
+      stats.best_diff = c.best_diff;
+  }
+
+  stats.templates += templates;
+  stats.timestamp = esp_timer_get_time();
+  stats.upTime += stats.timestamp / 1000000;
+  return stats;
+}
+
+/// @brief Add the totals saved in NVS to the counters of this session.
+void statsRestore(const miner_stats *saved)
+{
+  portENTER_CRITICAL(&baseMux);
+  baseSeq++;
+  __sync_synchronize();
+  base.hashes = saved->hashes;
+  base.shares = saved->shares;
+  base.valids = saved->valids;
+  base.templates = saved->templates;
+  base.best_diff = saved->best_diff;
+  base.upTime = saved->upTime;
+  __sync_synchronize();
+  baseSeq++;
+  portEXIT_CRITICAL(&baseMux);
+}
+
+void statsReset(void)
+{
+  worker_counters current[STATS_MAX_WORKERS];
+  for (uint8_t i = 0; i < STATS_MAX_WORKERS; i++)
+    readSlot(i, &current[i]);
+
+  portENTER_CRITICAL(&baseMux);
+  baseSeq++;
+  __sync_synchronize();
+  memset(&base, 0, sizeof(base));
+  memcpy(resetOffset, current, sizeof(resetOffset));
+  templates = 0;
+  generation++;
+  __sync_synchronize();
+  baseSeq++;
+  portEXIT_CRITICAL(&baseMux);
+}
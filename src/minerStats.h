@@ -0,0 +1,48 @@
+#ifndef MINER_STATS_H
+#define MINER_STATS_H
+
+#include <Arduino.h>
+
+// Mining counters
+// Every miner task counts in a private struct and publishes it into its own
+// cache aligned slot every STATS_HASH_BATCH nonces (and at the end of a job).
+// Each slot is guarded by a seqlock with a single writer, so readers on the
+// other core (monitor, web server, NVS saver, fleet beacon) get exact and
+// consistent totals without the hot loop touching shared memory per hash.
+
+#define STATS_MAX_WORKERS   2
+#define STATS_HASH_BATCH    4096    // Nonces hashed between two publishes
+#define STATS_CACHE_LINE    64
+
+typedef struct {
+  uint64_t hashes;
+  uint32_t shares;          // 32 bit shares
+  uint32_t valids;          // Valid blocks
+  double best_diff;
+  uint32_t generation;      // Bumped by statsReset()
+} worker_counters;
+
+typedef struct {
+  uint64_t hashes;          // Exact total, including the restored stats
+  uint32_t shares;
+  uint32_t valids;
+  uint32_t templates;
+  double best_diff;
+  uint64_t upTime;          // Seconds, including the restored stats
+  int64_t timestamp;        // esp_timer_get_time() of the snapshot
+} miner_stats;
+
+// Miner tasks
+void statsWorkerBegin(uint8_t worker, worker_counters *local);
+void statsWorkerPublish(uint8_t worker, worker_counters *local);
+void statsAddTemplate(void);
+
+// Readers, safe from any task
+miner_stats getMinerStats(void);
+void getWorkerCounters(uint8_t worker, worker_counters *out);
+
+// Persistence
+void statsRestore(const miner_stats *saved);
+void statsReset(void);
+
+#endif // MINER_STATS_H
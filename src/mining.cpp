@@ -2,40 +2,35 @@
 #include <ArduinoJson.h>
 #include <WiFi.h>
 #include <esp_task_wdt.h>
-#include <nvs_flash.h>
-#include <nvs.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 #include "ShaTests/nerdSHA256plus.h"
 #include "stratum.h"
+#include "stratumProxy.h"
 #include "mining.h"
+#include "minerStats.h"
+#include "hashrate.h"
 #include "utils.h"
 #include "monitor.h"
 #include "timeconst.h"
+#include "renderBudget.h"
+#include "statsStore.h"
+#include "history.h"
+#include "journal.h"
+#include "fastBoot.h"
 #include "drivers/displays/display.h"
 #include "drivers/storage/storage.h"
 
 // Constants
 #define MIN_HASHRATE 50  // KH/s
-#define DELAY 100
-#define REDRAW_EVERY 10
-
-// Global variables
-nvs_handle_t stat_handle;
-
-uint32_t templates = 0;
-uint32_t hashes = 0;
-uint32_t Mhashes = 0;
-uint32_t totalKHashes = 0;
-uint32_t elapsedKHs = 0;
-uint64_t upTime = 0;
-
-uint32_t shares; // increase if blockhash has 32 bits of zeroes
-uint32_t valids; // increased if blockhash <= target
-
-// Track best diff
-double best_diff = 0.0;
+#define FRAME_STATS_EVERY 60   // Redraws between two worst frame time reports
+#ifdef STRATUM_PROXY
+#define STRATUM_LOOP_DELAY 50   // Forward downstream shares quickly
+#else
+#define STRATUM_LOOP_DELAY 500
+#endif
 
 // Variables to hold data from custom textboxes
-//Track mining stats in non volatile memory
 extern TSettings Settings;
 
 IPAddress serverIP(1, 1, 1, 1); //Temporally save poolIPaddres
@@ -49,14 +44,21 @@ monitor_data mMonitor;
 bool isMinerSuscribed = false;
 unsigned long mLastTXtoPool = millis();
 unsigned long mStart0Hashrate = 0; // Variable for tracking inactivity periods
-
-int saveIntervals[7] = {5 * 60, 15 * 60, 30 * 60, 1 * 3600, 3 * 3600, 6 * 3600, 12 * 3600};
-int saveIntervalsSize = sizeof(saveIntervals)/sizeof(saveIntervals[0]);
-int currentIntervalIndex = 0;
+unsigned long mLastJob = 0; // millis() of the last mining.notify, 0 before the first job
+
+// Pool settings saved from the web page, the stratum task applies them and resubscribes.
+// The lock also guards the pool fields of Settings, other tasks copy them with getPoolSettings()
+static SemaphoreHandle_t reloadLock = xSemaphoreCreateMutex();
+static volatile bool stratumStarted = false;
+static volatile bool reloadRequested = false;
+static String reloadAddress;
+static int reloadPort = 0;
+static char reloadWallet[sizeof(Settings.BtcWallet)];
+static char reloadPassword[sizeof(Settings.PoolPassword)];
+// Set while the miners keep hashing the job of the previous pool, their shares aren't sent
+static volatile bool poolSwitching = false;
 
 // Forward declarations
-void restoreStat();
-void saveStat();
 void resetStat();
 bool checkPoolConnection(void);
 bool checkPoolInactivity(unsigned int keepAliveTime, unsigned long inactivityTime);
@@ -65,41 +67,58 @@ void runMiner(void * task_id);
 void runMonitor(void *name);
 
 // Function implementations
-void restoreStat() {
-  if(!Settings.saveStats) return;
-  esp_err_t ret = nvs_flash_init();
-  if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-    Serial.printf("[MONITOR] NVS partition is full or has invalid version, erasing...\n");
-    nvs_flash_init();
-  }
-
-  ret = nvs_open("state", NVS_READWRITE, &stat_handle);
+void resetStat() {
+  Serial.printf("[MONITOR] Resetting NVS stats\n");
+  statsReset();
+  statsStoreSave();
+}
 
-  size_t required_size = sizeof(double);
-  nvs_get_blob(stat_handle, "best_diff", &best_diff, &required_size);
-  nvs_get_u32(stat_handle, "Mhashes", &Mhashes);
-  nvs_get_u32(stat_handle, "shares", &shares);
-  nvs_get_u32(stat_handle, "valids", &valids);
-  nvs_get_u32(stat_handle, "templates", &templates);
-  nvs_get_u64(stat_handle, "upTime", &upTime);
+/// @brief Hands new pool settings to the stratum task, hashing goes on until the new pool sends a job
+void requestPoolReload(const String &address, int port, const char *wallet, const char *password) {
+  xSemaphoreTake(reloadLock, portMAX_DELAY);
+  if (!stratumStarted) {
+    Settings.PoolAddress = address;
+    Settings.PoolPort = port;
+    strlcpy(Settings.BtcWallet, wallet, sizeof(Settings.BtcWallet));
+    strlcpy(Settings.PoolPassword, password, sizeof(Settings.PoolPassword));
+    xSemaphoreGive(reloadLock);
+    return;
+  }
+  reloadAddress = address;
+  reloadPort = port;
+  strlcpy(reloadWallet, wallet, sizeof(reloadWallet));
+  strlcpy(reloadPassword, password, sizeof(reloadPassword));
+  reloadRequested = true;
+  xSemaphoreGive(reloadLock);
 }
 
-void saveStat() {
-  if(!Settings.saveStats) return;
-  Serial.printf("[MONITOR] Saving stats\n");
-  nvs_set_blob(stat_handle, "best_diff", &best_diff, sizeof(double));
-  nvs_set_u32(stat_handle, "Mhashes", Mhashes);
-  nvs_set_u32(stat_handle, "shares", shares);
-  nvs_set_u32(stat_handle, "valids", valids);
-  nvs_set_u32(stat_handle, "templates", templates);
-  nvs_set_u64(stat_handle, "upTime", upTime + (esp_timer_get_time()/1000000));
+pool_settings getPoolSettings(void) {
+  pool_settings pool;
+  xSemaphoreTake(reloadLock, portMAX_DELAY);
+  pool.address = Settings.PoolAddress;
+  pool.port = Settings.PoolPort;
+  strlcpy(pool.wallet, Settings.BtcWallet, sizeof(pool.wallet));
+  strlcpy(pool.password, Settings.PoolPassword, sizeof(pool.password));
+  xSemaphoreGive(reloadLock);
+  return pool;
 }
 
-void resetStat() {
-  Serial.printf("[MONITOR] Resetting NVS stats\n");
-  templates = hashes = Mhashes = totalKHashes = elapsedKHs = upTime = shares = valids = 0;
-  best_diff = 0.0;
-  saveStat();
+// Stratum task: the pool settings only change here while it runs, so its own code reads them without the lock
+static void applyPoolReload(void) {
+  xSemaphoreTake(reloadLock, portMAX_DELAY);
+  Settings.PoolAddress = reloadAddress;
+  Settings.PoolPort = reloadPort;
+  strcpy(Settings.BtcWallet, reloadWallet);
+  strcpy(Settings.PoolPassword, reloadPassword);
+  reloadRequested = false;
+  xSemaphoreGive(reloadLock);
+
+  Serial.printf("[WORKER] Pool settings changed, resubscribing to %s:%d\n", Settings.PoolAddress.c_str(), Settings.PoolPort);
+  journalEvent(JOURNAL_POOL, "settings changed, resubscribing to %s:%d worker=%s", Settings.PoolAddress.c_str(), Settings.PoolPort, Settings.BtcWallet);
+  client.stop();
+  isMinerSuscribed = false;
+  serverIP = IPAddress(1, 1, 1, 1);   // Resolve the new address
+  poolSwitching = mMiner.inRun;
 }
 
 bool checkPoolConnection(void) {
@@ -113,29 +132,34 @@ bool checkPoolConnection(void) {
 
   Serial.println("Client not connected, trying to connect..."); 
   
-  //Resolve first time pool DNS and save IP
+  //Resolve first time pool DNS and save IP, the IP of the last boot saves the lookup
   if(serverIP == IPAddress(1,1,1,1)) {
-    WiFi.hostByName(Settings.PoolAddress.c_str(), serverIP);
-    Serial.printf("Resolved DNS and save ip (first time) got: %s\n", serverIP.toString());
+    if(fastBootPoolIp(serverIP)) {
+      Serial.printf("Using the pool ip of the last boot: %s\n", serverIP.toString().c_str());
+    } else {
+      WiFi.hostByName(Settings.PoolAddress.c_str(), serverIP);
+      Serial.printf("Resolved DNS and save ip (first time) got: %s\n", serverIP.toString());
+    }
   }
 
   //Try connecting pool IP
   if (!client.connect(serverIP, Settings.PoolPort)) {
     Serial.println("Imposible to connect to : " + Settings.PoolAddress);
+    journalEvent(JOURNAL_POOL, "connect failed %s:%d", Settings.PoolAddress.c_str(), Settings.PoolPort);
     WiFi.hostByName(Settings.PoolAddress.c_str(), serverIP);
     Serial.printf("Resolved DNS got: %s\n", serverIP.toString());
     vTaskDelay(1000 / portTICK_PERIOD_MS);
     return false;
   }
 
+  journalEvent(JOURNAL_POOL, "connected %s:%d (%s)", Settings.PoolAddress.c_str(), Settings.PoolPort, serverIP.toString().c_str());
+  fastBootSavePool(serverIP);
+  bootMark(BOOT_POOL_CONNECTED);
   return true;
 }
 
 bool checkPoolInactivity(unsigned int keepAliveTime, unsigned long inactivityTime){ 
 
-    unsigned long currentKHashes = (Mhashes*1000) + hashes/1000;
-    unsigned long elapsedKHs = currentKHashes - totalKHashes; 
-
     // If no shares sent to pool
     // send something to pool to hold socket oppened
     if(millis() - mLastTXtoPool > keepAliveTime){
@@ -149,7 +173,7 @@ bool checkPoolInactivity(unsigned int keepAliveTime, unsigned long inactivityTim
       }*/
     }
 
-    if(elapsedKHs == 0){
+    if(getHashrate().current == 0){
       //Check if hashrate is 0 during inactivityTIme
       if(mStart0Hashrate == 0) mStart0Hashrate  = millis(); 
       if((millis()-mStart0Hashrate) > inactivityTime) { mStart0Hashrate=0; return true;}
@@ -174,8 +198,13 @@ void runStratumWorker(void *name) {
   // connect to pool
   
   double currentPoolDifficulty = DEFAULT_DIFFICULTY;
+  xSemaphoreTake(reloadLock, portMAX_DELAY);
+  stratumStarted = true;
+  xSemaphoreGive(reloadLock);
 
   while(true) {
+
+    if(reloadRequested) applyPoolReload();
       
     if(WiFi.status() != WL_CONNECTED){
       // WiFi is disconnected, so reconnect now
@@ -195,12 +224,13 @@ void runStratumWorker(void *name) {
     }
 
     if(!isMinerSuscribed){
-      //Stop miner current jobs
-      mMiner.inRun = false;
+      //Stop miner current jobs, unless they keep hashing while switching pools
+      if(!poolSwitching) mMiner.inRun = false;
       mWorker = init_mining_subscribe();
 
       // STEP 1: Pool server connection (SUBSCRIBE)
       if(!tx_mining_subscribe(client, mWorker)) { 
+        journalEvent(JOURNAL_POOL, "subscribe failed");
         client.stop();
         continue; 
       }
@@ -215,6 +245,9 @@ void runStratumWorker(void *name) {
 
       isMinerSuscribed = true;
       mLastTXtoPool = millis();
+      proxy_attach_upstream(mWorker);
+      journalEvent(JOURNAL_POOL, "subscribed extranonce1=%s worker=%s", mWorker.extranonce1.c_str(), mWorker.wName);
+      bootMark(BOOT_SUBSCRIBED);
       mMonitor.NerdStatus = NM_Connected; // Set status to connected after successful subscription
     }
 
@@ -222,6 +255,7 @@ void runStratumWorker(void *name) {
     if(checkPoolInactivity(KEEPALIVE_TIME_ms, POOLINACTIVITY_TIME_ms)){
       //Restart connection
       Serial.println("  Detected more than 2 min without data form stratum server. Closing socket and reopening...");
+      journalEvent(JOURNAL_POOL, "no hashrate for %d s, reconnecting", POOLINACTIVITY_TIME_ms / 1000);
       client.stop();
       isMinerSuscribed=false;
       continue; 
@@ -232,34 +266,47 @@ void runStratumWorker(void *name) {
 
       Serial.println("  Received message from pool");
       String line = client.readStringUntil('\n');
+      if(proxy_on_response(line)) continue; //Answer for a share sent by a LAN miner
       stratum_method result = parse_mining_method(line);
       switch (result)
       {
-          case STRATUM_PARSE_ERROR:   Serial.println("  Parsed JSON: error on JSON"); break;
-          case MINING_NOTIFY:         if(parse_mining_notify(line, mJob)){
+          case STRATUM_PARSE_ERROR:   Serial.println("  Parsed JSON: error on JSON");
+                                      journalEvent(JOURNAL_RESULT, "%s", line.c_str());
+                                      break;
+          case MINING_NOTIFY:         proxy_on_notify(line);
+                                      if(parse_mining_notify(line, mJob)){
                                           //Increse templates readed
-                                          templates++;
+                                          statsAddTemplate();
+                                          mLastJob = millis();
+                                          bootMark(BOOT_FIRST_JOB);
                                           //Stop miner current jobs
                                           mMiner.inRun = false;
+                                          poolSwitching = false;
                                           //Prepare data for new jobs
                                           mMiner=calculateMiningData(mWorker,mJob);
-                                          mMiner.poolDifficulty = currentPoolDifficulty;
+                                          setPoolTarget(mMiner, currentPoolDifficulty);
                                           mMiner.newJob = true;
                                           mMiner.newJob2 = true;
                                           //Give new job to miner
 
                                       }
                                       break;
-          case MINING_SET_DIFFICULTY: parse_mining_set_difficulty(line, currentPoolDifficulty);
-                                      mMiner.poolDifficulty = currentPoolDifficulty;
+          case MINING_SET_DIFFICULTY: proxy_on_set_difficulty(line);
+                                      parse_mining_set_difficulty(line, currentPoolDifficulty);
+                                      setPoolTarget(mMiner, currentPoolDifficulty);
+                                      break;
+          case STRATUM_SUCCESS:       Serial.println("  Parsed JSON: Success");
+                                      journalEvent(JOURNAL_RESULT, "%s", line.c_str());
                                       break;
-          case STRATUM_SUCCESS:       Serial.println("  Parsed JSON: Success"); break;
           default:                    Serial.println("  Parsed JSON: unknown"); break;
 
       }
     }
 
-    vTaskDelay(500 / portTICK_PERIOD_MS); //Small delay
+    //Forward shares found by LAN miners
+    proxy_flush_submits(client, mWorker);
+
+    vTaskDelay(STRATUM_LOOP_DELAY / portTICK_PERIOD_MS); //Small delay
     
   }
   
@@ -271,6 +318,10 @@ void runMiner(void * task_id) {
 
   Serial.printf("[MINER]  %d  Started runMiner Task!\n", miner_id);
 
+  // Counters owned by this task, published every STATS_HASH_BATCH nonces
+  worker_counters local;
+  statsWorkerBegin(miner_id, &local);
+
   while(1){
 
     //Wait new job
@@ -290,7 +341,11 @@ void runMiner(void * task_id) {
 
     //Prepare Premining data
     nerdSHA256_context nerdMidstate; //NerdShaplus
-    uint8_t hash[32];
+    uint8_t hash[32] __attribute__((aligned(4)));
+    const uint32_t *hash32 = (const uint32_t *)hash;
+    double bestKnown = getMinerStats().best_diff;
+    int bestZeros = zerosForDiff(bestKnown); // Zeros needed to beat best diff
+    uint32_t batch = 0;
     
 
     //Calcular midstate
@@ -313,10 +368,10 @@ void runMiner(void * task_id) {
     
     bool is16BitShare=true;  
     Serial.println(">>> STARTING TO HASH NONCES");
+    bootMark(BOOT_FIRST_HASH);
     
     // Track hashrate for low hashrate detection
     unsigned long lastHashCheck = millis();
-    unsigned long lastHashCount = hashes;
     
     while(true) {
       if (miner_id == 0)
@@ -326,18 +381,20 @@ void runMiner(void * task_id) {
 
       is16BitShare=nerd_sha256d(&nerdMidstate, header64, hash); //Boosted 80Khs sha
 
-      hashes++;
-      
-      // Check hashrate every 30 seconds
-      if (millis() - lastHashCheck >= 30000) {
-        unsigned long hashRate = (hashes - lastHashCount) / 30; // Hashes per second
-        if (hashRate < MIN_HASHRATE) {
-          mMonitor.NerdStatus = NM_lowHashrate;
-        } else if (mMonitor.NerdStatus == NM_lowHashrate) {
-          mMonitor.NerdStatus = NM_hashing; // Only change back if we were in low hashrate state
+      if (++batch == STATS_HASH_BATCH) {
+        local.hashes += batch;
+        batch = 0;
+        statsWorkerPublish(miner_id, &local);
+
+        // Check hashrate every 30 seconds, the estimator reports H/s
+        if (millis() - lastHashCheck >= 30000) {
+          if (getHashrate().avg1m < MIN_HASHRATE * 1000.0f) {
+            mMonitor.NerdStatus = NM_lowHashrate;
+          } else if (mMonitor.NerdStatus == NM_lowHashrate) {
+            mMonitor.NerdStatus = NM_hashing; // Only change back if we were in low hashrate state
+          }
+          lastHashCheck = millis();
         }
-        lastHashCheck = millis();
-        lastHashCount = hashes;
       }
 
       if (nonce > TARGET_NONCE) break; //exit
@@ -352,16 +409,25 @@ void runMiner(void * task_id) {
         continue;
       }
 
-      double diff_hash = diff_from_target(hash);
-
-      // update best diff
-      if (diff_hash > best_diff)
-        best_diff = diff_hash;
+      // only compute the float difficulty when it could be a new best
+      int zeros = leadingZeros256(hash32);
+      if (zeros >= bestZeros) {
+        double diff_hash = diff_from_target(hash);
+        if (diff_hash > local.best_diff) {
+          local.best_diff = diff_hash;
+          statsWorkerPublish(miner_id, &local);
+        }
+        if (diff_hash > bestKnown) bestKnown = diff_hash;
+        bestZeros = zerosForDiff(bestKnown);
+      }
 
-      if(diff_hash > mMiner.poolDifficulty) {
+      // A share of the previous pool's job would only be rejected by the new one
+      if(hashMeetsTarget(hash32, mMiner.pool_target) && !poolSwitching) {
         mMonitor.NerdStatus = NM_foundShare;
         tx_mining_submit(client, mWorker, mJob, nonce);
-        Serial.print("   - Current diff share: "); Serial.println(diff_hash,12);
+        journalEvent(JOURNAL_SHARE, "miner=%u job=%s extranonce2=%s ntime=%s nonce=%08lx diff=%.4f pool=%.4f", miner_id,
+                     mJob.job_id.c_str(), mWorker.extranonce2.c_str(), mJob.ntime.c_str(), nonce, diff_from_target(hash), mMiner.poolDifficulty);
+        Serial.print("   - Current diff share: "); Serial.println(diff_from_target(hash),12);
         Serial.print("   - Current pool diff : "); Serial.println(mMiner.poolDifficulty,12);
         Serial.print("   - TX SHARE: ");
         for (size_t i = 0; i < 32; i++)
@@ -382,16 +448,16 @@ void runMiner(void * task_id) {
       }
       
       // check if 32bit share
-      if(hash[29] !=0 || hash[28] !=0) {
+      if(hash32[7] != 0) {
         nonce += 2;
         continue;
       }
-      shares++;
+      local.shares++;
 
       // check if valid header
-      if(checkValid(hash, mMiner.bytearray_target)){
+      if(hashMeetsTarget(hash32, mMiner.net_target)){
         Serial.printf("[WORKER] %d CONGRATULATIONS! Valid block found with nonce: %d | 0x%x\n", miner_id, nonce, nonce);
-        valids++;
+        local.valids++;
         Serial.printf("[WORKER]  %d  Submitted work valid!\n", miner_id);
         break;
       }
@@ -401,10 +467,8 @@ void runMiner(void * task_id) {
     mMiner.inRun = false;
     Serial.print(">>> Finished job waiting new data from pool");
 
-    if(hashes>=MAX_NONCE_STEP) {
-      Mhashes=Mhashes+MAX_NONCE_STEP/1000000;
-      hashes=hashes-MAX_NONCE_STEP;
-    }
+    local.hashes += batch;
+    statsWorkerPublish(miner_id, &local);
 
     uint32_t duration = micros() - startT;
     if (esp_task_wdt_reset() == ESP_OK)
@@ -416,7 +480,8 @@ void runMonitor(void *name)
 {
 
   Serial.println("[MONITOR] started");
-  restoreStat();
+  statsStoreRestore();
+  setupHistory();
 
   unsigned long mLastCheck = 0;
 
@@ -424,24 +489,42 @@ void runMonitor(void *name)
 
   unsigned long frame = 0;
 
-  uint32_t seconds_elapsed = 0;
+  bool wasDisplayOn = true;
 
-  totalKHashes = (Mhashes * 1000) + hashes / 1000;;
+  uint32_t redraws = 0;
+  int64_t worstFrameUs = 0;
+  uint32_t frameAllocs = 0;
+  size_t minLargestBlock = SIZE_MAX;
 
   while (1)
   {
-    if ((frame % REDRAW_EVERY) == 0)
+    int64_t tickStart = esp_timer_get_time();
+    bool displayOn = isDisplayOn();
+    // Redraw at once when the display comes back on
+    bool redraw = (millis() - mLastCheck >= renderRedrawMs()) || (displayOn && !wasDisplayOn);
+    wasDisplayOn = displayOn;
+
+    if (redraw)
     {
       unsigned long mElapsed = millis() - mLastCheck;
       mLastCheck = millis();
-      unsigned long currentKHashes = (Mhashes * 1000) + hashes / 1000;
-      elapsedKHs = currentKHashes - totalKHashes;
-      totalKHashes = currentKHashes;
-
+      int64_t frameStart = esp_timer_get_time();
+      heapAllocsBegin();
       drawCurrentScreen(mElapsed);
+      frameAllocs += heapAllocsEnd();
+      worstFrameUs = max(worstFrameUs, esp_timer_get_time() - frameStart);
+      if (++redraws % FRAME_STATS_EVERY == 0) {
+        // Largest free block over the whole uptime shows heap fragmentation on long runs
+        size_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        minLargestBlock = min(minLargestBlock, largestBlock);
+        Serial.printf("[MONITOR] worst frame time %lld us, %u heap allocs over the last %d redraws. Largest free block %u (min %u)\n",
+                      worstFrameUs, frameAllocs, FRAME_STATS_EVERY, largestBlock, minLargestBlock);
+        worstFrameUs = 0;
+        frameAllocs = 0;
+      }
 
       // Monitor state when hashrate is 0.0
-      if (elapsedKHs == 0)
+      if (getHashrate().current == 0)
       {
         Serial.printf(">>> [i] Miner: newJob>%s / inRun>%s) - Client: connected>%s / subscribed>%s / wificonnected>%s\n",
             mMiner.newJob ? "true" : "false", mMiner.inRun ? "true" : "false",
@@ -453,19 +536,14 @@ void runMonitor(void *name)
       Serial.printf("### Max stack usage: %d\n", uxTaskGetStackHighWaterMark(NULL));
       #endif
 
-      seconds_elapsed++;
-
-      if(seconds_elapsed % (saveIntervals[currentIntervalIndex]) == 0){
-        saveStat();
-        seconds_elapsed = 0;
-        if(currentIntervalIndex < saveIntervalsSize - 1)
-          currentIntervalIndex++;
-      }    
+      statsStoreUpdate();
+      historyUpdate();
     }
     animateCurrentScreen(frame);
     doLedStuff(frame);
+    renderAccount(esp_timer_get_time() - tickStart, displayOn);
 
-    vTaskDelay(DELAY / portTICK_PERIOD_MS);
+    vTaskDelay(renderTickMs() / portTICK_PERIOD_MS);
     frame++;
   }
 }
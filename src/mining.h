@@ -2,6 +2,9 @@
 #ifndef MINING_API_H
 #define MINING_API_H
 
+#include <Arduino.h>
+#include "settings.h"
+
 // Mining
 #define MAX_NONCE_STEP  5000000U
 #define MAX_NONCE       25000000U
@@ -18,10 +21,22 @@ void runMiner(void *name);
 String printLocalTime(void);
 
 void resetStat();
+void requestPoolReload(const String &address, int port, const char *wallet, const char *password);
+
+typedef struct {
+  String address;
+  int port;
+  char wallet[sizeof(TSettings::BtcWallet)];
+  char password[sizeof(TSettings::PoolPassword)];
+} pool_settings;
+
+// Copy of the pool settings for tasks other than the stratum one, which reassigns them on a reload
+pool_settings getPoolSettings(void);
 
 typedef struct{
   uint8_t bytearray_target[32];
-  uint8_t bytearray_pooltarget[32];
+  uint32_t pool_target[8];   // From poolDifficulty, little endian words
+  uint32_t net_target[8];    // From nbits, little endian words
   uint8_t merkle_result[32];
   uint8_t bytearray_blockheader[80];
   uint8_t bytearray_blockheader2[80];
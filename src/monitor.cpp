@@ -1,25 +1,16 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include "mbedtls/md.h"
-#include "HTTPClient.h"
 #include <NTPClient.h>
 #include <WiFiUdp.h>
 #include "mining.h"
 #include "utils.h"
 #include "monitor.h"
+#include "minerStats.h"
+#include "hashrate.h"
+#include "fetcher.h"
 #include "drivers/storage/storage.h"
 
-extern uint32_t templates;
-extern uint32_t hashes;
-extern uint32_t Mhashes;
-extern uint32_t totalKHashes;
-extern uint32_t elapsedKHs;
-extern uint64_t upTime;
-
-extern uint32_t shares; // increase if blockhash has 32 bits of zeroes
-extern uint32_t valids; // increased if blockhash <= targethalfshares
-
-extern double best_diff; // track best diff
 
 extern monitor_data mMonitor;
 
@@ -29,11 +20,7 @@ bool invertColors = false;
 
 WiFiUDP ntpUDP;
 NTPClient timeClient(ntpUDP, "europe.pool.ntp.org", 3600, 60000);
-unsigned int bitcoin_price=0;
-String current_block = "793261";
-global_data gData;
 pool_data pData;
-String poolAPIUrl;
 
 
 void setup_monitor(void){
@@ -47,223 +34,108 @@ void setup_monitor(void){
 
     Serial.println("TimeClient setup done");
 #ifdef NERDMINER_T_HMI
-    poolAPIUrl = getPoolAPIUrl();
-    Serial.println("poolAPIUrl: " + poolAPIUrl);
+    Serial.println("poolAPIUrl: " + getPoolAPIUrl(getPoolSettings()));
 #endif
 }
 
-unsigned long mGlobalUpdate =0;
-
-void updateGlobalData(void){
-    
-    if((mGlobalUpdate == 0) || (millis() - mGlobalUpdate > UPDATE_Global_min * 60 * 1000)){
-    
-        if (WiFi.status() != WL_CONNECTED) return;
-            
-        //Make first API call to get global hash and current difficulty
-        HTTPClient http;
-        try {
-        http.begin(getGlobalHash);
-        int httpCode = http.GET();
-
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = http.getString();
-            
-            DynamicJsonDocument doc(1024);
-            deserializeJson(doc, payload);
-            String temp = "";
-            if (doc.containsKey("currentHashrate")) temp = String(doc["currentHashrate"].as<float>());
-            if(temp.length()>18 + 3) //Exahashes more than 18 digits + 3 digits decimals
-              gData.globalHash = temp.substring(0,temp.length()-18 - 3);
-            if (doc.containsKey("currentDifficulty")) temp = String(doc["currentDifficulty"].as<float>());
-            if(temp.length()>10 + 3){ //Terahash more than 10 digits + 3 digit decimals
-              temp = temp.substring(0,temp.length()-10 - 3);
-              gData.difficulty = temp.substring(0,temp.length()-2) + "." + temp.substring(temp.length()-2,temp.length()) + "T";
-            }
-            doc.clear();
-
-            mGlobalUpdate = millis();
-        }
-        http.end();
-
-      
-        //Make third API call to get fees
-        http.begin(getFees);
-        httpCode = http.GET();
-
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = http.getString();
-            
-            DynamicJsonDocument doc(1024);
-            deserializeJson(doc, payload);
-            String temp = "";
-            if (doc.containsKey("halfHourFee")) gData.halfHourFee = doc["halfHourFee"].as<int>();
-#ifdef NERDMINER_T_HMI
-            if (doc.containsKey("fastestFee"))  gData.fastestFee = doc["fastestFee"].as<int>();
-            if (doc.containsKey("hourFee"))     gData.hourFee = doc["hourFee"].as<int>();
-            if (doc.containsKey("economyFee"))  gData.economyFee = doc["economyFee"].as<int>();
-            if (doc.containsKey("minimumFee"))  gData.minimumFee = doc["minimumFee"].as<int>();
-#endif
-            doc.clear();
-
-            mGlobalUpdate = millis();
-        }
-        
-        http.end();
-        } catch(...) {
-          http.end();
-        }
-    }
-}
-
-unsigned long mHeightUpdate = 0;
-
-String getBlockHeight(void){
-    
-    if((mHeightUpdate == 0) || (millis() - mHeightUpdate > UPDATE_Height_min * 60 * 1000)){
-    
-        if (WiFi.status() != WL_CONNECTED) return current_block;
-            
-        HTTPClient http;
-        try {
-        http.begin(getHeightAPI);
-        int httpCode = http.GET();
-
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = http.getString();
-            payload.trim();
-
-            current_block = payload;
-
-            mHeightUpdate = millis();
-        }        
-        http.end();
-        } catch(...) {
-          http.end();
-        }
-    }
-  
-  return current_block;
-}
-
-unsigned long mBTCUpdate = 0;
-
-String getBTCprice(void){
-    
-    if((mBTCUpdate == 0) || (millis() - mBTCUpdate > UPDATE_BTC_min * 60 * 1000)){
-    
-        if (WiFi.status() != WL_CONNECTED) return (String(bitcoin_price) + "$");
-        
-        HTTPClient http;
-        try {
-        http.begin(getBTCAPI);
-        int httpCode = http.GET();
-
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = http.getString();
-
-            DynamicJsonDocument doc(1024);
-            deserializeJson(doc, payload);
-            if (doc.containsKey("last_trade_price")) bitcoin_price = doc["last_trade_price"];
-
-            doc.clear();
-
-            mBTCUpdate = millis();
-        }
-        
-        http.end();
-        } catch(...) {
-          http.end();
-        }
-    }
-  
-  return (String(bitcoin_price) + "$");
-}
-
 unsigned long mTriggerUpdate = 0;
 unsigned long initialMillis = millis();
 unsigned long initialTime = 0;
-unsigned long mPoolUpdate = 0;
+static portMUX_TYPE timeMux = portMUX_INITIALIZER_UNLOCKED;
 
-void getTime(unsigned long* currentHours, unsigned long* currentMinutes, unsigned long* currentSeconds){
-  
+/// @brief NTP refresh, called by the fetch task so no screen ever waits on the UDP round trip
+void updateTime(void){
   //Check if need an NTP call to check current time
-  if((mTriggerUpdate == 0) || (millis() - mTriggerUpdate > UPDATE_PERIOD_h * 60 * 60 * 1000)){ //60 sec. * 60 min * 1000ms
-    if(WiFi.status() == WL_CONNECTED) {
-        if(timeClient.update()) mTriggerUpdate = millis(); //NTP call to get current time
-        initialTime = timeClient.getEpochTime(); // Guarda la hora inicial (en segundos desde 1970)
-        Serial.print("TimeClient NTPupdateTime ");
-    }
-  }
+  if((mTriggerUpdate != 0) && (millis() - mTriggerUpdate <= UPDATE_PERIOD_h * 60 * 60 * 1000)) return; //60 sec. * 60 min * 1000ms
+  if(!timeClient.update()) return; //NTP call to get current time
+
+  portENTER_CRITICAL(&timeMux);
+  mTriggerUpdate = millis();
+  initialTime = timeClient.getEpochTime(); // Guarda la hora inicial (en segundos desde 1970)
+  portEXIT_CRITICAL(&timeMux);
+  Serial.println("TimeClient NTPupdateTime");
+}
 
+// Local time in seconds, the seconds since boot until NTP answered once
+static unsigned long currentTime(void){
+  portENTER_CRITICAL(&timeMux);
   unsigned long elapsedTime = (millis() - mTriggerUpdate) / 1000; // Tiempo transcurrido en segundos
-  unsigned long currentTime = initialTime + elapsedTime; // La hora actual
+  unsigned long now = initialTime + elapsedTime; // La hora actual
+  portEXIT_CRITICAL(&timeMux);
+  return now;
+}
+
+void getTime(unsigned long* currentHours, unsigned long* currentMinutes, unsigned long* currentSeconds){
+  unsigned long now = currentTime();
 
   // convierte la hora actual en horas, minutos y segundos
-  *currentHours = currentTime % 86400 / 3600;
-  *currentMinutes = currentTime % 3600 / 60;
-  *currentSeconds = currentTime % 60;
+  *currentHours = now % 86400 / 3600;
+  *currentMinutes = now % 3600 / 60;
+  *currentSeconds = now % 60;
 }
 
-String getDate(){
-  
-  unsigned long elapsedTime = (millis() - mTriggerUpdate) / 1000; // Tiempo transcurrido en segundos
-  unsigned long currentTime = initialTime + elapsedTime; // La hora actual
+/// @brief Local time in seconds since 1970, 0 until NTP answered once
+uint32_t getEpochSeconds(void){
+  if (mTriggerUpdate == 0) return 0;
+  return currentTime();
+}
 
-  // Convierte la hora actual (epoch time) en una estructura tm
-  struct tm *tm = localtime((time_t *)&currentTime);
+/// @brief Applies a new timezone at once, the clock moves without waiting for the next NTP update
+void setTimezone(int timezone){
+  portENTER_CRITICAL(&timeMux);
+  initialTime += 3600L * (timezone - Settings.Timezone);
+  portEXIT_CRITICAL(&timeMux);
+  Settings.Timezone = timezone;
+  timeClient.setTimeOffset(3600 * timezone);
+}
 
-  int year = tm->tm_year + 1900; // tm_year es el número de años desde 1900
-  int month = tm->tm_mon + 1;    // tm_mon es el mes del año desde 0 (enero) hasta 11 (diciembre)
-  int day = tm->tm_mday;         // tm_mday es el día del mes
+void getDate(char *currentDate, size_t size){
+  time_t now = currentTime();
 
-  char currentDate[20];
-  sprintf(currentDate, "%02d/%02d/%04d", tm->tm_mday, tm->tm_mon + 1, tm->tm_year + 1900);
+  // Convierte la hora actual (epoch time) en una estructura tm
+  struct tm tm;
+  gmtime_r(&now, &tm);
 
-  return String(currentDate);
+  snprintf(currentDate, size, "%02d/%02d/%04d", tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900);
 }
 
-String getTime(void){
+void getTime(char *localHour, size_t size){
   unsigned long currentHours, currentMinutes, currentSeconds;
   getTime(&currentHours, &currentMinutes, &currentSeconds);
 
-  char LocalHour[10];
-  sprintf(LocalHour, "%02d:%02d", currentHours, currentMinutes);
-  
-  String mystring(LocalHour);
-  return LocalHour;
+  snprintf(localHour, size, "%02lu:%02lu", currentHours, currentMinutes);
 }
 
-String getCurrentHashRate(unsigned long mElapsed)
+void getCurrentHashRate(char *hashRate, size_t size)
 {
-  return String((1.0 * (elapsedKHs * 1000)) / mElapsed, 2);
+  snprintf(hashRate, size, "%.2f", getHashrate().avg1m / 1000.0);
 }
 
+// The getters below fill a struct on the caller's stack and only read
+// caches, nothing is allocated and no network is waited on while a screen
+// is drawn
+
 mining_data getMiningData(unsigned long mElapsed)
 {
   mining_data data;
+  miner_stats stats = getMinerStats();
 
-  char best_diff_string[16] = {0};
-  suffix_string(best_diff, best_diff_string, 16, 0);
-
-  char timeMining[15] = {0};
-  uint64_t secElapsed = upTime + (esp_timer_get_time() / 1000000);
+  uint64_t secElapsed = stats.upTime;
   int days = secElapsed / 86400;
   int hours = (secElapsed - (days * 86400)) / 3600;               // Number of seconds in an hour
   int mins = (secElapsed - (days * 86400) - (hours * 3600)) / 60; // Remove the number of hours and calculate the minutes.
   int secs = secElapsed - (days * 86400) - (hours * 3600) - (mins * 60);
-  sprintf(timeMining, "%01d  %02d:%02d:%02d", days, hours, mins, secs);
-
-  data.completedShares = shares;
-  data.totalMHashes = Mhashes;
-  data.totalKHashes = totalKHashes;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
-  data.templates = templates;
-  data.bestDiff = best_diff_string;
-  data.timeMining = timeMining;
-  data.valids = valids;
-  data.temp = String(temperatureRead(), 0);
-  data.currentTime = getTime();
+  snprintf(data.timeMining, sizeof(data.timeMining), "%01d  %02d:%02d:%02d", days, hours, mins, secs);
+
+  snprintf(data.completedShares, sizeof(data.completedShares), "%u", stats.shares);
+  snprintf(data.totalMHashes, sizeof(data.totalMHashes), "%u", (uint32_t)(stats.hashes / 1000000));
+  snprintf(data.totalKHashes, sizeof(data.totalKHashes), "%u", (uint32_t)(stats.hashes / 1000));
+  getCurrentHashRate(data.currentHashRate, sizeof(data.currentHashRate));
+  snprintf(data.templates, sizeof(data.templates), "%u", stats.templates);
+  suffix_string(stats.best_diff, data.bestDiff, sizeof(data.bestDiff), 0);
+  snprintf(data.valids, sizeof(data.valids), "%u", stats.valids);
+  snprintf(data.temp, sizeof(data.temp), "%.0f", temperatureRead());
+  getTime(data.currentTime, sizeof(data.currentTime));
 
   return data;
 }
@@ -271,14 +143,16 @@ mining_data getMiningData(unsigned long mElapsed)
 clock_data getClockData(unsigned long mElapsed)
 {
   clock_data data;
+  miner_stats stats = getMinerStats();
+  fetch_cache cache = getFetchCache(FETCH_MASK(FETCH_PRICE) | FETCH_MASK(FETCH_HEIGHT));
 
-  data.completedShares = shares;
-  data.totalKHashes = totalKHashes;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
-  data.btcPrice = getBTCprice();
-  data.blockHeight = getBlockHeight();
-  data.currentTime = getTime();
-  data.currentDate = getDate();
+  snprintf(data.completedShares, sizeof(data.completedShares), "%u", stats.shares);
+  snprintf(data.totalKHashes, sizeof(data.totalKHashes), "%u", (uint32_t)(stats.hashes / 1000));
+  getCurrentHashRate(data.currentHashRate, sizeof(data.currentHashRate));
+  snprintf(data.btcPrice, sizeof(data.btcPrice), "%u$", cache.btcPrice);
+  snprintf(data.blockHeight, sizeof(data.blockHeight), "%lu", cache.blockHeight);
+  getTime(data.currentTime, sizeof(data.currentTime));
+  getDate(data.currentDate, sizeof(data.currentDate));
 
   return data;
 }
@@ -287,8 +161,8 @@ clock_data_t getClockData_t(unsigned long mElapsed)
 {
   clock_data_t data;
 
-  data.valids = valids;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
+  snprintf(data.valids, sizeof(data.valids), "%u", getMinerStats().valids);
+  getCurrentHashRate(data.currentHashRate, sizeof(data.currentHashRate));
   getTime(&data.currentHours, &data.currentMinutes, &data.currentSeconds);
 
   return data;
@@ -297,52 +171,54 @@ clock_data_t getClockData_t(unsigned long mElapsed)
 coin_data getCoinData(unsigned long mElapsed)
 {
   coin_data data;
-
-  updateGlobalData(); // Update gData vars asking mempool APIs
-
-  data.completedShares = shares;
-  data.totalKHashes = totalKHashes;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
-  data.btcPrice = getBTCprice();
-  data.currentTime = getTime();
+  miner_stats stats = getMinerStats();
+  fetch_cache cache = getFetchCache(FETCH_MASK(FETCH_PRICE) | FETCH_MASK(FETCH_HEIGHT) |
+                                    FETCH_MASK(FETCH_GLOBAL) | FETCH_MASK(FETCH_FEES));
+
+  snprintf(data.completedShares, sizeof(data.completedShares), "%u", stats.shares);
+  snprintf(data.totalKHashes, sizeof(data.totalKHashes), "%u", (uint32_t)(stats.hashes / 1000));
+  getCurrentHashRate(data.currentHashRate, sizeof(data.currentHashRate));
+  snprintf(data.btcPrice, sizeof(data.btcPrice), "%u$", cache.btcPrice);
+  getTime(data.currentTime, sizeof(data.currentTime));
 #ifdef NERDMINER_T_HMI
-  data.hourFee = String(gData.hourFee);
-  data.fastestFee = String(gData.fastestFee);
-  data.economyFee = String(gData.economyFee);
-  data.minimumFee = String(gData.minimumFee);
+  snprintf(data.hourFee, sizeof(data.hourFee), "%d", cache.hourFee);
+  snprintf(data.fastestFee, sizeof(data.fastestFee), "%d", cache.fastestFee);
+  snprintf(data.economyFee, sizeof(data.economyFee), "%d", cache.economyFee);
+  snprintf(data.minimumFee, sizeof(data.minimumFee), "%d", cache.minimumFee);
 #endif
-  data.halfHourFee = String(gData.halfHourFee) + " sat/vB";
-  data.netwrokDifficulty = gData.difficulty;
-  data.globalHashRate = gData.globalHash;
-  data.blockHeight = getBlockHeight();
+  snprintf(data.halfHourFee, sizeof(data.halfHourFee), "%d sat/vB", cache.halfHourFee);
+  strlcpy(data.netwrokDifficulty, cache.difficulty, sizeof(data.netwrokDifficulty));
+  strlcpy(data.globalHashRate, cache.globalHash, sizeof(data.globalHashRate));
+  snprintf(data.blockHeight, sizeof(data.blockHeight), "%lu", cache.blockHeight);
 
-  unsigned long currentBlock = data.blockHeight.toInt();
+  unsigned long currentBlock = cache.blockHeight;
   unsigned long remainingBlocks = (((currentBlock / HALVING_BLOCKS) + 1) * HALVING_BLOCKS) - currentBlock;
-  data.progressPercent = (HALVING_BLOCKS - remainingBlocks) * 100 / HALVING_BLOCKS;
-  data.remainingBlocks = String(remainingBlocks) + " BLOCKS";
+  data.progressPercent = (HALVING_BLOCKS - remainingBlocks) * 100.0f / HALVING_BLOCKS;
+  snprintf(data.remainingBlocks, sizeof(data.remainingBlocks), "%lu BLOCKS", remainingBlocks);
 
   return data;
 }
 
-String getPoolAPIUrl(void) {
-    poolAPIUrl = String(getPublicPool);
-    if (Settings.PoolAddress == "public-pool.io") {
+/// @brief API of the pool the miner is on, built on every fetch so a pool switched from the portal is followed
+String getPoolAPIUrl(const pool_settings &pool) {
+    String poolAPIUrl = String(getPublicPool);
+    if (pool.address == "public-pool.io") {
         poolAPIUrl = "https://public-pool.io:40557/api/client/";
     } 
     else {
-        if (Settings.PoolAddress == "nerdminers.org") {
+        if (pool.address == "nerdminers.org") {
             poolAPIUrl = "https://pool.nerdminers.org/users/";
         }
         else {
-            switch (Settings.PoolPort) {
+            switch (pool.port) {
                 case 3333:
-                    if (Settings.PoolAddress == "pool.sethforprivacy.com")
+                    if (pool.address == "pool.sethforprivacy.com")
                         poolAPIUrl = "https://pool.sethforprivacy.com/api/client/";
                     // Add more cases for other addresses with port 3333 if needed
                     break;
                 case 2018:
                     // Local instance of public-pool.io on Umbrel or Start9
-                    poolAPIUrl = "http://" + Settings.PoolAddress + ":2019/api/client/";
+                    poolAPIUrl = "http://" + pool.address + ":2019/api/client/";
                     break;
                 default:
                     poolAPIUrl = String(getPublicPool);
@@ -355,78 +231,11 @@ String getPoolAPIUrl(void) {
 
 pool_data getPoolData(void){
     //pool_data pData;    
-    if((mPoolUpdate == 0) || (millis() - mPoolUpdate > UPDATE_POOL_min * 60 * 1000)){      
-        if (WiFi.status() != WL_CONNECTED) return pData;            
-        //Make first API call to get global hash and current difficulty
-        HTTPClient http;
-        http.setReuse(true);        
-        try {          
-          String btcWallet = Settings.BtcWallet;
-          // Serial.println(btcWallet);
-          if (btcWallet.indexOf(".")>0) btcWallet = btcWallet.substring(0,btcWallet.indexOf("."));
-#ifdef NERDMINER_T_HMI
-          Serial.println("Pool API : " + poolAPIUrl+btcWallet);
-          http.begin(poolAPIUrl+btcWallet);
-#else
-          http.begin(String(getPublicPool)+btcWallet);
-#endif
-          int httpCode = http.GET();
-          if (httpCode == HTTP_CODE_OK) {
-              String payload = http.getString();
-              // Serial.println(payload);
-              StaticJsonDocument<300> filter;
-              filter["bestDifficulty"] = true;
-              filter["workersCount"] = true;
-              filter["workers"][0]["sessionId"] = true;
-              filter["workers"][0]["hashRate"] = true;
-              DynamicJsonDocument doc(2048);
-              deserializeJson(doc, payload, DeserializationOption::Filter(filter));
-              //Serial.println(serializeJsonPretty(doc, Serial));
-              if (doc.containsKey("workersCount")) pData.workersCount = doc["workersCount"].as<int>();
-              const JsonArray& workers = doc["workers"].as<JsonArray>();
-              float totalhashs = 0;
-              for (const JsonObject& worker : workers) {
-                totalhashs += worker["hashRate"].as<double>();
-                /* Serial.print(worker["sessionId"].as<String>()+": ");
-                Serial.print(" - "+worker["hashRate"].as<String>()+": ");
-                Serial.println(totalhashs); */
-              }
-              char totalhashs_s[16] = {0};
-              suffix_string(totalhashs, totalhashs_s, 16, 0);
-              pData.workersHash = String(totalhashs_s);
-
-              double temp;
-              if (doc.containsKey("bestDifficulty")) {
-              temp = doc["bestDifficulty"].as<double>();            
-              char best_diff_string[16] = {0};
-              suffix_string(temp, best_diff_string, 16, 0);
-              pData.bestDifficulty = String(best_diff_string);
-              }
-              doc.clear();
-              mPoolUpdate = millis();
-              Serial.println("\n####### Pool Data OK!");               
-          } else {
-              Serial.println("\n####### Pool Data HTTP Error!");    
-              /* Serial.println(httpCode);
-              String payload = http.getString();
-              Serial.println(payload); */
-              // mPoolUpdate = millis();
-              pData.bestDifficulty = "P";
-              pData.workersHash = "E";
-              pData.workersCount = 0;
-              http.end();
-              return pData; 
-          }
-          http.end();
-        } catch(...) {
-          Serial.println("####### Pool Error!");          
-          // mPoolUpdate = millis();
-          pData.bestDifficulty = "P";
-          pData.workersHash = "Error";
-          pData.workersCount = 0;
-          http.end();
-          return pData;
-        } 
-    }
+    // Always what the pool reports for your address, LAN peers may mine to other
+    // wallets or pools. The fleet totals have their own view, see getFleetData()
+    fetch_cache cache = getFetchCache(FETCH_MASK(FETCH_POOL));
+    pData.workersCount = cache.workersCount;
+    strlcpy(pData.workersHash, cache.workersHash, sizeof(pData.workersHash));
+    strlcpy(pData.bestDifficulty, cache.bestDifficulty, sizeof(pData.bestDifficulty));
     return pData;
 }
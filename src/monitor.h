@@ -2,6 +2,7 @@
 #define MONITOR_API_H
 
 #include <Arduino.h>
+#include "mining.h"
 
 // Monitor states
 #define SCREEN_MINING   0
@@ -50,80 +51,69 @@ typedef struct{
   NMState NerdStatus;
 }monitor_data;
 
-typedef struct{
-  String globalHash; //hexahashes
-  String currentBlock;
-  String difficulty;
-  String blocksHalving;
-  float progressPercent;
-  int remainingBlocks;
-  int halfHourFee;
-#ifdef NERDMINER_T_HMI
-  int fastestFee;
-  int hourFee;
-  int economyFee;
-  int minimumFee;
-#endif
-}global_data;
-
+// Screen data snapshots, already formatted into fixed size buffers so the
+// screens can be drawn without touching the heap
 typedef struct {
-  String completedShares;
-  String totalMHashes;
-  String totalKHashes;
-  String currentHashRate;
-  String templates;
-  String bestDiff;
-  String timeMining;
-  String valids;
-  String temp;
-  String currentTime;
+  char completedShares[12];
+  char totalMHashes[12];
+  char totalKHashes[12];
+  char currentHashRate[12];
+  char templates[12];
+  char bestDiff[16];
+  char timeMining[20];
+  char valids[12];
+  char temp[8];
+  char currentTime[10];
 }mining_data;
 
 typedef struct {
-  String completedShares;
-  String totalKHashes;
-  String currentHashRate;
-  String btcPrice;
-  String blockHeight;
-  String currentTime;  
-  String currentDate;
+  char completedShares[12];
+  char totalKHashes[12];
+  char currentHashRate[12];
+  char btcPrice[16];
+  char blockHeight[12];
+  char currentTime[10];
+  char currentDate[20];
 }clock_data;
 
 typedef struct {
-  String currentHashRate;
-  String valids;
+  char currentHashRate[12];
+  char valids[12];
   unsigned long currentHours;
   unsigned long currentMinutes;
   unsigned long currentSeconds;
 }clock_data_t;
 
 typedef struct {
-  String completedShares;
-  String totalKHashes;
-  String currentHashRate;
-  String btcPrice;
-  String currentTime;
-  String halfHourFee;
+  char completedShares[12];
+  char totalKHashes[12];
+  char currentHashRate[12];
+  char btcPrice[16];
+  char currentTime[10];
+  char halfHourFee[16];
 #ifdef NERDMINER_T_HMI
-  String hourFee;
-  String fastestFee;
-  String economyFee;
-  String minimumFee;
+  char hourFee[8];
+  char fastestFee[8];
+  char economyFee[8];
+  char minimumFee[8];
 #endif
-  String netwrokDifficulty;
-  String globalHashRate;
-  String blockHeight;
+  char netwrokDifficulty[24];
+  char globalHashRate[24];
+  char blockHeight[12];
   float progressPercent;
-  String remainingBlocks;
+  char remainingBlocks[20];
 }coin_data;
 
 typedef struct{
   int workersCount;       // Workers count, how many nerdminers using your address
-  String workersHash;     // Workers Total Hash Rate
-  String bestDifficulty;  // Your miners best difficulty
+  char workersHash[16];   // Workers Total Hash Rate
+  char bestDifficulty[16];// Your miners best difficulty
 }pool_data;
 
 void setup_monitor(void);
+void updateTime(void);
+uint32_t getEpochSeconds(void);
+void setTimezone(int timezone);
 
 mining_data getMiningData(unsigned long mElapsed);
 clock_data getClockData(unsigned long mElapsed);
@@ -131,6 +121,6 @@ coin_data getCoinData(unsigned long mElapsed);
 pool_data getPoolData(void);
 
 clock_data_t getClockData_t(unsigned long mElapsed);
-String getPoolAPIUrl(void);
+String getPoolAPIUrl(const pool_settings &pool);
 
 #endif //MONITOR_API_H
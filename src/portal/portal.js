@@ -0,0 +1,194 @@
+// The page is static, every value shown comes from the JSON endpoints
+let pools = [];
+let currentSettings = {};
+
+function getJson(url) {
+  return fetch(url).then(r => {
+    if (!r.ok) throw new Error(url + ' ' + r.status);
+    return r.json();
+  });
+}
+
+function addOption(select, value, text, selected) {
+  const option = document.createElement('option');
+  option.value = value;
+  option.text = text;
+  option.selected = selected;
+  select.appendChild(option);
+}
+
+async function loadData() {
+  try {
+    const [p, s, zones] = await Promise.all([getJson('/api/pools'), getJson('/api/settings'), getJson('/api/timezones')]);
+    pools = p;
+    currentSettings = s;
+    populateWifiSelect();
+    populatePoolSelect();
+    populateTimezones(zones);
+    document.getElementById('wallet').value = s.btcWallet;
+    document.getElementById('display_enabled').value = s.displayEnabled ? '0' : '1';
+    document.getElementById('save_stats').value = s.saveStats ? '1' : '0';
+    updatePoolFields();
+  } catch (error) {
+    console.error('Error loading data:', error);
+    alert('Error loading configuration data. Please refresh the page.');
+  }
+}
+
+function populateWifiSelect() {
+  const select = document.getElementById('wifiSelect');
+  select.innerHTML = '<option value="">Select Network</option>';
+  if (currentSettings.wifiSSID) addOption(select, currentSettings.wifiSSID, 'Current: ' + currentSettings.wifiSSID, true);
+}
+
+function populatePoolSelect() {
+  const select = document.getElementById('poolSelect');
+  select.innerHTML = '';
+  pools.forEach((pool, index) => {
+    addOption(select, index, pool.name, pool.url === currentSettings.poolUrl && pool.port === currentSettings.poolPort);
+  });
+}
+
+function populateTimezones(zones) {
+  const select = document.getElementById('timezone');
+  select.innerHTML = '';
+  let found = false;
+  zones.forEach(zone => {
+    const selected = !found && zone.offset === currentSettings.timezone;
+    found = found || selected;
+    addOption(select, zone.offset, zone.name, selected);
+  });
+}
+
+function updatePoolFields() {
+  const select = document.getElementById('poolSelect');
+  const poolUrl = document.getElementById('poolUrl');
+  const poolPort = document.getElementById('poolPort');
+  const poolInfo = document.getElementById('poolInfo');
+  const poolWebUrl = document.getElementById('poolWebUrl');
+  const customFields = document.getElementById('customPoolFields');
+  const selectedPool = pools[select.value];
+  if (!selectedPool) return;
+
+  poolInfo.textContent = selectedPool.info;
+  poolWebUrl.innerHTML = '';
+  if (select.value === '0') {
+    poolUrl.value = currentSettings.poolUrl || '';
+    poolPort.value = currentSettings.poolPort || '';
+    poolUrl.disabled = false;
+    poolPort.disabled = false;
+    customFields.style.display = 'block';
+  } else {
+    poolUrl.value = selectedPool.url;
+    poolPort.value = selectedPool.port;
+    poolUrl.disabled = true;
+    poolPort.disabled = true;
+    customFields.style.display = 'none';
+    if (selectedPool.webUrl) {
+      const link = document.createElement('a');
+      link.href = selectedPool.webUrl;
+      link.target = '_blank';
+      link.textContent = 'Visit Pool Website';
+      poolWebUrl.appendChild(link);
+    }
+  }
+}
+
+// The scan runs in the background, /scan-wifi answers scanning: true until it is done
+function waitForScan(tries) {
+  return getJson('/scan-wifi').then(data => {
+    if (!data.scanning) return data;
+    if (tries <= 0) throw new Error('timeout');
+    return new Promise(resolve => setTimeout(resolve, 1000)).then(() => waitForScan(tries - 1));
+  });
+}
+
+function scanWiFi() {
+  const statusText = document.getElementById('wifiScanStatus');
+  const select = document.getElementById('wifiSelect');
+  statusText.textContent = 'Scanning...';
+  waitForScan(20)
+    .then(data => {
+      populateWifiSelect();
+      data.networks.forEach(network => addOption(select, network.ssid, `${network.ssid} (${network.rssi} dBm)`, false));
+      addOption(select, 'custom', 'Enter Custom Network', false);
+      statusText.textContent = data.networks.length + ' networks found';
+    })
+    .catch(error => {
+      console.error('Scan WiFi Error:', error);
+      statusText.textContent = 'Scan failed: ' + error.message;
+    });
+}
+
+function toggleCustomNetwork() {
+  const select = document.getElementById('wifiSelect');
+  const customNetworkDiv = document.getElementById('customNetworkDiv');
+  customNetworkDiv.style.display = select.value === 'custom' ? 'block' : 'none';
+}
+
+function showSaved(result) {
+  const table = document.getElementById('savedTable');
+  const rows = [
+    ['Network SSID', currentSettings.wifiSSID],
+    ['Pool URL', currentSettings.poolUrl],
+    ['Pool Port', currentSettings.poolPort],
+    ['BTC Wallet Address', currentSettings.btcWallet],
+    ['Timezone', currentSettings.timezone],
+    ['Save Statistics', currentSettings.saveStats ? 'Enabled' : 'Disabled'],
+    ['Display Enabled', currentSettings.displayEnabled ? 'Yes' : 'No']
+  ];
+  table.innerHTML = '';
+  // After a WiFi change the device restarts before the settings could be read back
+  if (!result.restart) rows.forEach(row => {
+    const tr = table.insertRow();
+    tr.insertCell().textContent = row[0];
+    tr.insertCell().textContent = row[1];
+  });
+  document.getElementById('savedText').textContent = result.restart ? 'Device will restart in 3 seconds...' :
+    'Applied without a restart' + (result.poolChanged ? ', the miner is switching to the new pool settings' : '') + '.';
+  document.getElementById('savedPanel').style.display = 'block';
+  if (result.restart) setTimeout(() => { window.location.href = '/'; }, 3000);
+}
+
+// Posts the form like a plain submit, the answer is JSON
+async function saveConfig(event) {
+  event.preventDefault();
+  const overlay = document.getElementById('loadingOverlay');
+  document.getElementById('statusText').innerText = 'Saving configuration...';
+  overlay.style.display = 'flex';
+  try {
+    const body = new URLSearchParams(new FormData(event.target));
+    const result = await fetch('/save', { method: 'POST', body: body }).then(r => r.json());
+    if (!result.success) throw new Error(result.message || 'Save failed');
+    if (!result.restart) currentSettings = await getJson('/api/settings');
+    showSaved(result);
+  } catch (error) {
+    console.error('Error:', error);
+    alert('Failed to save configuration: ' + error.message);
+  }
+  overlay.style.display = 'none';
+}
+
+function factoryReset() {
+  if (confirm('Are you sure you want to reset to factory defaults? This will erase all settings and restart the device.')) {
+    document.getElementById('loadingOverlay').style.display = 'flex';
+    document.getElementById('statusText').innerText = 'Resetting to factory defaults...';
+    fetch('/factory-reset', { method: 'POST' })
+      .then(response => {
+        if (!response.ok) throw new Error('Reset failed');
+        alert('Factory reset successful. Device will restart now. Please wait 30 seconds then reconnect to the device\'s AP to reconfigure.');
+        setTimeout(() => { window.location.href = '/'; }, 5000);
+      })
+      .catch(error => {
+        console.error('Error:', error);
+        alert('Error during factory reset. Device will restart. Please reconnect to the AP mode to reconfigure.');
+        document.getElementById('loadingOverlay').style.display = 'none';
+      });
+  }
+}
+
+document.addEventListener('DOMContentLoaded', function() {
+  document.getElementById('wifiSelect').addEventListener('change', toggleCustomNetwork);
+  document.getElementById('configForm').addEventListener('submit', saveConfig);
+  loadData();
+});
@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "renderBudget.h"
+#include "minerStats.h"
+
+#define TICK_STEP_ms 50
+
+static render_status status = {RENDER_BUDGET_PERMILLE, 0, RENDER_TICK_MIN_ms, RENDER_REDRAW_MIN_ms, true, {}};
+static portMUX_TYPE renderMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Cadence chosen by the governor, kept while the display is off
+static uint32_t tickOnMs = RENDER_TICK_MIN_ms;
+static uint32_t redrawOnMs = RENDER_REDRAW_MIN_ms;
+
+static int64_t windowStart = 0;
+static int64_t windowBusy = 0;
+static uint64_t windowHashes = 0;
+static bool windowMixed = false;        // Display or budget changed during the window
+
+static render_budget_report *getReport(uint16_t budget)
+{
+  for (int i = 0; i < RENDER_MAX_BUDGETS; i++)
+    if (status.reports[i].windows > 0 && status.reports[i].budget == budget) return &status.reports[i];
+  for (int i = 0; i < RENDER_MAX_BUDGETS; i++)
+    if (status.reports[i].windows == 0) return &status.reports[i];
+  return &status.reports[RENDER_MAX_BUDGETS - 1];   // Full, the last budget tried takes the last slot
+}
+
+// Stretch the redraws first when over budget, they cost much more than a tick
+static void adapt(uint16_t load)
+{
+  if (status.budget == 0) {
+    tickOnMs = RENDER_TICK_MIN_ms;
+    redrawOnMs = RENDER_REDRAW_MIN_ms;
+  } else if (load > status.budget) {
+    if (redrawOnMs < RENDER_REDRAW_MAX_ms)
+      redrawOnMs = min(redrawOnMs * 3 / 2, (uint32_t)RENDER_REDRAW_MAX_ms);
+    else
+      tickOnMs = min(tickOnMs + TICK_STEP_ms, (uint32_t)RENDER_TICK_MAX_ms);
+  } else if (load < status.budget / 2) {
+    if (tickOnMs > RENDER_TICK_MIN_ms)
+      tickOnMs = max(tickOnMs - TICK_STEP_ms, (uint32_t)RENDER_TICK_MIN_ms);
+    else
+      redrawOnMs = max(redrawOnMs * 2 / 3, (uint32_t)RENDER_REDRAW_MIN_ms);
+  }
+}
+
+// The window state is shared with setRenderBudget() on the web server task,
+// it is only touched under renderMux
+static void closeWindow(int64_t now)
+{
+  uint64_t hashes = getMinerStats().hashes;
+
+  portENTER_CRITICAL(&renderMux);
+  float seconds = (now - windowStart) / 1000000.0f;
+  uint16_t load = windowBusy * 1000 / (now - windowStart);
+  float hashrate = (hashes - windowHashes) / seconds;
+  status.load = load;
+  if (status.displayOn && !windowMixed) {
+    render_budget_report *r = getReport(status.budget);
+    if (r->budget != status.budget) *r = {status.budget, 0, 0, 0};
+    r->windows++;
+    r->loadSum += load;
+    r->hashrateSum += hashrate;
+    adapt(load);
+    status.tickMs = tickOnMs;
+    status.redrawMs = redrawOnMs;
+  }
+  render_status s = status;
+  windowStart = now;
+  windowBusy = 0;
+  windowHashes = hashes;
+  windowMixed = false;
+  portEXIT_CRITICAL(&renderMux);
+
+  Serial.printf("[RENDER] load %u.%u%% of core 1 (budget %u.%u%%), tick %u ms, redraw %u ms, display %s, %.2f KH/s\n",
+                load / 10, load % 10, s.budget / 10, s.budget % 10, s.tickMs, s.redrawMs,
+                s.displayOn ? "on" : "off", hashrate / 1000);
+}
+
+/// @brief Adds the time the monitor spent on the display since the last call
+void renderAccount(int64_t busyUs, bool displayOn)
+{
+  int64_t now = esp_timer_get_time();
+  uint64_t hashes = 0;
+
+  portENTER_CRITICAL(&renderMux);
+  bool opening = windowStart == 0;
+  portEXIT_CRITICAL(&renderMux);
+  if (opening) hashes = getMinerStats().hashes;
+
+  portENTER_CRITICAL(&renderMux);
+  if (opening) {
+    windowStart = now;
+    windowHashes = hashes;
+  } else {
+    windowBusy += busyUs;
+  }
+  if (displayOn != status.displayOn) {
+    status.displayOn = displayOn;
+    status.tickMs = displayOn ? tickOnMs : RENDER_OFF_TICK_ms;
+    status.redrawMs = displayOn ? redrawOnMs : RENDER_OFF_REDRAW_ms;
+    windowMixed = true;
+  }
+  bool full = now - windowStart >= RENDER_WINDOW_ms * 1000LL;
+  portEXIT_CRITICAL(&renderMux);
+
+  if (full) closeWindow(now);
+}
+
+uint32_t renderTickMs(void)
+{
+  return status.tickMs;
+}
+
+uint32_t renderRedrawMs(void)
+{
+  return status.redrawMs;
+}
+
+void setRenderBudget(uint16_t permille)
+{
+  portENTER_CRITICAL(&renderMux);
+  status.budget = min(permille, (uint16_t)1000);
+  uint16_t budget = status.budget;
+  windowMixed = true;
+  portEXIT_CRITICAL(&renderMux);
+  Serial.printf("[RENDER] budget set to %u.%u%%\n", budget / 10, budget % 10);
+}
+
+render_status getRenderStatus(void)
+{
+  portENTER_CRITICAL(&renderMux);
+  render_status copy = status;
+  portEXIT_CRITICAL(&renderMux);
+  return copy;
+}
+
+String getRenderJson(void)
+{
+  render_status s = getRenderStatus();
+
+  // Hashrate of each budget against running without the governor, when measured
+  float baseline = 0;
+  for (int i = 0; i < RENDER_MAX_BUDGETS; i++)
+    if (s.reports[i].windows > 0 && s.reports[i].budget == 0)
+      baseline = s.reports[i].hashrateSum / s.reports[i].windows;
+
+  String json = "{\"budget\":" + String(s.budget) + ",\"load\":" + String(s.load) +
+                ",\"tickMs\":" + String(s.tickMs) + ",\"redrawMs\":" + String(s.redrawMs) +
+                ",\"displayOn\":" + String(s.displayOn ? "true" : "false") + ",\"budgets\":[";
+  bool first = true;
+  for (int i = 0; i < RENDER_MAX_BUDGETS; i++) {
+    const render_budget_report &r = s.reports[i];
+    if (r.windows == 0) continue;
+    float hashrate = r.hashrateSum / r.windows;
+    json += String(first ? "" : ",") + "{\"budget\":" + String(r.budget) + ",\"windows\":" + String(r.windows) +
+            ",\"load\":" + String((uint32_t)(r.loadSum / r.windows)) + ",\"hashrate\":" + String(hashrate, 0);
+    if (baseline > 0) json += ",\"gainPercent\":" + String((hashrate / baseline - 1) * 100, 2);
+    json += "}";
+    first = false;
+  }
+  json += "]}";
+  return json;
+}
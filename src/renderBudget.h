@@ -0,0 +1,53 @@
+#ifndef RENDERBUDGET_H
+#define RENDERBUDGET_H
+
+#include <Arduino.h>
+
+// Render budget governor
+// The monitor task measures the time it spends drawing, animating and
+// driving the LEDs. Every window the redraw interval and animation tick are
+// stretched when that time is above the CPU budget (share of core 1) and
+// brought back when well below it. While the display is off only a minimal
+// cadence is kept. Budget 0 keeps the fixed 100 ms tick / 1 s redraw.
+// Hashrate is recorded per budget so the gain can be compared; the budget
+// can be changed at runtime with a POST of budget=<per mille> to /api/render.
+
+#ifndef RENDER_BUDGET_PERMILLE
+#define RENDER_BUDGET_PERMILLE  20      // 2% of core 1
+#endif
+
+#define RENDER_TICK_MIN_ms      100     // Original animation tick
+#define RENDER_TICK_MAX_ms      400     // Touch is polled from the LED callback on some boards
+#define RENDER_REDRAW_MIN_ms    1000    // Original redraw interval
+#define RENDER_REDRAW_MAX_ms    5000
+#define RENDER_OFF_TICK_ms      500     // Display off
+#define RENDER_OFF_REDRAW_ms    10000
+#define RENDER_WINDOW_ms        10000   // Load is measured and the cadence adapted over this period
+#define RENDER_MAX_BUDGETS      4       // Budgets kept in the hashrate report
+
+typedef struct {
+  uint16_t budget;                      // Per mille of core 1, 0 for no governor
+  uint32_t windows;
+  uint64_t loadSum;                     // Per mille, summed over the windows
+  double hashrateSum;                   // H/s, summed over the windows
+} render_budget_report;
+
+typedef struct {
+  uint16_t budget;
+  uint16_t load;                        // Last window, per mille of core 1
+  uint32_t tickMs;
+  uint32_t redrawMs;
+  bool displayOn;
+  render_budget_report reports[RENDER_MAX_BUDGETS];
+} render_status;
+
+// Monitor loop
+void renderAccount(int64_t busyUs, bool displayOn);
+uint32_t renderTickMs(void);
+uint32_t renderRedrawMs(void);
+
+void setRenderBudget(uint16_t permille);
+render_status getRenderStatus(void);
+String getRenderJson(void);
+
+#endif // RENDERBUDGET_H
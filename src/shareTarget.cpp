@@ -0,0 +1,50 @@
+#include <math.h>
+#include <string.h>
+#include "shareTarget.h"
+
+/* Network target from the compact nbits field: mantissa * 256^(exponent-3) */
+void targetFromNbits(uint32_t nbits, uint32_t *target)
+{
+    uint8_t *bytes = (uint8_t *)target;
+    int exponent = nbits >> 24;
+    uint32_t mantissa = nbits & 0x007fffff;
+
+    memset(target, 0, 32);
+    for (int i = 0; i < 3; i++) {
+        int pos = exponent - 3 + i;
+        if (pos >= 0 && pos < 32)
+            bytes[pos] = (mantissa >> (8 * i)) & 0xff;
+    }
+}
+
+/* Pool target from the stratum difficulty: truediffone / difficulty.
+ * Anything meets the target of a difficulty that is not above 0 */
+void targetFromDifficulty(double difficulty, uint32_t *target)
+{
+    double t = difficulty > 0 ? truediffone / difficulty : INFINITY;
+
+    if (t >= 115792089237316195423570985008687907853269984665640564039457584007913129639936.0) {
+        memset(target, 0xff, 32);
+        return;
+    }
+    for (int i = 7; i >= 0; i--) {
+        double scale = ldexp(1.0, 32 * i);
+        double w = floor(t / scale);
+        if (w > 4294967295.0) w = 4294967295.0;
+        if (w < 0) w = 0;
+        target[i] = (uint32_t)w;
+        t -= w * scale;
+        if (t < 0) t = 0;
+    }
+}
+
+/* Leading zero bits a hash needs before it could beat difficulty diff.
+ * A hash with z leading zeros is always below diff 2^(z-31). */
+int zerosForDiff(double diff)
+{
+    if (diff <= 0) return 0;
+    int zeros = ilogb(diff) + 32;
+    if (zeros < 0) return 0;
+    if (zeros > 256) return 256;
+    return zeros;
+}
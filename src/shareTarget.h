@@ -0,0 +1,37 @@
+#ifndef SHARE_TARGET_H
+#define SHARE_TARGET_H
+
+#include <stdint.h>
+
+// Share classifier
+// Hashes and targets are handled as 8 little endian words, word 7 being the
+// most significant one. Targets are built once per job (or difficulty change)
+// so the candidate path only needs integer compares. No Arduino dependency,
+// test/test_share_target runs it on the host (pio test -e native-test).
+
+/* Difficulty 1 target, 0xffff * 2^208 */
+static const double truediffone = 26959535291011309493156476344723991336010898738574164086137773096960.0;
+
+void targetFromNbits(uint32_t nbits, uint32_t *target);
+void targetFromDifficulty(double difficulty, uint32_t *target);
+int zerosForDiff(double diff);
+
+/* Leading zero bits of a little endian 256 bit hash */
+static inline int leadingZeros256(const uint32_t *hash)
+{
+    for (int i = 7; i >= 0; i--)
+        if (hash[i]) return (7 - i) * 32 + __builtin_clz(hash[i]);
+    return 256;
+}
+
+/* true if hash <= target, both little endian 256 bit values */
+static inline bool hashMeetsTarget(const uint32_t *hash, const uint32_t *target)
+{
+    for (int i = 7; i >= 0; i--) {
+        if (hash[i] < target[i]) return true;
+        if (hash[i] > target[i]) return false;
+    }
+    return true;
+}
+
+#endif // SHARE_TARGET_H
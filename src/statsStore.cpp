@@ -0,0 +1,181 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <nvs.h>
+#include "statsStore.h"
+#include "minerStats.h"
+#include "drivers/storage/storage.h"
+
+#define SLOTS 2
+static const char *slotKeys[SLOTS] = {"stats_a", "stats_b"};
+
+// Keys of the stats before the record, read once to migrate them
+static const char *legacyKeys[] = {"best_diff", "Mhashes", "shares", "valids", "templates", "upTime"};
+
+extern TSettings Settings;
+
+static nvs_handle_t handle = 0;
+static bool opened = false;
+static bool legacyFound = false;
+static bool scanned = false;             // Slots read, last holds the newest record
+
+static stats_record last;               // Last record read or written
+static int lastSlot = -1;
+static int64_t lastSave = 0;            // esp_timer_get_time()
+static uint32_t bootWrites = 0;
+static size_t partitionSize = 0;
+static portMUX_TYPE storeMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t recordCrc(const stats_record *r)
+{
+  return esp_rom_crc32_le(0, (const uint8_t *)r, offsetof(stats_record, crc));
+}
+
+static bool readSlot(int slot, stats_record *r)
+{
+  size_t size = sizeof(stats_record);
+  if (nvs_get_blob(handle, slotKeys[slot], r, &size) != ESP_OK) return false;
+  return size == sizeof(stats_record) && r->version == STATS_RECORD_VERSION &&
+         r->size == sizeof(stats_record) && r->crc == recordCrc(r);
+}
+
+static bool readLegacy(stats_record *r)
+{
+  uint32_t Mhashes = 0;
+  size_t size = sizeof(double);
+  if (nvs_get_u32(handle, "Mhashes", &Mhashes) != ESP_OK) return false;
+  nvs_get_blob(handle, "best_diff", &r->best_diff, &size);
+  nvs_get_u32(handle, "shares", &r->shares);
+  nvs_get_u32(handle, "valids", &r->valids);
+  nvs_get_u32(handle, "templates", &r->templates);
+  nvs_get_u64(handle, "upTime", &r->upTime);
+  r->hashes = (uint64_t)Mhashes * 1000000;
+  return true;
+}
+
+static bool openStore(void)
+{
+  if (opened) return true;
+  // NVS itself is initialised by the Arduino core before setup()
+  if (nvs_open("state", NVS_READWRITE, &handle) != ESP_OK) {
+    Serial.printf("[STATS] NVS open failed\n");
+    return false;
+  }
+  const esp_partition_t *nvs = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, NULL);
+  partitionSize = nvs ? nvs->size : 0;
+  opened = true;
+  return true;
+}
+
+// Finds the newest valid record, the next save continues its sequence
+static void scanSlots(void)
+{
+  memset(&last, 0, sizeof(last));
+  lastSlot = -1;
+  for (int slot = 0; slot < SLOTS; slot++) {
+    stats_record r;
+    if (readSlot(slot, &r) && (lastSlot < 0 || r.sequence > last.sequence)) {
+      last = r;
+      lastSlot = slot;
+    }
+  }
+  scanned = true;
+}
+
+void statsStoreRestore(void)
+{
+  if (!Settings.saveStats || !openStore()) return;
+
+  lastSave = esp_timer_get_time();
+  scanSlots();
+
+  if (lastSlot < 0) {
+    legacyFound = readLegacy(&last);
+    Serial.printf("[STATS] No stats record%s\n", legacyFound ? ", migrating the old keys" : "");
+    if (!legacyFound) return;
+  } else {
+    Serial.printf("[STATS] Restored record %u from slot %c, %u writes so far\n",
+                  last.sequence, 'A' + lastSlot, last.writes);
+  }
+
+  miner_stats saved = {last.hashes, last.shares, last.valids, last.templates, last.best_diff, last.upTime, 0};
+  statsRestore(&saved);
+}
+
+void statsStoreSave(void)
+{
+  if (!Settings.saveStats || !openStore()) return;
+  // Saving switched on after boot, nothing was restored
+  if (!scanned) scanSlots();
+
+  miner_stats stats = getMinerStats();
+  stats_record r;
+  memset(&r, 0, sizeof(r));
+  r.version = STATS_RECORD_VERSION;
+  r.size = sizeof(stats_record);
+  r.sequence = last.sequence + 1;
+  r.writes = last.writes + 1;
+  r.hashes = stats.hashes;
+  r.shares = stats.shares;
+  r.valids = stats.valids;
+  r.templates = stats.templates;
+  r.best_diff = stats.best_diff;
+  r.upTime = stats.upTime;
+  r.crc = recordCrc(&r);
+
+  // The older slot is overwritten, the last good record stays untouched until the commit is done
+  int slot = (lastSlot + 1) % SLOTS;
+  esp_err_t err = nvs_set_blob(handle, slotKeys[slot], &r, sizeof(r));
+  if (err == ESP_OK) err = nvs_commit(handle);
+  if (err != ESP_OK) {
+    Serial.printf("[STATS] Saving slot %c failed (%s)\n", 'A' + slot, esp_err_to_name(err));
+    return;
+  }
+
+  if (legacyFound) {
+    for (const char *key : legacyKeys) nvs_erase_key(handle, key);
+    nvs_commit(handle);
+    legacyFound = false;
+  }
+
+  portENTER_CRITICAL(&storeMux);
+  last = r;
+  lastSlot = slot;
+  lastSave = esp_timer_get_time();
+  bootWrites++;
+  portEXIT_CRITICAL(&storeMux);
+
+  stats_store_status status = getStatsStoreStatus();
+  Serial.printf("[STATS] Saved record %u to slot %c, %u writes, ~%.3f erase cycles per NVS sector\n",
+                r.sequence, 'A' + slot, r.writes, status.eraseCycles);
+}
+
+/// @brief Saves when something significant changed or the time bound is reached
+void statsStoreUpdate(void)
+{
+  if (!Settings.saveStats) return;
+
+  int64_t age = (esp_timer_get_time() - lastSave) / 1000000;
+  if (age < STATS_SAVE_MIN_s) return;
+
+  miner_stats stats = getMinerStats();
+  bool significant = stats.best_diff > last.best_diff || stats.shares != last.shares || stats.valids != last.valids;
+  if (significant || age >= STATS_SAVE_MAX_s) statsStoreSave();
+}
+
+stats_store_status getStatsStoreStatus(void)
+{
+  stats_store_status status;
+  portENTER_CRITICAL(&storeMux);
+  status.writes = last.writes;
+  status.bootWrites = bootWrites;
+  status.lastSaveAge = (esp_timer_get_time() - lastSave) / 1000000;
+  portEXIT_CRITICAL(&storeMux);
+
+  // NVS appends and rotates its pages, the writes spread over the whole partition.
+  // A blob takes an index entry, a data header entry and its data entries.
+  uint32_t entries = 2 + (sizeof(stats_record) + STATS_NVS_ENTRY_SIZE - 1) / STATS_NVS_ENTRY_SIZE;
+  status.eraseCycles = partitionSize ? (float)status.writes * entries * STATS_NVS_ENTRY_SIZE / partitionSize : 0;
+  return status;
+}
@@ -0,0 +1,47 @@
+#ifndef STATSSTORE_H
+#define STATSSTORE_H
+
+#include <Arduino.h>
+
+// Persistent mining stats
+// The counters are saved as one packed, versioned record with a CRC32. Two
+// NVS blobs (A/B) are written in turn and every save is committed, so a power
+// cut during a write always leaves the previous record intact; at boot the
+// valid record with the highest sequence wins. A save happens when something
+// significant changed (best difficulty, a 32 bit share, a block) and the last
+// save is at least STATS_SAVE_MIN_s old, or after STATS_SAVE_MAX_s anyway.
+// Record writes are counted over the life of the device to estimate the wear
+// of the NVS partition.
+
+#define STATS_RECORD_VERSION  1
+#define STATS_SAVE_MIN_s      (5 * 60)
+#define STATS_SAVE_MAX_s      (1 * 3600)
+#define STATS_NVS_ENTRY_SIZE  32            // NVS entry, a record write takes a few of them
+
+typedef struct __attribute__((packed)) {
+  uint16_t version;
+  uint16_t size;                  // sizeof(stats_record)
+  uint32_t sequence;              // Bumped on every save
+  uint32_t writes;                // Records written over the device life, kept by resets
+  uint64_t hashes;
+  uint32_t shares;
+  uint32_t valids;
+  uint32_t templates;
+  double best_diff;
+  uint64_t upTime;                // Seconds
+  uint32_t crc;                   // CRC32 of the fields above
+} stats_record;
+
+typedef struct {
+  uint32_t writes;                // Records written over the device life
+  uint32_t bootWrites;            // Since boot
+  uint32_t lastSaveAge;           // Seconds
+  float eraseCycles;              // Estimated erase cycles of each NVS sector so far
+} stats_store_status;
+
+void statsStoreRestore(void);
+void statsStoreUpdate(void);      // Monitor loop, saves when due
+void statsStoreSave(void);        // Now, whatever changed
+stats_store_status getStatsStoreStatus(void);
+
+#endif // STATSSTORE_H
@@ -226,6 +226,20 @@ bool tx_mining_submit(WiFiClient& client, mining_subscribe mWorker, mining_job m
     return true;
 }
 
+// Submit a share with every field already formatted, returns the JSON RPC id used
+unsigned long tx_mining_submit_raw(WiFiClient& client, const char* wName, const char* job_id, const char* extranonce2, const char* ntime, const char* nonce)
+{
+    char payload[BUFFER] = {0};
+
+    id = getNextId(id);
+    sprintf(payload, "{\"id\": %u, \"method\": \"mining.submit\", \"params\": [\"%s\",\"%s\",\"%s\",\"%s\",\"%s\"]}\n",
+        id, wName, job_id, extranonce2, ntime, nonce);
+    Serial.print("  Sending  : "); Serial.print(payload);
+    client.print(payload);
+
+    return id;
+}
+
 bool parse_mining_set_difficulty(String line, double& difficulty)
 {
     Serial.println("    Parsing Method [SET DIFFICULTY]");
@@ -61,6 +61,7 @@ bool parse_mining_notify(String line, mining_job& mJob);
 
 //Method Mining.submit
 bool tx_mining_submit(WiFiClient& client, mining_subscribe mWorker, mining_job mJob, unsigned long nonce);
+unsigned long tx_mining_submit_raw(WiFiClient& client, const char* wName, const char* job_id, const char* extranonce2, const char* ntime, const char* nonce);
 
 //Difficulty Methods 
 bool tx_suggest_difficulty(WiFiClient& client, double difficulty);
@@ -0,0 +1,452 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include "stratum.h"
+#include "stratumProxy.h"
+#include "journal.h"
+
+#ifdef STRATUM_PROXY
+
+typedef struct {
+    WiFiClient client;
+    bool subscribed;
+    uint32_t generation;
+    unsigned long lastActivity;
+    char line[PROXY_LINE_MAX];
+    size_t len;
+} proxy_client;
+
+typedef struct {
+    unsigned long upstreamId;
+    uint32_t downstreamId;
+    uint32_t generation;
+    uint8_t slot;
+    bool inUse;
+} proxy_pending;
+
+typedef struct {
+    uint8_t slot;
+    uint32_t downstreamId;
+    uint32_t generation;
+    bool accepted;
+    int errorCode;
+    char errorMsg[32];
+} proxy_response;
+
+static WiFiServer proxyServer(STRATUM_PROXY_PORT);
+static proxy_client clients[PROXY_MAX_CLIENTS];
+static proxy_stats pStats = {0, 0, 0, 0};
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;    // pStats, written by both tasks, read by the web server
+
+// Shared between the stratum worker (writer) and the proxy task (reader)
+static SemaphoreHandle_t proxyLock = NULL;
+static QueueHandle_t submitQueue = NULL;
+static QueueHandle_t responseQueue = NULL;
+static String upExtranonce1 = "";
+static int upExtranonce2Size = 0;
+static volatile uint32_t upGeneration = 0;
+static String lastNotify = "";
+static String lastDifficulty = "";
+static volatile uint32_t notifySeq = 0;
+static volatile uint32_t difficultySeq = 0;
+
+// Only touched by the stratum worker
+static proxy_pending pending[PROXY_PENDING_SUBMITS];
+static size_t pendingHead = 0;
+
+/******************* STRATUM WORKER SIDE (UPSTREAM) *******************/
+
+void proxy_attach_upstream(const mining_subscribe& mWorker)
+{
+    if (proxyLock == NULL) return;
+
+    xSemaphoreTake(proxyLock, portMAX_DELAY);
+    upExtranonce1 = mWorker.extranonce1;
+    upExtranonce2Size = mWorker.extranonce2_size;
+    lastNotify = "";
+    lastDifficulty = "";
+    upGeneration++;
+    xSemaphoreGive(proxyLock);
+
+    for (size_t i = 0; i < PROXY_PENDING_SUBMITS; i++) pending[i].inUse = false;
+
+    Serial.printf("[PROXY] Upstream session %u: extranonce1 %s, extranonce2_size %d\n",
+                  upGeneration, mWorker.extranonce1.c_str(), mWorker.extranonce2_size);
+    if (mWorker.extranonce2_size < 2)
+        Serial.println("[PROXY] Upstream extranonce2 too small to split, downstream miners will be refused");
+}
+
+void proxy_on_notify(const String& line)
+{
+    if (proxyLock == NULL) return;
+
+    xSemaphoreTake(proxyLock, portMAX_DELAY);
+    lastNotify = line;
+    notifySeq++;
+    xSemaphoreGive(proxyLock);
+}
+
+void proxy_on_set_difficulty(const String& line)
+{
+    if (proxyLock == NULL) return;
+
+    xSemaphoreTake(proxyLock, portMAX_DELAY);
+    lastDifficulty = line;
+    difficultySeq++;
+    xSemaphoreGive(proxyLock);
+}
+
+// Route pool answers for forwarded shares back to the downstream miner.
+// Returns true if the line was consumed by the proxy.
+bool proxy_on_response(const String& line)
+{
+    if (responseQueue == NULL) return false;
+    if (line.indexOf("\"method\"") >= 0) return false;
+
+    StaticJsonDocument<384> resp;
+    if (deserializeJson(resp, line)) return false;
+    if (!resp["id"].is<unsigned long>()) return false;
+
+    unsigned long upstreamId = resp["id"];
+    for (size_t i = 0; i < PROXY_PENDING_SUBMITS; i++) {
+        if (!pending[i].inUse || pending[i].upstreamId != upstreamId) continue;
+
+        proxy_response r;
+        r.slot = pending[i].slot;
+        r.downstreamId = pending[i].downstreamId;
+        r.generation = pending[i].generation;
+        r.accepted = resp["error"].isNull() && (resp["result"] | false);
+        r.errorCode = resp["error"][0] | 20;
+        strncpy(r.errorMsg, resp["error"][1] | "Rejected", sizeof(r.errorMsg) - 1);
+        r.errorMsg[sizeof(r.errorMsg) - 1] = 0;
+        pending[i].inUse = false;
+
+        portENTER_CRITICAL(&statsMux);
+        if (r.accepted) pStats.accepted++;
+        else pStats.rejected++;
+        portEXIT_CRITICAL(&statsMux);
+
+        Serial.printf("[PROXY] Slot %u share %s by pool\n", r.slot, r.accepted ? "accepted" : "rejected");
+        xQueueSend(responseQueue, &r, 0);
+        return true;
+    }
+    return false;
+}
+
+// Send downstream shares queued by the proxy task through the upstream socket
+void proxy_flush_submits(WiFiClient& client, const mining_subscribe& mWorker)
+{
+    if (submitQueue == NULL) return;
+
+    proxy_submit s;
+    while (xQueueReceive(submitQueue, &s, 0) == pdTRUE) {
+        char extranonce2[24];
+        snprintf(extranonce2, sizeof(extranonce2), "%02x%s", s.slot, s.extranonce2);
+
+        unsigned long upstreamId = tx_mining_submit_raw(client, mWorker.wName, s.job_id, extranonce2, s.ntime, s.nonce);
+        journalEvent(JOURNAL_SHARE, "lan=%u job=%s extranonce2=%s ntime=%s nonce=%s id=%lu",
+                     s.slot, s.job_id, extranonce2, s.ntime, s.nonce, upstreamId);
+
+        proxy_pending& p = pending[pendingHead];
+        pendingHead = (pendingHead + 1) % PROXY_PENDING_SUBMITS;
+        p.upstreamId = upstreamId;
+        p.downstreamId = s.downstreamId;
+        p.generation = upGeneration;
+        p.slot = s.slot;
+        p.inUse = true;
+        portENTER_CRITICAL(&statsMux);
+        pStats.submitted++;
+        portEXIT_CRITICAL(&statsMux);
+    }
+}
+
+/*********************** PROXY TASK SIDE (DOWNSTREAM) *****************/
+
+static void sendLine(WiFiClient& client, const String& line)
+{
+    client.print(line);
+    client.print("\n");
+}
+
+static void sendResult(WiFiClient& client, JsonVariantConst id, bool result)
+{
+    StaticJsonDocument<128> resp;
+    resp["id"] = id;
+    resp["result"] = result;
+    resp["error"] = nullptr;
+    serializeJson(resp, client);
+    client.print("\n");
+}
+
+static void sendError(WiFiClient& client, JsonVariantConst id, int code, const char* msg)
+{
+    StaticJsonDocument<192> resp;
+    resp["id"] = id;
+    resp["result"] = nullptr;
+    JsonArray error = resp.createNestedArray("error");
+    error.add(code);
+    error.add(msg);
+    error.add(nullptr);
+    serializeJson(resp, client);
+    client.print("\n");
+}
+
+static void dropClient(size_t i, const char* reason)
+{
+    if (clients[i].client) {
+        Serial.printf("[PROXY] Slot %u disconnected (%s)\n", i + 1, reason);
+        clients[i].client.stop();
+    }
+    clients[i].subscribed = false;
+    clients[i].len = 0;
+}
+
+static void acceptClients(void)
+{
+    WiFiClient incoming = proxyServer.available();
+    if (!incoming) return;
+
+    for (size_t i = 0; i < PROXY_MAX_CLIENTS; i++) {
+        if (clients[i].client.connected()) continue;
+        clients[i].client = incoming;
+        clients[i].client.setNoDelay(true);
+        clients[i].subscribed = false;
+        clients[i].generation = upGeneration;
+        clients[i].lastActivity = millis();
+        clients[i].len = 0;
+        Serial.printf("[PROXY] Slot %u connected from %s\n", i + 1, incoming.remoteIP().toString().c_str());
+        return;
+    }
+
+    Serial.println("[PROXY] No free slots, refusing miner");
+    incoming.stop();
+}
+
+static void handleSubscribe(size_t i, JsonVariantConst id)
+{
+    xSemaphoreTake(proxyLock, portMAX_DELAY);
+    String extranonce1 = upExtranonce1;
+    int extranonce2Size = upExtranonce2Size;
+    String difficulty = lastDifficulty;
+    String notify = lastNotify;
+    xSemaphoreGive(proxyLock);
+
+    if (extranonce1.length() == 0 || extranonce2Size < 2) {
+        sendError(clients[i].client, id, 20, "Upstream not ready");
+        return;
+    }
+
+    char slotHex[3];
+    snprintf(slotHex, sizeof(slotHex), "%02x", i + 1);
+
+    StaticJsonDocument<384> resp;
+    resp["id"] = id;
+    JsonArray result = resp.createNestedArray("result");
+    JsonArray subscriptions = result.createNestedArray();
+    JsonArray subDiff = subscriptions.createNestedArray();
+    subDiff.add("mining.set_difficulty");
+    subDiff.add(slotHex);
+    JsonArray subNotify = subscriptions.createNestedArray();
+    subNotify.add("mining.notify");
+    subNotify.add(slotHex);
+    result.add(extranonce1 + slotHex);
+    result.add(extranonce2Size - 1);
+    resp["error"] = nullptr;
+    serializeJson(resp, clients[i].client);
+    clients[i].client.print("\n");
+
+    clients[i].subscribed = true;
+    clients[i].generation = upGeneration;
+
+    // Get the new miner working straight away
+    if (difficulty.length()) sendLine(clients[i].client, difficulty);
+    if (notify.length()) sendLine(clients[i].client, notify);
+}
+
+static void handleSubmit(size_t i, JsonVariantConst id, JsonArrayConst params)
+{
+    if (!clients[i].subscribed || params.size() < 5) {
+        sendError(clients[i].client, id, 25, "Not subscribed");
+        return;
+    }
+
+    const char* extranonce2 = params[2] | "";
+    if (strlen(extranonce2) != (size_t)(upExtranonce2Size - 1) * 2) {
+        sendError(clients[i].client, id, 20, "Bad extranonce2 size");
+        return;
+    }
+
+    proxy_submit s;
+    s.slot = i + 1;
+    s.downstreamId = id | 0UL;
+    strncpy(s.job_id, params[1] | "", sizeof(s.job_id) - 1);
+    s.job_id[sizeof(s.job_id) - 1] = 0;
+    strncpy(s.extranonce2, extranonce2, sizeof(s.extranonce2) - 1);
+    s.extranonce2[sizeof(s.extranonce2) - 1] = 0;
+    strncpy(s.ntime, params[3] | "", sizeof(s.ntime) - 1);
+    s.ntime[sizeof(s.ntime) - 1] = 0;
+    strncpy(s.nonce, params[4] | "", sizeof(s.nonce) - 1);
+    s.nonce[sizeof(s.nonce) - 1] = 0;
+
+    if (xQueueSend(submitQueue, &s, 0) != pdTRUE)
+        sendError(clients[i].client, id, 20, "Proxy busy");
+}
+
+static void handleRequest(size_t i)
+{
+    StaticJsonDocument<1024> req;
+    if (deserializeJson(req, clients[i].line, clients[i].len)) {
+        Serial.printf("[PROXY] Slot %u sent invalid JSON\n", i + 1);
+        return;
+    }
+
+    JsonVariantConst id = req["id"];
+    const char* method = req["method"] | "";
+
+    if (strcmp(method, "mining.subscribe") == 0) {
+        handleSubscribe(i, id);
+    } else if (strcmp(method, "mining.authorize") == 0) {
+        // Shares are paid to the proxy wallet, downstream credentials are ignored
+        sendResult(clients[i].client, id, true);
+    } else if (strcmp(method, "mining.submit") == 0) {
+        handleSubmit(i, id, req["params"].as<JsonArrayConst>());
+    } else if (strcmp(method, "mining.suggest_difficulty") == 0) {
+        // Every downstream miner works at the upstream pool difficulty
+        sendResult(clients[i].client, id, true);
+    } else {
+        sendError(clients[i].client, id, 20, "Unsupported method");
+    }
+}
+
+static void readClient(size_t i)
+{
+    WiFiClient& c = clients[i].client;
+
+    while (c.available()) {
+        char ch = c.read();
+        clients[i].lastActivity = millis();
+        if (ch == '\n') {
+            if (clients[i].len > 0) handleRequest(i);
+            clients[i].len = 0;
+        } else if (clients[i].len < PROXY_LINE_MAX - 1) {
+            clients[i].line[clients[i].len++] = ch;
+        } else {
+            dropClient(i, "request too long");
+            return;
+        }
+    }
+
+    if (millis() - clients[i].lastActivity > PROXY_IDLE_TIMEOUT_ms)
+        dropClient(i, "idle");
+}
+
+static void broadcast(const String& line)
+{
+    for (size_t i = 0; i < PROXY_MAX_CLIENTS; i++) {
+        if (clients[i].subscribed && clients[i].client.connected())
+            sendLine(clients[i].client, line);
+    }
+}
+
+static void deliverResponses(void)
+{
+    proxy_response r;
+    while (xQueueReceive(responseQueue, &r, 0) == pdTRUE) {
+        size_t i = r.slot - 1;
+        if (i >= PROXY_MAX_CLIENTS || !clients[i].subscribed) continue;
+        if (clients[i].generation != r.generation) continue;
+
+        StaticJsonDocument<192> resp;
+        resp["id"] = r.downstreamId;
+        resp["result"] = r.accepted;
+        if (r.accepted) {
+            resp["error"] = nullptr;
+        } else {
+            JsonArray error = resp.createNestedArray("error");
+            error.add(r.errorCode);
+            error.add(r.errorMsg);
+            error.add(nullptr);
+        }
+        serializeJson(resp, clients[i].client);
+        clients[i].client.print("\n");
+    }
+}
+
+void runStratumProxy(void *name)
+{
+    Serial.printf("\n[PROXY] Started. Running %s on core %d\n", (char *)name, xPortGetCoreID());
+
+    proxyLock = xSemaphoreCreateMutex();
+    submitQueue = xQueueCreate(PROXY_QUEUE_SIZE, sizeof(proxy_submit));
+    responseQueue = xQueueCreate(PROXY_QUEUE_SIZE, sizeof(proxy_response));
+
+    while (WiFi.status() != WL_CONNECTED) vTaskDelay(1000 / portTICK_PERIOD_MS);
+
+    proxyServer.begin();
+    proxyServer.setNoDelay(true);
+    Serial.printf("[PROXY] Listening on %s:%d\n", WiFi.localIP().toString().c_str(), STRATUM_PROXY_PORT);
+
+    uint32_t sentGeneration = upGeneration;
+    uint32_t sentNotify = notifySeq;
+    uint32_t sentDifficulty = difficultySeq;
+
+    while (true) {
+        acceptClients();
+
+        // New upstream session invalidates every extranonce1 we handed out
+        if (sentGeneration != upGeneration) {
+            sentGeneration = upGeneration;
+            for (size_t i = 0; i < PROXY_MAX_CLIENTS; i++)
+                if (clients[i].subscribed) dropClient(i, "upstream reconnected");
+        }
+
+        if (sentDifficulty != difficultySeq || sentNotify != notifySeq) {
+            xSemaphoreTake(proxyLock, portMAX_DELAY);
+            String difficulty = (sentDifficulty != difficultySeq) ? lastDifficulty : "";
+            String notify = (sentNotify != notifySeq) ? lastNotify : "";
+            sentDifficulty = difficultySeq;
+            sentNotify = notifySeq;
+            xSemaphoreGive(proxyLock);
+
+            if (difficulty.length()) broadcast(difficulty);
+            if (notify.length()) broadcast(notify);
+        }
+
+        deliverResponses();
+
+        uint8_t connected = 0;
+        for (size_t i = 0; i < PROXY_MAX_CLIENTS; i++) {
+            if (!clients[i].client.connected()) {
+                if (clients[i].subscribed) dropClient(i, "closed");
+                continue;
+            }
+            readClient(i);
+            if (clients[i].subscribed) connected++;
+        }
+        portENTER_CRITICAL(&statsMux);
+        pStats.clients = connected;
+        portEXIT_CRITICAL(&statsMux);
+
+        vTaskDelay(20 / portTICK_PERIOD_MS);
+    }
+}
+
+proxy_stats getProxyStats(void)
+{
+    portENTER_CRITICAL(&statsMux);
+    proxy_stats stats = pStats;
+    portEXIT_CRITICAL(&statsMux);
+    return stats;
+}
+
+#else
+
+void proxy_attach_upstream(const mining_subscribe& mWorker) {}
+void proxy_on_notify(const String& line) {}
+void proxy_on_set_difficulty(const String& line) {}
+bool proxy_on_response(const String& line) { return false; }
+void proxy_flush_submits(WiFiClient& client, const mining_subscribe& mWorker) {}
+void runStratumProxy(void *name) { vTaskDelete(NULL); }
+proxy_stats getProxyStats(void) { return {0, 0, 0, 0}; }
+
+#endif // STRATUM_PROXY
@@ -0,0 +1,55 @@
+#ifndef STRATUM_PROXY_H
+#define STRATUM_PROXY_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "stratum.h"
+
+// LAN stratum proxy
+// One device keeps the upstream pool session and serves stratum v1 to the
+// other miners on the LAN. Every downstream miner gets its own extranonce2
+// prefix byte (slot), so their work never overlaps with each other or with
+// the local miner, which always hashes with prefix 0x00.
+//
+// Enable it with -D STRATUM_PROXY=1 on the device that should aggregate the
+// fleet and point the other miners to <proxy ip>:STRATUM_PROXY_PORT.
+
+#ifndef STRATUM_PROXY_PORT
+#define STRATUM_PROXY_PORT 3333
+#endif
+
+#define PROXY_MAX_CLIENTS     16    // Slots 1..16, slot 0 is the local miner
+#define PROXY_PENDING_SUBMITS 32    // Submits waiting for an upstream answer
+#define PROXY_QUEUE_SIZE      16
+#define PROXY_LINE_MAX        512   // Downstream requests are small
+#define PROXY_IDLE_TIMEOUT_ms 300000
+
+typedef struct {
+    uint8_t slot;
+    uint32_t downstreamId;
+    char job_id[32];
+    char extranonce2[20];
+    char ntime[12];
+    char nonce[12];
+} proxy_submit;
+
+typedef struct {
+    uint8_t clients;        // Connected and subscribed downstream miners
+    uint32_t submitted;     // Shares forwarded upstream
+    uint32_t accepted;      // Shares accepted by the pool
+    uint32_t rejected;      // Shares rejected by the pool
+} proxy_stats;
+
+// Stratum worker side (upstream owner)
+void proxy_attach_upstream(const mining_subscribe& mWorker);
+void proxy_on_notify(const String& line);
+void proxy_on_set_difficulty(const String& line);
+bool proxy_on_response(const String& line);
+void proxy_flush_submits(WiFiClient& client, const mining_subscribe& mWorker);
+
+// Proxy task (downstream owner)
+void runStratumProxy(void *name);
+
+proxy_stats getProxyStats(void);
+
+#endif // STRATUM_PROXY_H
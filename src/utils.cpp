@@ -74,7 +74,6 @@ void reverse_bytes(uint8_t * data, size_t len) {
     }
 }
 
-static const double truediffone = 26959535291011309493156476344723991336010898738574164086137773096960.0;
 /* Converts a little endian 256 bit value to a double */
 double le256todouble(const void *target)
 {
@@ -109,33 +108,14 @@ double diff_from_target(void *target)
     return d64 / dcut64;
 }
 
-/****************** PREMINING CALCULATIONS ********************/
-
-
-bool checkValid(unsigned char* hash, unsigned char* target) {
-  bool valid = true;
-  unsigned char diff_target[32];
-  memcpy(diff_target, &target, 32);
-  //convert target to little endian for comparison
-  reverse_bytes(diff_target, 32);
+void setPoolTarget(miner_data& mMiner, double difficulty)
+{
+    mMiner.poolDifficulty = difficulty;
+    targetFromDifficulty(difficulty > 0 ? difficulty : DEFAULT_DIFFICULTY, mMiner.pool_target);
+}
 
-  for(uint8_t i=31; i>=0; i--) {
-    if(hash[i] > diff_target[i]) {
-      valid = false;
-      break;
-    }
-  }
+/****************** PREMINING CALCULATIONS ********************/
 
-  #ifdef DEBUG_MINING
-  if (valid) {
-    Serial.print("\tvalid : ");
-    for (size_t i = 0; i < 32; i++)
-        Serial.printf("%02x ", hash[i]);
-    Serial.println();
-  }
-  #endif
-  return valid;
-}
 
 /**
  * get random extranonce2
@@ -158,23 +138,24 @@ void getRandomExtranonce2(int extranonce2_size, char *extranonce2) {
 
 /**
  * get linear extranonce2
+ * The counter is kept in hex and never carries into the first byte: with the
+ * stratum proxy that byte is the slot prefix and slot 00 is the local miner
 */
 void getNextExtranonce2(int extranonce2_size, char *extranonce2) {
-  unsigned long extranonce2_number = strtoul(extranonce2, NULL, 10);
+  uint64_t extranonce2_number = strtoull(extranonce2, NULL, 16);
 
   extranonce2_number++;
+  if (extranonce2_size >= 2 && extranonce2_size <= 8)
+    extranonce2_number &= (1ULL << ((extranonce2_size - 1) * 8)) - 1;
 
-  char format[] = "%00x";
-
-  sprintf(&format[1], "%02dx", extranonce2_size * 2);
-  sprintf(extranonce2, format, extranonce2_number);
+  sprintf(extranonce2, "%0*llx", extranonce2_size * 2, (unsigned long long)extranonce2_number);
 }
 
 miner_data init_miner_data(void){
   
   miner_data newMinerData;
 
-  newMinerData.poolDifficulty = DEFAULT_DIFFICULTY;
+  setPoolTarget(newMinerData, DEFAULT_DIFFICULTY);
   newMinerData.inRun = false;
   newMinerData.newJob = false;
   
@@ -197,11 +178,9 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
     // bytearray target
     size_t size_target = to_byte_array(target, 32, mMiner.bytearray_target);
 
-    for (size_t j = 0; j < 8; j++) {
-      mMiner.bytearray_target[j] ^= mMiner.bytearray_target[size_target - 1 - j];
-      mMiner.bytearray_target[size_target - 1 - j] ^= mMiner.bytearray_target[j];
-      mMiner.bytearray_target[j] ^= mMiner.bytearray_target[size_target - 1 - j];
-    }
+    // little endian, as the hashes
+    reverse_bytes(mMiner.bytearray_target, size_target);
+    targetFromNbits(strtoul(mJob.nbits.c_str(), NULL, 16), mMiner.net_target);
 
     // get extranonce2 - extranonce2 = hex(random.randint(0,2**32-1))[2:].zfill(2*extranonce2_size)
     //To review
@@ -471,4 +450,53 @@ void suffix_string(double val, char *buf, size_t bufsiz, int sigdigits)
 
         snprintf(buf, bufsiz, "%*.*f%s", sigdigits + 1, ndigits, dval, suffix);
     }
-}
\ No newline at end of file
+}
+
+#ifdef DEBUG_HEAP_ALLOCS
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+}
+
+static volatile TaskHandle_t countedTask = NULL;
+static volatile uint32_t countedAllocs = 0;
+
+static inline void countAlloc(void)
+{
+    if (countedTask != NULL && xTaskGetCurrentTaskHandle() == countedTask) countedAllocs++;
+}
+
+extern "C" void *__wrap_malloc(size_t size)
+{
+    countAlloc();
+    return __real_malloc(size);
+}
+
+extern "C" void *__wrap_calloc(size_t n, size_t size)
+{
+    countAlloc();
+    return __real_calloc(n, size);
+}
+
+extern "C" void *__wrap_realloc(void *ptr, size_t size)
+{
+    countAlloc();
+    return __real_realloc(ptr, size);
+}
+
+void heapAllocsBegin(void)
+{
+    countedAllocs = 0;
+    countedTask = xTaskGetCurrentTaskHandle();
+}
+
+uint32_t heapAllocsEnd(void)
+{
+    countedTask = NULL;
+    return countedAllocs;
+}
+#else
+void heapAllocsBegin(void) {}
+uint32_t heapAllocsEnd(void) { return 0; }
+#endif
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include "mining.h"
 #include "stratum.h"
+#include "shareTarget.h"
 
 /*
  * General byte order swapping functions.
@@ -21,9 +22,14 @@ int to_byte_array(const char *in, size_t in_size, uint8_t *out);
 double le256todouble(const void *target);
 double diff_from_target(void *target);
 miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob);
-bool checkValid(unsigned char* hash, unsigned char* target);
+void setPoolTarget(miner_data& mMiner, double difficulty);
 void suffix_string(double val, char *buf, size_t bufsiz, int sigdigits);
 
+/* Heap allocations made by the calling task between begin and end. Counts only
+   with DEBUG_HEAP_ALLOCS and -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc */
+void heapAllocsBegin(void);
+uint32_t heapAllocsEnd(void);
+
 
 
 #endif // UTILS_API_H
\ No newline at end of file
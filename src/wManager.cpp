@@ -10,17 +10,31 @@
 #include "drivers/storage/SDCard.h"
 #include <WiFi.h>
 #include <DNSServer.h>
-#include <WebServer.h>
+#include <ESPAsyncWebServer.h>
 #include <Preferences.h>
 #include "drivers/displays/display.h"
 #include "version.h"
 #include "nvs_flash.h"
 #include "esp_system.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include "wifiManager.h"
+#include "fleet.h"
+#include "minerStats.h"
+#include "hashrate.h"
+#include "fetcher.h"
+#include "renderBudget.h"
+#include "statsStore.h"
+#include "history.h"
+#include "journal.h"
+#include "fastBoot.h"
+#include "mining.h"
+#include "inputEvents.h"
+#include "portal/portal_assets.h"
+#include <esp_timer.h>
 
 // Global instances
-WebServer webServer(80);
+AsyncWebServer webServer(80);
 DNSServer dnsServer;
 Preferences preferences;
 bool portalRunning = false;
@@ -84,191 +98,6 @@ const TimezoneInfo TIMEZONE_LIST[] = {
 
 const int TIMEZONE_COUNT = sizeof(TIMEZONE_LIST) / sizeof(TIMEZONE_LIST[0]);
 
-// Helper function to generate client-side JavaScript
-String generateClientScript() {
-    String js = "";
-    js += "let pools = [];";
-    js += "let currentSettings = {};";
-    
-    js += "async function loadData() {";
-    js += "  try {";
-    js += "    pools = await fetch('/api/pools').then(r => r.json());";
-    js += "    currentSettings = await fetch('/api/settings').then(r => r.json());";
-    js += "    populatePoolSelect();";
-    js += "    updatePoolFields();";
-    js += "  } catch (error) {";
-    js += "    console.error('Error loading data:', error);";
-    js += "    alert('Error loading configuration data. Please refresh the page.');";
-    js += "  }";
-    js += "}";
-    
-    js += "function populatePoolSelect() {";
-    js += "  const select = document.getElementById('poolSelect');";
-    js += "  select.innerHTML = '';";
-    js += "  pools.forEach((pool, index) => {";
-    js += "    const option = document.createElement('option');";
-    js += "    option.value = index;";
-    js += "    option.text = pool.name;";
-    js += "    if (pool.url === currentSettings.poolUrl && pool.port === currentSettings.poolPort) {";
-    js += "      option.selected = true;";
-    js += "    }";
-    js += "    select.appendChild(option);";
-    js += "  });";
-    js += "}";
-    
-    js += "function updatePoolFields() {";
-    js += "  const select = document.getElementById('poolSelect');";
-    js += "  const poolUrl = document.getElementById('poolUrl');";
-    js += "  const poolPort = document.getElementById('poolPort');";
-    js += "  const poolInfo = document.getElementById('poolInfo');";
-    js += "  const poolWebUrl = document.getElementById('poolWebUrl');";
-    js += "  const customFields = document.getElementById('customPoolFields');";
-    js += "  const selectedPool = pools[select.value];";
-    
-    js += "  if (select.value === '0') {";
-    js += "    poolUrl.value = currentSettings.poolUrl || '';";
-    js += "    poolPort.value = currentSettings.poolPort || '';";
-    js += "    poolUrl.disabled = false;";
-    js += "    poolPort.disabled = false;";
-    js += "    poolInfo.innerHTML = selectedPool.info;";
-    js += "    poolWebUrl.innerHTML = '';";
-    js += "    customFields.style.display = 'block';";
-    js += "  } else {";
-    js += "    poolUrl.value = selectedPool.url;";
-    js += "    poolPort.value = selectedPool.port;";
-    js += "    poolUrl.disabled = true;";
-    js += "    poolPort.disabled = true;";
-    js += "    poolInfo.innerHTML = selectedPool.info;";
-    js += "    customFields.style.display = 'none';";
-    js += "    if (selectedPool.webUrl) {";
-    js += "      poolWebUrl.innerHTML = `<a href=\"${selectedPool.webUrl}\" target=\"_blank\">Visit Pool Website</a>`;";
-    js += "    } else {";
-    js += "      poolWebUrl.innerHTML = '';";
-    js += "    }";
-    js += "  }";
-    js += "}";
-    
-    js += "function scanWiFi() {";
-    js += "  const statusText = document.getElementById('wifiScanStatus');";
-    js += "  const select = document.getElementById('wifiSelect');";
-    js += "  const currentOption = select.querySelector('option[selected]');";
-    js += "  statusText.textContent = 'Scanning...';";
-    js += "  fetch('/scan-wifi')";
-    js += "    .then(response => response.json())";
-    js += "    .then(data => {";
-    js += "      select.innerHTML = currentOption ? currentOption.outerHTML : '<option value=\"\">Select Network</option>';";
-    js += "      data.networks.forEach(network => {";
-    js += "        const option = document.createElement('option');";
-    js += "        option.value = network.ssid;";
-    js += "        option.text = `${network.ssid} (${network.rssi} dBm)`;";
-    js += "        select.appendChild(option);";
-    js += "      });";
-    js += "      const customOption = document.createElement('option');";
-    js += "      customOption.value = 'custom';";
-    js += "      customOption.text = 'Enter Custom Network';";
-    js += "      select.appendChild(customOption);";
-    js += "      statusText.textContent = data.networks.length + ' networks found';";
-    js += "    })";
-    js += "    .catch(error => {";
-    js += "      console.error('Scan WiFi Error:', error);";
-    js += "      statusText.textContent = 'Scan failed: ' + error.message;";
-    js += "    });";
-    js += "}";
-    
-    js += "function toggleCustomNetwork() {";
-    js += "  const select = document.getElementById('wifiSelect');";
-    js += "  const customNetworkDiv = document.getElementById('customNetworkDiv');";
-    js += "  customNetworkDiv.style.display = select.value === 'custom' ? 'block' : 'none';";
-    js += "}";
-    
-    js += "function factoryReset() {";
-    js += "  if (confirm('Are you sure you want to reset to factory defaults? This will erase all settings and restart the device.')) {";
-    js += "    document.getElementById('loadingOverlay').style.display = 'flex';";
-    js += "    document.getElementById('statusText').innerText = 'Resetting to factory defaults...';";
-    js += "    fetch('/factory-reset', { method: 'POST' })";
-    js += "      .then(response => {";
-    js += "        if (!response.ok) throw new Error('Reset failed');";
-    js += "        alert('Factory reset successful. Device will restart now. Please wait 30 seconds then reconnect to the device\\'s AP to reconfigure.');";
-    js += "        setTimeout(() => { window.location.href = '/'; }, 5000);";
-    js += "      })";
-    js += "      .catch(error => {";
-    js += "        console.error('Error:', error);";
-    js += "        alert('Error during factory reset. Device will restart. Please reconnect to the AP mode to reconfigure.');";
-    js += "        document.getElementById('loadingOverlay').style.display = 'none';";
-    js += "      });";
-    js += "  }";
-    js += "}";
-    
-    js += "document.addEventListener('DOMContentLoaded', function() {";
-    js += "  console.log('DOMContentLoaded event triggered');";
-    js += "  const wifiSelect = document.getElementById('wifiSelect');";
-    js += "  if (wifiSelect) {";
-    js += "    wifiSelect.addEventListener('change', toggleCustomNetwork);";
-    js += "  }";
-    js += "  loadData();";
-    js += "});";
-    
-    js += "window.onload = loadData;";
-    
-    return js;
-}
-
-// Helper function to generate CSS styles
-String generateStyles() {
-    String css = "";
-    css += "body { font-family: 'Courier New', monospace; margin: 0; padding: 20px; background: #1a1a1a; color: #00ff00; }";
-    css += ".container { max-width: 800px; margin: 0 auto; background: #2d2d2d; padding: 30px; border-radius: 10px; box-shadow: 0 0 20px rgba(0, 255, 0, 0.1); }";
-    css += "h1 { text-align: center; color: #00ff00; text-shadow: 0 0 10px rgba(0, 255, 0, 0.5); margin-bottom: 30px; }";
-    
-    // Animation keyframes for left and right axes
-    css += "@keyframes swingLeft { ";
-    css += "0% { transform: rotate(0deg); }";
-    css += "25% { transform: rotate(-30deg); }";
-    css += "50% { transform: rotate(0deg); }";
-    css += "100% { transform: rotate(0deg); }";
-    css += "}";
-    
-    css += "@keyframes swingRight { ";
-    css += "0% { transform: rotate(0deg); }";
-    css += "25% { transform: rotate(30deg); }";
-    css += "50% { transform: rotate(0deg); }";
-    css += "100% { transform: rotate(0deg); }";
-    css += "}";
-    
-    css += ".axe-left { display: inline-block; animation: swingLeft 2s ease-in-out infinite; transform-origin: 50% 50%; }";
-    css += ".axe-right { display: inline-block; animation: swingRight 2s ease-in-out infinite; transform-origin: 50% 50%; animation-delay: 1s; }";
-    
-    css += "select, input { width: 100%; padding: 12px; margin: 8px 0 20px 0; background: #1a1a1a; border: 1px solid #00ff00; color: #00ff00; border-radius: 5px; }";
-    css += "select:focus, input:focus { outline: none; box-shadow: 0 0 10px rgba(0, 255, 0, 0.5); }";
-    css += ".pool-info { margin: 10px 0; padding: 10px; border-left: 3px solid #00ff00; background: #1a1a1a; }";
-    css += ".pool-web-url { margin: 10px 0; }";
-    css += ".pool-web-url a { color: #00ff00; text-decoration: none; }";
-    css += ".pool-web-url a:hover { text-decoration: underline; }";
-    css += "label { display: block; color: #00ff00; margin-bottom: 5px; }";
-    css += "input[type='submit'] { background: #00ff00; color: #1a1a1a; font-weight: bold; cursor: pointer; transition: all 0.3s; }";
-    css += "input[type='submit']:hover { background: #1a1a1a; color: #00ff00; }";
-    css += ".section { margin-bottom: 30px; padding: 20px; border: 1px solid #00ff00; border-radius: 5px; }";
-    css += ".section-title { color: #00ff00; margin-bottom: 20px; border-bottom: 1px solid #00ff00; padding-bottom: 10px; }";
-    css += "@keyframes spin { 0% { transform: rotate(0deg); } 100% { transform: rotate(360deg); } }";
-    css += ".spinner { width: 50px; height: 50px; border: 5px solid #1a1a1a; border-top: 5px solid #00ff00; border-radius: 50%; animation: spin 1s linear infinite; margin: 0 auto 20px; }";
-    css += ".toggle-btn { background: #00ff00; color: #1a1a1a; padding: 10px 20px; border: none; border-radius: 5px; cursor: pointer; margin-bottom: 20px; font-weight: bold; width: 100%; }";
-    css += ".toggle-btn:hover { background: #1a1a1a; color: #00ff00; border: 1px solid #00ff00; }";
-    css += ".factory-reset {";
-    css += "  background-color: #dc3545;";
-    css += "  color: white;";
-    css += "  padding: 10px 20px;";
-    css += "  border: none;";
-    css += "  border-radius: 4px;";
-    css += "  cursor: pointer;";
-    css += "  margin-top: 20px;";
-    css += "  width: 100%;";
-    css += "}";
-    css += ".factory-reset:hover {";
-    css += "  background-color: #c82333;";
-    css += "}";
-    return css;
-}
-
 // Helper function to generate JSON response
 String generateJsonResponse(bool success, const char* message = nullptr) {
     String json = "{\"success\":" + String(success ? "true" : "false");
@@ -279,163 +108,270 @@ String generateJsonResponse(bool success, const char* message = nullptr) {
     return json;
 }
 
-void setupWebServer() {
-    // Root route handler
-    webServer.on("/", HTTP_GET, []() {
-        String html = "<!DOCTYPE html>";
-        html += "<html><head>";
-        html += "<meta charset='UTF-8'>";
-        html += "<meta http-equiv='Content-Type' content='text/html; charset=UTF-8'>";
-        html += "<title>NerdMiner Configuration</title>";
-        html += "<style>" + generateStyles() + "</style>";
-        html += "<script>" + generateClientScript() + "</script>";
-        html += "</head><body><div class='container'>";
-        html += "<h1><span class='axe-left'>&#x26CF;</span> NerdMiner Configuration <span class='axe-right'>&#x26CF;</span></h1>";
-        
-        // Form sections
-        html += "<form method='POST' action='/save'>";
-        
-        // WiFi Configuration Section
-        html += "<div class='section'>";
-        html += "<h2 class='section-title'>WiFi Configuration</h2>";
-        html += "<button type='button' onclick='scanWiFi()'>Scan WiFi Networks</button>";
-        html += "<div id='wifiScanStatus' style='color: #666; margin-top: 10px;'></div>";
-        html += "<label for='wifiSelect'>Select WiFi Network:</label>";
-        html += "<select id='wifiSelect' name='wifiSelect'>";
-        html += "<option value=''>Select Network</option>";
-
-        // Add current saved WiFi network as a pre-selected option
-        if (!Settings.WifiSSID.isEmpty()) {
-            html += "<option value='" + Settings.WifiSSID + "' selected>Current: " + Settings.WifiSSID + "</option>";
+// History is copied out a page at a time, the lock is never held while sending
+#define HISTORY_PAGE 64
+
+typedef struct {
+    history_sample samples[HISTORY_PAGE];
+    uint32_t count;
+    uint32_t next;                      // Time of the first sample left out
+    bool more;                          // Samples were left out
+} history_page;
+
+static bool collectHistorySample(const history_sample *s, void *arg) {
+    history_page *page = (history_page *)arg;
+    if (page->count == HISTORY_PAGE) {
+        page->next = s->time;
+        page->more = true;
+        return false;
+    }
+    page->samples[page->count++] = *s;
+    return true;
+}
+
+// Time and heap taken by the portal requests, one entry per asset and one for /save
+#define PORTAL_SAVE_ROUTE PORTAL_ASSET_COUNT
+
+typedef struct {
+    uint32_t requests;
+    uint32_t notModified;               // Answered 304 from the browser cache
+    uint32_t maxUs;
+    uint64_t totalUs;
+    int32_t maxHeapDelta;               // Free heap lost over one request, worst case
+} portal_route_stats;
+
+static portal_route_stats portalStats[PORTAL_ASSET_COUNT + 1];   // async_tcp task only
+
+static void portalMeasured(size_t route, int code, int64_t start, size_t heapBefore) {
+    uint32_t us = esp_timer_get_time() - start;
+    int32_t heapDelta = (int32_t)heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    portal_route_stats &s = portalStats[route];
+    s.requests++;
+    if (code == 304) s.notModified++;
+    s.totalUs += us;
+    if (us > s.maxUs) s.maxUs = us;
+    if (s.requests == 1 || heapDelta > s.maxHeapDelta) s.maxHeapDelta = heapDelta;
+    Serial.printf("[PORTAL] %s %d in %u us, heap delta %d bytes\n",
+                  route == PORTAL_SAVE_ROUTE ? "/save" : PORTAL_ASSETS[route].path, code, us, heapDelta);
+}
+
+/// @brief Sends a prebuilt asset straight from flash, or 304 when the browser has it
+static void sendPortalAsset(AsyncWebServerRequest *request, size_t i) {
+    int64_t start = esp_timer_get_time();
+    size_t heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    const portal_asset &asset = PORTAL_ASSETS[i];
+
+    AsyncWebServerResponse *response;
+    int code = 200;
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == asset.etag) {
+        code = 304;
+        response = request->beginResponse(304);
+    } else {
+        // Sent from flash as the TCP window allows, nothing is copied to the heap first
+        response = request->beginResponse(200, asset.contentType, asset.data, asset.size);
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    // no-cache: the browser revalidates every time, a new firmware is picked up at once
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+    portalMeasured(i, code, start, heap);
+}
+
+// One /api/history response being sent, the filler is called again whenever
+// the TCP window has room. At most HISTORY_STREAMS run at once.
+#define HISTORY_STREAMS 2
+
+typedef struct {
+    uint32_t to;
+    uint32_t next;                      // Time of the next sample
+    bool end;                           // No samples left, next is not valid
+    uint32_t sent;
+    bool done;                          // Closing text formatted
+    char text[256];                     // Formatted but not sent yet
+    uint16_t textLen;
+    uint16_t textPos;
+    uint32_t pageIndex;
+    history_page page;
+} history_stream;
+
+static uint8_t historyStreams = 0;      // async_tcp task only
+
+static size_t fillHistory(history_stream *s, uint8_t *buffer, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen) {
+        if (s->textPos < s->textLen) {
+            size_t len = min((size_t)(s->textLen - s->textPos), maxLen - n);
+            memcpy(buffer + n, s->text + s->textPos, len);
+            s->textPos += len;
+            n += len;
+            continue;
+        }
+        if (s->done) break;
+
+        if (s->pageIndex == s->page.count && !s->end && s->sent < HISTORY_QUERY_MAX) {
+            // The history lock is only held while a page is copied
+            s->page.count = 0;
+            s->page.more = false;
+            s->pageIndex = 0;
+            historyQuery(s->next, s->to, collectHistorySample, &s->page);
+            if (s->page.count == 0) s->end = true;
         }
 
-        html += "</select>";
-        html += "<div id='customNetworkDiv' style='display: none;'>";
-        html += "<label for='customNetworkInput'>Enter Custom Network Name:</label>";
-        html += "<input type='text' id='customNetworkInput' name='customNetworkInput' placeholder='Custom Network SSID'>";
-        html += "</div>";
-        html += "<label for='wifiPassword'>WiFi Password:</label>";
-        html += "<input type='password' id='wifiPassword' name='wifiPassword'>";
-        html += "</div>";
-
-        // Pool Configuration Section
-        html += "<div class='section'>";
-        html += "<h2 class='section-title'>Pool Configuration</h2>";
-        html += "<label for='poolSelect'>Select Pool:</label>";
-        html += "<select id='poolSelect' name='poolSelect' onchange='updatePoolFields()'></select>";
-        html += "<div id='poolInfo' class='pool-info'></div>";
-        html += "<div id='poolWebUrl' class='pool-web-url'></div>";
-        html += "<div id='customPoolFields' class='custom-pool-fields' style='display: none;'>";
-        html += "<label for='poolUrl'>Pool URL:</label>";
-        html += "<input type='text' id='poolUrl' name='poolUrl'>";
-        html += "<label for='poolPort'>Pool Port:</label>";
-        html += "<input type='number' id='poolPort' name='poolPort'>";
-        html += "</div>";
-        html += "</div>";
-
-        // Wallet Configuration Section
-        html += "<div class='section'>";
-        html += "<h2 class='section-title'>Wallet Configuration</h2>";
-        html += "<label for='wallet'>BTC Wallet Address:</label>";
-        html += "<input type='text' id='wallet' name='wallet' value='" + String(Settings.BtcWallet) + "'>";
-        html += "<label for='password'>Pool Password (optional):</label>";
-        html += "<input type='text' id='password' name='password' value='" + String(Settings.PoolPassword) + "'>";
-        html += "</div>";
-
-        // Display Configuration Section
-        html += "<div class='section'>";
-        html += "<h2 class='section-title'>Display Configuration</h2>";
-        html += "<label for='display_enabled'>Display Enabled:</label>";
-        html += "<select name='display_enabled' id='display_enabled'>";
-        html += "<option value='1'" + String(Settings.displayEnabled ? " selected" : "") + ">No</option>";
-        html += "<option value='0'" + String(!Settings.displayEnabled ? " selected" : "") + ">Yes</option>";
-        html += "</select>";
-
-        html += "<h2 class='section-title'>Stats Configuration</h2>";
-
-        html += "<label for='timezone'>Timezone:</label><br>";
-        html += "<select name='timezone'>";
-        for (int i = 0; i < TIMEZONE_COUNT; i++) {
-            html += "<option value='" + String(TIMEZONE_LIST[i].offset) + "'";
-            if (TIMEZONE_LIST[i].offset == Settings.Timezone) {
-                html += " selected";
+        int len;
+        if (s->pageIndex == s->page.count || s->sent >= HISTORY_QUERY_MAX) {
+            len = !s->end ? snprintf(s->text, sizeof(s->text), "],\"next\":%u}", s->next)
+                          : snprintf(s->text, sizeof(s->text), "],\"next\":null}");
+            s->done = true;
+        } else {
+            const history_sample &h = s->page.samples[s->pageIndex++];
+            if (s->pageIndex < s->page.count) {
+                s->next = s->page.samples[s->pageIndex].time;
+            } else {
+                s->next = s->page.next;
+                s->end = !s->page.more;
             }
-            html += ">" + String(TIMEZONE_LIST[i].name) + "</option>";
+            len = snprintf(s->text, sizeof(s->text), "%s[%u,%u,%u,%d,%d,%u]", s->sent ? "," : "",
+                           h.time, h.hashrate, h.shares, h.temperature, h.rssi, h.state);
+            s->sent++;
         }
-        html += "</select><br>";
-
-        // Save Statistics
-        html += "<label for='save_stats'>Save Statistics:</label><br>";
-        html += "<select name='save_stats'>";
-        html += "<option value='1'" + String(Settings.saveStats ? " selected" : "") + ">Yes</option>";
-        html += "<option value='0'" + String(!Settings.saveStats ? " selected" : "") + ">No</option>";
-        html += "</select><br>";
-
-        // Add loading animation styles
-        html += "<style>";
-        html += ".loading { display: none; position: fixed; top: 0; left: 0; width: 100%; height: 100%; background: rgba(0,0,0,0.9); z-index: 1000; }";
-        html += ".loading-content { position: absolute; top: 50%; left: 50%; transform: translate(-50%, -50%); text-align: center; color: #00ff00; }";
-        html += ".spinner { width: 50px; height: 50px; border: 5px solid #1a1a1a; border-top: 5px solid #00ff00; border-radius: 50%; animation: spin 1s linear infinite; margin: 0 auto 20px; }";
-        html += "@keyframes spin { 0% { transform: rotate(0deg); } 100% { transform: rotate(360deg); } }";
-        html += ".container { text-align: center; }";
-        html += "</style>";
-        
-        // Add loading overlay
-        html += "<div id='loadingOverlay' class='loading'>";
-        html += "<div class='loading-content'>";
-        html += "<div class='spinner'></div>";
-        html += "<div id='statusText'>Saving configuration...</div>";
-        html += "</div>";
-        html += "</div>";
-
-        // Submit Button
-        html += "<input type='submit' value='Save Configuration' class='submit-btn'>";
-        html += "</form>";
-        
-        // Add factory reset button with confirmation dialog
-        html += "<script>";
-        html += "function factoryReset() {";
-        html += "  if (confirm('Are you sure you want to reset to factory defaults? This will erase all settings and restart the device.')) {";
-        html += "    document.getElementById('loadingOverlay').style.display = 'flex';";
-        html += "    document.getElementById('statusText').innerText = 'Resetting to factory defaults...';";
-        html += "    fetch('/factory-reset', { method: 'POST' })";
-        html += "      .then(response => {";
-        html += "        if (!response.ok) throw new Error('Reset failed');";
-        html += "        alert('Factory reset successful. Device will restart now. Please wait 30 seconds then reconnect to the device\\'s AP to reconfigure.');";
-        html += "        setTimeout(() => { window.location.href = '/'; }, 5000);";  // Redirect after 5 seconds
-        html += "      })";
-        html += "      .catch(error => {";
-        html += "        console.error('Error:', error);";
-        html += "        alert('Error during factory reset. Device will restart. Please reconnect to the AP mode to reconfigure.');";
-        html += "        document.getElementById('loadingOverlay').style.display = 'none';";
-        html += "      });";
-        html += "  }";
-        html += "}";
-        html += "</script>";
-        
-        // Add factory reset button with more spacing and warning color
-        html += "<button onclick='factoryReset()' style='margin-top: 20px; background-color: #ff4444;' class='factory-reset'>Factory Reset</button>";
-        
-        html += "</div></body></html>";
-        
-        webServer.sendHeader("Content-Type", "text/html; charset=UTF-8");
-        webServer.send(200, "text/html", html);
+        s->textLen = len;
+        s->textPos = 0;
+    }
+    return n;
+}
+
+// Per minute history, ?from=&to= in local seconds since 1970, the last day by default
+static void sendHistory(AsyncWebServerRequest *request) {
+    if (historyStreams >= HISTORY_STREAMS) {
+        request->send(503, "application/json", generateJsonResponse(false, "Busy, try again"));
+        return;
+    }
+    history_stream *s = (history_stream *)calloc(1, sizeof(history_stream));
+    if (s == NULL) {
+        request->send(503, "application/json", generateJsonResponse(false, "Out of memory"));
+        return;
+    }
+
+    uint32_t now = getEpochSeconds();
+    s->to = request->hasArg("to") ? request->arg("to").toInt() : (now ? now : UINT32_MAX);
+    uint32_t from = request->hasArg("from") ? request->arg("from").toInt() : (s->to > 86400 ? s->to - 86400 : 0);
+    s->next = from;
+    history_status status = getHistoryStatus();
+    s->textLen = snprintf(s->text, sizeof(s->text),
+                          "{\"from\":%u,\"to\":%u,\"oldest\":%u,\"ramBytes\":%u,\"fileBytes\":%u,\"flashWrites\":%u,"
+                          "\"fields\":[\"time\",\"hashrate\",\"shares\",\"temperature\",\"rssi\",\"state\"],\"samples\":[",
+                          from, s->to, status.oldest, status.ramBytes, status.fileBytes, status.flashWrites);
+
+    // The response owns the stream, it is freed with it even when the client goes away
+    historyStreams++;
+    std::shared_ptr<history_stream> stream(s, [](history_stream *p) {
+        historyStreams--;
+        free(p);
     });
+    request->send(request->beginChunkedResponse("application/json", [stream](uint8_t *buffer, size_t maxLen, size_t) -> size_t {
+        return fillHistory(stream.get(), buffer, maxLen);
+    }));
+}
+
+// Work that can't run in the async_tcp task, done by wifiManagerProcess() in the loop.
+// Queuing it wakes the loop, which otherwise sleeps until an input or WiFi event
+typedef struct {
+    bool apply;                         // Settings saved by /save
+    bool restart;                       // WiFi changed
+    bool factoryReset;
+    bool display;
+    bool displayEnabled;
+    bool timezone;
+    int timezoneOffset;
+    bool saveStats;
+    unsigned long at;                   // millis() of the response, restarts wait for it to go out
+} portal_pending;
+
+static portal_pending pending;
+static portMUX_TYPE pendingMux = portMUX_INITIALIZER_UNLOCKED;
+
+#define PORTAL_RESTART_DELAY_ms 1000
+
+static void applyPending(void) {
+    portENTER_CRITICAL(&pendingMux);
+    portal_pending p = pending;
+    bool due = millis() - p.at >= PORTAL_RESTART_DELAY_ms;
+    if (p.apply && (!(p.restart || p.factoryReset) || due)) memset(&pending, 0, sizeof(pending));
+    portEXIT_CRITICAL(&pendingMux);
+
+    if (!p.apply) return;
+    if (p.factoryReset) {
+        if (due) reset_configuration();
+        return;
+    }
+    if (p.restart) {
+        if (due) ESP.restart();
+        return;
+    }
+    if (p.timezone) setTimezone(p.timezoneOffset);
+    if (p.display) {
+        Settings.displayEnabled = p.displayEnabled;
+        toggleDisplay(Settings.displayEnabled);
+    }
+    Settings.saveStats = p.saveStats;
+}
+
+static void queuePending(const portal_pending &p) {
+    portENTER_CRITICAL(&pendingMux);
+    pending = p;
+    pending.apply = true;
+    pending.at = millis();
+    portEXIT_CRITICAL(&pendingMux);
+    postInput(INPUT_PORTAL);
+}
+
+/// @brief How long the loop may sleep before wifiManagerProcess() has work no event announces
+uint32_t wifiManagerTimeoutMs(void) {
+    // DNS requests of the captive portal are polled
+    if (WiFi.getMode() & WIFI_AP) return INPUT_PORTAL_ms;
+
+    portENTER_CRITICAL(&pendingMux);
+    portal_pending p = pending;
+    portEXIT_CRITICAL(&pendingMux);
+    if (p.apply && (p.restart || p.factoryReset)) {
+        uint32_t waited = millis() - p.at;
+        return waited < PORTAL_RESTART_DELAY_ms ? PORTAL_RESTART_DELAY_ms - waited : 0;
+    }
+    return wifiManager.timeoutMs();
+}
+
+void setupWebServer() {
+    // The async server listens on every interface, it is set up once
+    static bool started = false;
+    if (started) return;
+    started = true;
+
+    // Portal pages, prebuilt by tools/build_portal.py
+    for (size_t i = 0; i < PORTAL_ASSET_COUNT; i++) {
+        webServer.on(PORTAL_ASSETS[i].path, HTTP_GET, [i](AsyncWebServerRequest *request) { sendPortalAsset(request, i); });
+    }
 
     // Captive portal handling
-    webServer.on("/generate_204", HTTP_GET, []() {
-        webServer.sendHeader("Location", "/");
-        webServer.send(302, "text/plain", "");
+    webServer.on("/generate_204", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->redirect("/");
     });
 
-    webServer.on("/fwlink", HTTP_GET, []() {
-        webServer.sendHeader("Location", "/");
-        webServer.send(302, "text/plain", "");
+    webServer.on("/fwlink", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->redirect("/");
     });
 
-    // WiFi scan route
-    webServer.on("/scan-wifi", HTTP_GET, []() {
-        int n = WiFi.scanNetworks();
+    // WiFi scan route, the scan runs in the background and the portal polls until it is done
+    webServer.on("/scan-wifi", HTTP_GET, [](AsyncWebServerRequest *request) {
+        int n = WiFi.scanComplete();
+        if (n == WIFI_SCAN_FAILED) {
+            WiFi.scanNetworks(true);
+            n = WIFI_SCAN_RUNNING;
+        }
+        if (n == WIFI_SCAN_RUNNING) {
+            request->send(202, "application/json", "{\"scanning\":true,\"networks\":[]}");
+            return;
+        }
         String json = "{\"networks\":[";
         for (int i = 0; i < n; ++i) {
             if (i > 0) json += ",";
@@ -445,27 +381,42 @@ void setupWebServer() {
             json += "}";
         }
         json += "]}";
-        
-        webServer.send(200, "application/json", json);
-        WiFi.scanDelete(); // Clean up scan results
+
+        request->send(200, "application/json", json);
+        WiFi.scanDelete(); // Clean up scan results, the next request scans again
     });
 
     // Configuration save route
-    webServer.on("/save", HTTP_POST, []() {
+    webServer.on("/save", HTTP_POST, [](AsyncWebServerRequest *request) {
+        int64_t start = esp_timer_get_time();
+        size_t heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
         nvMemory nvMem;
         TSettings savedSettings;
-        
+        // The stratum task may be switching the pool of Settings, it is read from a copy
+        pool_settings pool = getPoolSettings();
+
         // First, try to load existing configuration
         if (!nvMem.loadConfig(&savedSettings)) {
-            // If no existing config, initialize with defaults
-            savedSettings = Settings;
+            // If no existing config, initialize with the running one
+            savedSettings.WifiSSID = Settings.WifiSSID;
+            savedSettings.WifiPW = Settings.WifiPW;
+            savedSettings.PoolAddress = pool.address;
+            savedSettings.PoolPort = pool.port;
+            strlcpy(savedSettings.BtcWallet, pool.wallet, sizeof(savedSettings.BtcWallet));
+            strlcpy(savedSettings.PoolPassword, pool.password, sizeof(savedSettings.PoolPassword));
+            savedSettings.displayEnabled = Settings.displayEnabled;
+            savedSettings.ledEnabled = Settings.ledEnabled;
+            savedSettings.invertColors = Settings.invertColors;
+            savedSettings.Timezone = Settings.Timezone;
+            savedSettings.saveStats = Settings.saveStats;
+            savedSettings.LogLevel = Settings.LogLevel;
         }
 
         // Validate and update settings
-        if (webServer.hasArg("wifiSelect")) {
-            String selectedSSID = webServer.arg("wifiSelect");
-            String customSSID = webServer.arg("customNetworkInput");
-            String wifiPassword = webServer.arg("wifiPassword");
+        if (request->hasArg("wifiSelect")) {
+            String selectedSSID = request->arg("wifiSelect");
+            String customSSID = request->arg("customNetworkInput");
+            String wifiPassword = request->arg("wifiPassword");
 
             if (selectedSSID == "custom" && !customSSID.isEmpty()) {
                 savedSettings.WifiSSID = customSSID;
@@ -479,13 +430,13 @@ void setupWebServer() {
         }
 
         // Pool Configuration
-        if (webServer.hasArg("poolSelect")) {
-            int poolIndex = webServer.arg("poolSelect").toInt();
-            if (poolIndex >= 0 && poolIndex < POOL_COUNT) {
+        if (request->hasArg("poolSelect")) {
+            int poolIndex = request->arg("poolSelect").toInt();
+            if (poolIndex >= 0 && (size_t)poolIndex < POOL_COUNT) {
                 if (poolIndex == 0) {  // Custom Pool
-                    if (webServer.hasArg("poolUrl") && webServer.hasArg("poolPort")) {
-                        savedSettings.PoolAddress = webServer.arg("poolUrl").c_str();
-                        savedSettings.PoolPort = webServer.arg("poolPort").toInt();
+                    if (request->hasArg("poolUrl") && request->hasArg("poolPort")) {
+                        savedSettings.PoolAddress = request->arg("poolUrl").c_str();
+                        savedSettings.PoolPort = request->arg("poolPort").toInt();
                     }
                 } else {
                     savedSettings.PoolAddress = POOLS[poolIndex].url;
@@ -495,74 +446,65 @@ void setupWebServer() {
         }
 
         // Wallet Configuration
-        if (webServer.hasArg("wallet")) {
-            strncpy(savedSettings.BtcWallet, webServer.arg("wallet").c_str(), sizeof(savedSettings.BtcWallet) - 1);
+        if (request->hasArg("wallet")) {
+            strncpy(savedSettings.BtcWallet, request->arg("wallet").c_str(), sizeof(savedSettings.BtcWallet) - 1);
         }
 
-        if (webServer.hasArg("password")) {
-            strncpy(savedSettings.PoolPassword, webServer.arg("password").c_str(), sizeof(savedSettings.PoolPassword) - 1);
+        // Like the WiFi password it is never sent to the portal, left empty it is kept
+        if (request->hasArg("password") && !request->arg("password").isEmpty()) {
+            strncpy(savedSettings.PoolPassword, request->arg("password").c_str(), sizeof(savedSettings.PoolPassword) - 1);
         }
 
         // Display Configuration
-        if (webServer.hasArg("display_enabled")) {
-            savedSettings.displayEnabled = webServer.arg("display_enabled").toInt() == 0;
+        if (request->hasArg("display_enabled")) {
+            savedSettings.displayEnabled = request->arg("display_enabled").toInt() == 0;
         }
 
         // Timezone Configuration
-        if (webServer.hasArg("timezone")) {
-            savedSettings.Timezone = webServer.arg("timezone").toInt();
+        if (request->hasArg("timezone")) {
+            savedSettings.Timezone = request->arg("timezone").toInt();
         }
 
         // Save Statistics Configuration
-        if (webServer.hasArg("save_stats")) {
-            savedSettings.saveStats = webServer.arg("save_stats").toInt() == 1;
+        if (request->hasArg("save_stats")) {
+            savedSettings.saveStats = request->arg("save_stats").toInt() == 1;
         }
 
-        // Create a detailed HTML response with saved parameters
-        String htmlResponse = "<!DOCTYPE html><html><head><title>Configuration Saved</title>";
-        htmlResponse += "<style>body { font-family: Arial, sans-serif; max-width: 600px; margin: 0 auto; padding: 20px; }";
-        htmlResponse += "table { width: 100%; border-collapse: collapse; }";
-        htmlResponse += "th, td { border: 1px solid #ddd; padding: 8px; text-align: left; }";
-        htmlResponse += "h1 { color: #4CAF50; }</style></head><body>";
-        htmlResponse += "<h1>Configuration Saved Successfully</h1>";
-        htmlResponse += "<table>";
-        
-        // WiFi Settings
-        htmlResponse += "<tr><th colspan='2'>WiFi Configuration</th></tr>";
-        htmlResponse += "<tr><td>Network SSID</td><td>" + savedSettings.WifiSSID + "</td></tr>";
-        
-        // Pool Settings
-        htmlResponse += "<tr><th colspan='2'>Pool Configuration</th></tr>";
-        htmlResponse += "<tr><td>Pool URL</td><td>" + String(savedSettings.PoolAddress) + "</td></tr>";
-        htmlResponse += "<tr><td>Pool Port</td><td>" + String(savedSettings.PoolPort) + "</td></tr>";
-        
-        // Wallet Settings
-        htmlResponse += "<tr><th colspan='2'>Wallet Configuration</th></tr>";
-        htmlResponse += "<tr><td>BTC Wallet Address</td><td>" + String(savedSettings.BtcWallet) + "</td></tr>";
-        
-        // Additional Settings
-        htmlResponse += "<tr><th colspan='2'>Additional Settings</th></tr>";
-        htmlResponse += "<tr><td>Timezone</td><td>" + String(savedSettings.Timezone) + "</td></tr>";
-        htmlResponse += "<tr><td>Save Statistics</td><td>" + String(savedSettings.saveStats ? "Enabled" : "Disabled") + "</td></tr>";
-        htmlResponse += "<tr><td>Display Enabled</td><td>" + String(savedSettings.displayEnabled ? "Yes" : "No") + "</td></tr>";
-        
-        htmlResponse += "</table>";
-        htmlResponse += "<p>Device will restart in 3 seconds...</p>";
-        htmlResponse += "<script>setTimeout(function(){window.location.href='/';}, 3000);</script>";
-        htmlResponse += "</body></html>";
+        // Only a new WiFi network needs a restart, everything else is applied to the running miner
+        bool wifiChanged = savedSettings.WifiSSID != Settings.WifiSSID || savedSettings.WifiPW != Settings.WifiPW;
+        bool poolChanged = savedSettings.PoolAddress != pool.address || savedSettings.PoolPort != pool.port ||
+                           strcmp(savedSettings.BtcWallet, pool.wallet) != 0 ||
+                           strcmp(savedSettings.PoolPassword, pool.password) != 0;
+
+        // The portal shows the saved settings from /api/settings, only the outcome is sent
+        char response[96];
+        snprintf(response, sizeof(response), "{\"success\":true,\"restart\":%s,\"poolChanged\":%s}",
+                 wifiChanged ? "true" : "false", poolChanged ? "true" : "false");
 
         // Save the updated configuration
         if (nvMem.saveConfig(&savedSettings)) {
-            webServer.send(200, "text/html", htmlResponse);
-            delay(1000);
-            ESP.restart();
+            request->send(200, "application/json", response);
+            portalMeasured(PORTAL_SAVE_ROUTE, 200, start, heap);
+            if (poolChanged && !wifiChanged) {
+                requestPoolReload(savedSettings.PoolAddress, savedSettings.PoolPort, savedSettings.BtcWallet, savedSettings.PoolPassword);
+            }
+            // The restart, display and clock belong to the loop task
+            portal_pending p = {};
+            p.restart = wifiChanged;
+            p.display = savedSettings.displayEnabled != Settings.displayEnabled;
+            p.displayEnabled = savedSettings.displayEnabled;
+            p.timezone = savedSettings.Timezone != Settings.Timezone;
+            p.timezoneOffset = savedSettings.Timezone;
+            p.saveStats = savedSettings.saveStats;
+            queuePending(p);
         } else {
-            webServer.send(500, "text/plain", "Failed to save configuration");
+            request->send(500, "application/json", generateJsonResponse(false, "Failed to save configuration"));
+            portalMeasured(PORTAL_SAVE_ROUTE, 500, start, heap);
         }
     });
 
     // API routes for dynamic data
-    webServer.on("/api/pools", HTTP_GET, []() {
+    webServer.on("/api/pools", HTTP_GET, [](AsyncWebServerRequest *request) {
         String jsonResponse = "[";
         for (size_t i = 0; i < POOL_COUNT; i++) {
             jsonResponse += "{";
@@ -575,37 +517,115 @@ void setupWebServer() {
             if (i < POOL_COUNT - 1) jsonResponse += ",";
         }
         jsonResponse += "]";
-        webServer.send(200, "application/json", jsonResponse);
+        request->send(200, "application/json", jsonResponse);
     });
 
-    webServer.on("/api/settings", HTTP_GET, []() {
+    webServer.on("/api/timezones", HTTP_GET, [](AsyncWebServerRequest *request) {
+        String jsonResponse = "[";
+        for (int i = 0; i < TIMEZONE_COUNT; i++) {
+            jsonResponse += "{\"name\":\"" + String(TIMEZONE_LIST[i].name) + "\",\"offset\":" + String(TIMEZONE_LIST[i].offset) + "}";
+            if (i < TIMEZONE_COUNT - 1) jsonResponse += ",";
+        }
+        jsonResponse += "]";
+        request->send(200, "application/json", jsonResponse);
+    });
+
+    webServer.on("/api/settings", HTTP_GET, [](AsyncWebServerRequest *request) {
+        pool_settings pool = getPoolSettings();
         String jsonResponse = "{";
         jsonResponse += "\"wifiSSID\":\"" + Settings.WifiSSID + "\",";
-        jsonResponse += "\"poolUrl\":\"" + String(Settings.PoolAddress) + "\",";
-        jsonResponse += "\"poolPort\":" + String(Settings.PoolPort) + ",";
-        jsonResponse += "\"btcWallet\":\"" + String(Settings.BtcWallet) + "\",";
-        jsonResponse += "\"poolPassword\":\"" + String(Settings.PoolPassword) + "\",";
+        jsonResponse += "\"poolUrl\":\"" + pool.address + "\",";
+        jsonResponse += "\"poolPort\":" + String(pool.port) + ",";
+        jsonResponse += "\"btcWallet\":\"" + String(pool.wallet) + "\",";
         jsonResponse += "\"timezone\":" + String(Settings.Timezone) + ",";
         jsonResponse += "\"saveStats\":" + String(Settings.saveStats ? "true" : "false") + ",";
         jsonResponse += "\"displayEnabled\":" + String(Settings.displayEnabled ? "true" : "false");
         jsonResponse += "}";
-        webServer.send(200, "application/json", jsonResponse);
+        request->send(200, "application/json", jsonResponse);
     });
 
-    // Add factory reset endpoint
-    webServer.on("/factory-reset", HTTP_POST, []() {
-        String response = generateJsonResponse(true, "Factory reset initiated");
-        webServer.send(200, "application/json", response);
-        webServer.client().flush();
-        delay(1000); // Give more time for the response to be sent
-        reset_configuration();
+    webServer.on("/api/stats", HTTP_GET, [](AsyncWebServerRequest *request) {
+        miner_stats stats = getMinerStats();
+        hashrate_data rate = getHashrate();
+        String jsonResponse = "{";
+        jsonResponse += "\"hashrate\":{\"1m\":" + String(rate.avg1m, 0) + ",\"15m\":" + String(rate.avg15m, 0) + ",\"1h\":" + String(rate.avg1h, 0) + ",\"workers\":[";
+        for (uint8_t i = 0; i < STATS_MAX_WORKERS; i++)
+            jsonResponse += String(rate.worker[i], 0) + (i < STATS_MAX_WORKERS - 1 ? "," : "");
+        jsonResponse += "]},";
+        jsonResponse += "\"hashes\":" + String(stats.hashes) + ",";
+        jsonResponse += "\"shares\":" + String(stats.shares) + ",";
+        jsonResponse += "\"valids\":" + String(stats.valids) + ",";
+        jsonResponse += "\"templates\":" + String(stats.templates) + ",";
+        jsonResponse += "\"bestDiff\":" + String(stats.best_diff, 6) + ",";
+        jsonResponse += "\"upTime\":" + String(stats.upTime) + ",";
+        stats_store_status store = getStatsStoreStatus();
+        jsonResponse += "\"nvs\":{\"writes\":" + String(store.writes) + ",\"bootWrites\":" + String(store.bootWrites) +
+                        ",\"lastSaveAge\":" + String(store.lastSaveAge) + ",\"eraseCycles\":" + String(store.eraseCycles, 3) + "},";
+        journal_stats journal = getJournalStats();
+        jsonResponse += "\"journal\":{\"events\":" + String(journal.events) + ",\"dropped\":" + String(journal.dropped) +
+                        ",\"blocks\":" + String(journal.blocks) + ",\"bytes\":" + String((uint32_t)journal.bytes) +
+                        ",\"pending\":" + String(journal.pending) + ",\"writeErrors\":" + String(journal.writeErrors) +
+                        ",\"maxEnqueueUs\":" + String(journal.maxEnqueueUs) + ",\"maxWriteUs\":" + String(journal.maxWriteUs) +
+                        ",\"cardReady\":" + String(journal.cardReady ? "true" : "false") + "},";
+        boot_timeline boot = getBootTimeline();
+        jsonResponse += "\"boot\":{\"firstHashMs\":" + String(boot.stageMs[BOOT_FIRST_HASH]) +
+                        ",\"wifiMs\":" + String(boot.stageMs[BOOT_WIFI_CONNECTED]) + ",\"poolMs\":" + String(boot.stageMs[BOOT_POOL_CONNECTED]) +
+                        ",\"firstJobMs\":" + String(boot.stageMs[BOOT_FIRST_JOB]) + ",\"wifiCached\":" + String(boot.wifiCached ? "true" : "false") +
+                        ",\"poolCached\":" + String(boot.poolCached ? "true" : "false") +
+                        ",\"resetReason\":" + String(boot.resetReason) + "},";
+        jsonResponse += "\"portal\":[";
+        for (size_t i = 0; i <= PORTAL_SAVE_ROUTE; i++) {
+            const portal_route_stats &p = portalStats[i];
+            jsonResponse += String(i ? "," : "") + "{\"path\":\"" + (i == PORTAL_SAVE_ROUTE ? "/save" : PORTAL_ASSETS[i].path) +
+                            "\",\"requests\":" + String(p.requests) + ",\"notModified\":" + String(p.notModified) +
+                            ",\"avgUs\":" + String(p.requests ? (uint32_t)(p.totalUs / p.requests) : 0) +
+                            ",\"maxUs\":" + String(p.maxUs) + ",\"maxHeapDelta\":" + String(p.maxHeapDelta) + "}";
+        }
+        jsonResponse += "],";
+        jsonResponse += "\"largestFreeBlock\":" + String(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+        jsonResponse += "}";
+        request->send(200, "application/json", jsonResponse);
+    });
+
+    // Aggregated stats of the miners heard on the LAN
+    webServer.on("/api/fleet", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", getFleetJson());
+    });
+
+    // Age and errors of the cached API data
+    webServer.on("/api/fetch", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", getFetchJson());
+    });
+
+    // Monitor CPU load and hashrate per render budget
+    webServer.on("/api/render", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", getRenderJson());
+    });
+
+    // budget=<per mille> changes it, a POST like /save so no prefetch can
+    webServer.on("/api/render", HTTP_POST, [](AsyncWebServerRequest *request) {
+        if (!request->hasArg("budget")) {
+            request->send(400, "application/json", generateJsonResponse(false, "Missing budget"));
+            return;
+        }
+        setRenderBudget(request->arg("budget").toInt());
+        request->send(200, "application/json", getRenderJson());
+    });
+
+    webServer.on("/api/history", HTTP_GET, sendHistory);
+
+    // Add factory reset endpoint, the loop resets once the answer is out
+    webServer.on("/factory-reset", HTTP_POST, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", generateJsonResponse(true, "Factory reset initiated"));
+        portal_pending p = {};
+        p.factoryReset = true;
+        queuePending(p);
     });
 
     // 404 handler
-    webServer.onNotFound([]() {
+    webServer.onNotFound([](AsyncWebServerRequest *request) {
         // Redirect all unhandled routes to root
-        webServer.sendHeader("Location", "/");
-        webServer.send(302, "text/plain", "");
+        request->redirect("/");
     });
 
     // Start the web server
@@ -671,8 +691,8 @@ void wifiManagerProcess() {
         dnsServer.processNextRequest();
     }
 
-    // Always handle web server client requests
-    webServer.handleClient();
+    // Requests are served by the async server, only what they left for the loop is done here
+    applyPending();
 
     // Connection state monitoring
     static bool wasConnected = false;
@@ -683,10 +703,6 @@ void wifiManagerProcess() {
         Serial.print("IP Address: ");
         Serial.println(wifiManager.getLocalIP());
         
-        // Explicitly restart web server when WiFi connects
-        Serial.println("Restarting Web Server after WiFi Connection");
-        setupWebServer();
-        
         mMonitor.NerdStatus = NM_Connecting;
         wasConnected = true;
     } else if (!isConnected && wasConnected) {
@@ -695,7 +711,8 @@ void wifiManagerProcess() {
         wasConnected = false;
     }
 
-    // Optional: Add a timeout for configuration portal
+    // Timeout for the configuration portal, counted while the access point is up (the loop is polled then)
+    if (!(WiFi.getMode() & WIFI_AP)) portalStartTime = millis();
     if (portalRunning && (millis() - portalStartTime > CONFIG_PORTAL_TIMEOUT)) {
         // If WiFi credentials exist, attempt to connect instead of restarting
         if (Settings.WifiSSID.length() > 0 && Settings.WifiPW.length() > 0) {
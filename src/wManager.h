@@ -2,7 +2,6 @@
 #define _WMANAGER_H_
 
 #include <Arduino.h>
-#include <WebServer.h>
 #include <DNSServer.h>
 #include "drivers/storage/nvMemory.h"
 #include "settings.h"
@@ -39,6 +38,7 @@ extern const int TIMEZONE_COUNT;
 // Function declarations
 void init_WifiManager();
 void wifiManagerProcess();
+uint32_t wifiManagerTimeoutMs(void);
 void setupParameters();
 void reset_configuration();
 void saveNewConfig();
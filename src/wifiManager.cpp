@@ -2,6 +2,8 @@
 #include "wManager.h"  // For mMonitor and TSettings
 #include <WiFi.h>
 #include "log.h"
+#include "fastBoot.h"
+#include "inputEvents.h"
 
 // Declare external global variables
 extern nvMemory nvMem;
@@ -19,8 +21,24 @@ void WiFiManagerClass::resetConfigPortalTimeout() {
 void WiFiManagerClass::init() {
     LOG(LOG_INFO, "WiFi Manager Initialization\n");
     
-    // Load WiFi settings from non-volatile storage
-    nvMem.loadConfig(&Settings);
+    // WiFi started before the splash with the saved settings, keep that connection
+    if (fastBootStarted()) {
+        if (fastBootWait()) {
+            LOG(LOG_INFO, "WiFi Connected during the splash, IP Address: %s\n", WiFi.localIP().toString().c_str());
+            currentState = NM_Connected;
+            mMonitor.NerdStatus = NM_Connected;
+            return;
+        }
+        if (!fastBootCached()) {
+            LOG(LOG_WARN, "WiFi Connection Timeout!\n");
+            startAccessPoint();
+            return;
+        }
+        LOG(LOG_WARN, "Cached WiFi connection failed, connecting normally\n");
+    } else {
+        // Load WiFi settings from non-volatile storage
+        nvMem.loadConfig(&Settings);
+    }
     
     // Comprehensive WiFi reset
     WiFi.disconnect(true, true);  // Disconnect and clear credentials
@@ -147,6 +165,7 @@ void WiFiManagerClass::process() {
                     
                     mMonitor.NerdStatus = NM_Connected;
                     currentState = NM_Connected;
+                    fastBootSaveWifi();
                 } 
                 else if (millis() - lastConnectionAttempt > CONNECTION_TIMEOUT) {
                     LOG(LOG_WARN, "Connection timeout, starting Access Point\n");
@@ -359,6 +378,7 @@ void WiFiManagerClass::connectToSavedNetwork() {
     // Update connection state
     currentState = NM_Connected;
     mMonitor.NerdStatus = NM_Connected;
+    fastBootSaveWifi();
 }
 
 void WiFiManagerClass::disconnect() {
@@ -371,6 +391,17 @@ bool WiFiManagerClass::isConnected() const {
     return WiFi.status() == WL_CONNECTED;
 }
 
+/// @brief How long process() can wait before one of its timeouts is due, INPUT_FOREVER when none is
+uint32_t WiFiManagerClass::timeoutMs() const {
+    // Configuration mode, the access point is set up and polled on the portal cadence
+    if (mMonitor.NerdStatus == NM_waitingConfig) return INPUT_PORTAL_ms;
+
+    // Getting an IP or losing the connection are WiFi events, only a connection attempt can time out
+    if (currentState != NM_Connecting) return INPUT_FOREVER;
+    uint32_t waited = millis() - lastConnectionAttempt;
+    return waited < CONNECTION_TIMEOUT ? CONNECTION_TIMEOUT - waited : 0;
+}
+
 String WiFiManagerClass::getLocalIP() const {
     return WiFi.localIP().toString();
 }
@@ -25,6 +25,7 @@ public:
     // State and connection queries
     NMState getState() const { return currentState; }
     bool isConnected() const;
+    uint32_t timeoutMs() const;
     
     // Network information
     String getLocalIP() const;
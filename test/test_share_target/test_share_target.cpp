@@ -0,0 +1,102 @@
+#include <unity.h>
+#include <string.h>
+#include "shareTarget.h"
+
+// Share and block classification of src/shareTarget.cpp against known values.
+//   pio test -e native-test
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Genesis / difficulty 1: 0x00000000ffff0000000000000000000000000000000000000000000000000000
+static const uint32_t diff1Target[8] = {0, 0, 0, 0, 0, 0, 0xffff0000, 0};
+
+// Block 840000, nbits 0x17034219: 0x0000000000000000000342190000000000000000000000000000000000000000
+static const uint32_t block840000Target[8] = {0, 0, 0, 0, 0, 0x00034219, 0, 0};
+
+static void test_target_from_nbits_diff1(void)
+{
+    uint32_t target[8];
+    targetFromNbits(0x1d00ffff, target);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(diff1Target, target, 8);
+}
+
+static void test_target_from_nbits_mainnet(void)
+{
+    uint32_t target[8];
+    targetFromNbits(0x17034219, target);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(block840000Target, target, 8);
+}
+
+static void test_target_from_difficulty(void)
+{
+    uint32_t target[8];
+    targetFromDifficulty(1, target);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(diff1Target, target, 8);
+
+    const uint32_t diff2Target[8] = {0, 0, 0, 0, 0, 0, 0x7fff8000, 0};
+    targetFromDifficulty(2, target);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(diff2Target, target, 8);
+
+    // Below difficulty 2^-32 the target no longer fits, everything meets it
+    const uint32_t maxTarget[8] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+                                   0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+    targetFromDifficulty(1e-12, target);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(maxTarget, target, 8);
+    targetFromDifficulty(0, target);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(maxTarget, target, 8);
+}
+
+static void test_hash_meets_target_boundaries(void)
+{
+    const uint32_t *targets[] = {diff1Target, block840000Target};
+    for (const uint32_t *target : targets) {
+        uint32_t hash[8];
+
+        // hash == target
+        memcpy(hash, target, sizeof(hash));
+        TEST_ASSERT_TRUE(hashMeetsTarget(hash, target));
+
+        // hash == target + 1, the low word of both targets is 0
+        hash[0] = 1;
+        TEST_ASSERT_FALSE(hashMeetsTarget(hash, target));
+
+        // hash == target - 1, the borrow runs up to the first word that is not 0
+        memcpy(hash, target, sizeof(hash));
+        int i = 0;
+        while (hash[i] == 0) hash[i++] = 0xffffffff;
+        hash[i]--;
+        TEST_ASSERT_TRUE(hashMeetsTarget(hash, target));
+
+        // Only the most significant words decide
+        memcpy(hash, target, sizeof(hash));
+        hash[7]++;
+        hash[0] = 0;
+        TEST_ASSERT_FALSE(hashMeetsTarget(hash, target));
+    }
+}
+
+// The miner skips hashes with fewer leading zeros than zerosForDiff(), it must
+// never skip one that meets the target of that difficulty
+static void test_zeros_for_diff_never_skips_a_share(void)
+{
+    const double diffs[] = {1e-4, 0.5, 1, 2, 3, 1000, 65536, 1e6, 1e12, 83148355189239.77};
+    for (double diff : diffs) {
+        uint32_t target[8];
+        targetFromDifficulty(diff, target);
+        TEST_ASSERT_GREATER_OR_EQUAL_INT(zerosForDiff(diff), leadingZeros256(target));
+    }
+    TEST_ASSERT_EQUAL_INT(32, zerosForDiff(1));
+    TEST_ASSERT_EQUAL_INT(0, zerosForDiff(0));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_target_from_nbits_diff1);
+    RUN_TEST(test_target_from_nbits_mainnet);
+    RUN_TEST(test_target_from_difficulty);
+    RUN_TEST(test_hash_meets_target_boundaries);
+    RUN_TEST(test_zeros_for_diff_never_skips_a_share);
+    return UNITY_END();
+}
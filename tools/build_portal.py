@@ -0,0 +1,130 @@
+# Web portal assets
+#
+# Minifies and gzips the configuration portal (src/portal/*.html, .css, .js)
+# into src/portal/portal_assets.h, a table of flash arrays the web server
+# sends as they are with Content-Encoding: gzip. Runs before every PlatformIO
+# build (extra_scripts = pre:) and only rewrites the header when a source or
+# this script changed. Can also be run by hand:
+#
+#   python tools/build_portal.py
+#
+# The minifier is deliberately simple: it drops comments, indentation and
+# blank lines but keeps the line breaks, so statements ended by a line break
+# still parse. JavaScript comments must be on lines of their own (// ...),
+# gzip takes care of the rest.
+# Each asset gets an ETag from the hash of its compressed bytes.
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+# URL path, source file, content type
+ASSETS = [
+    ("/", "index.html", "text/html; charset=UTF-8"),
+    ("/portal.css", "portal.css", "text/css"),
+    ("/portal.js", "portal.js", "application/javascript"),
+]
+
+TARGET = "portal_assets.h"
+
+
+def minify(name, text):
+    if name.endswith(".html"):
+        text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    elif name.endswith(".css"):
+        text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    lines = []
+    for line in text.splitlines():
+        line = line.strip()
+        if not line or (name.endswith(".js") and line.startswith("//")):
+            continue
+        lines.append(line)
+    text = "\n".join(lines)
+    if name.endswith(".css"):
+        text = re.sub(r"\s*([{};:,>])\s*", r"\1", text)
+        text = text.replace(";}", "}")
+    return text
+
+
+def format_bytes(data, indent="  ", per_line=24):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join("0x%02X" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def convert(portal, target):
+    guard = re.sub(r"\W", "_", os.path.basename(target)).upper()
+    out = []
+    out.append("// Generated by tools/build_portal.py from src/portal, do not edit")
+    out.append("#ifndef %s" % guard)
+    out.append("#define %s" % guard)
+    out.append("")
+    out.append("#include <Arduino.h>")
+    out.append("")
+    out.append("typedef struct {")
+    out.append("  const char *path;")
+    out.append("  const char *contentType;")
+    out.append("  const char *etag;")
+    out.append("  const uint8_t *data;                 // gzip")
+    out.append("  uint32_t size;")
+    out.append("} portal_asset;")
+    out.append("")
+
+    report = []
+    table = []
+    for path, source, content_type in ASSETS:
+        with open(os.path.join(portal, source), "r", encoding="utf-8") as f:
+            raw = f.read().encode("utf-8")
+        small = minify(source, raw.decode("utf-8")).encode("utf-8")
+        # mtime 0 keeps the bytes, and so the ETag, identical between builds
+        data = gzip.compress(small, compresslevel=9, mtime=0)
+        etag = hashlib.sha1(data).hexdigest()[:16]
+        name = "portal_" + re.sub(r"\W", "_", source)
+        out.append("static const uint8_t %s[%d] PROGMEM = {" % (name, len(data)))
+        out.append(format_bytes(data))
+        out.append("};")
+        out.append("")
+        table.append('  {"%s", "%s", "\\"%s\\"", %s, %d},' % (path, content_type, etag, name, len(data)))
+        report.append((source, len(raw), len(small), len(data)))
+
+    out.append("static const portal_asset PORTAL_ASSETS[] = {")
+    out.extend(table)
+    out.append("};")
+    out.append("")
+    out.append("#define PORTAL_ASSET_COUNT (sizeof(PORTAL_ASSETS) / sizeof(PORTAL_ASSETS[0]))")
+    out.append("")
+    out.append("#endif // %s" % guard)
+    out.append("")
+
+    with open(target, "w") as f:
+        f.write("\n".join(out))
+    return report
+
+
+def run(project_dir):
+    portal = os.path.join(project_dir, "src", "portal")
+    target = os.path.join(portal, TARGET)
+    script = os.path.abspath(__file__) if "__file__" in globals() else None
+
+    newest = max(os.path.getmtime(os.path.join(portal, source)) for _, source, _ in ASSETS)
+    if script and os.path.exists(script):
+        newest = max(newest, os.path.getmtime(script))
+    if os.path.exists(target) and os.path.getmtime(target) >= newest:
+        return
+
+    total_raw = total_packed = 0
+    for source, raw, small, packed in convert(portal, target):
+        total_raw += raw
+        total_packed += packed
+        print("[PORTAL] %-12s %6d -> %6d minified -> %6d gzip bytes" % (source, raw, small, packed))
+    print("[PORTAL] total %d -> %d bytes of flash" % (total_raw, total_packed))
+
+
+if "Import" in globals():
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    run(env.subst("$PROJECT_DIR"))  # noqa: F821
+else:
+    run(os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), ".."))
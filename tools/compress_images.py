@@ -0,0 +1,216 @@
+# Screen background compression
+#
+# Converts the RGB565 arrays of the media headers into run length encoded
+# images (src/media/<header>_rle.h) decoded at draw time by rleImage.cpp.
+# Runs before every PlatformIO build (extra_scripts = pre:) and only rewrites
+# a header when its source or this script changed. Can also be run by hand:
+#
+#   python tools/compress_images.py
+#
+# Each row is encoded on its own so any rectangle can be decoded without
+# walking the rows above it. Packets:
+#   0x80 | (n - 1), pixel       run of n identical pixels (n <= 128)
+#   n - 1, pixel * n            n literal pixels
+# Pixels are stored little endian, as in the uint16_t arrays.
+
+import os
+import re
+import sys
+
+HEADERS = [
+    "images_320_170.h",
+    "images_240_135.h",
+    "images_128_128.h",
+    "images_bottom_320_70.h",
+]
+
+MAX_PACKET = 128
+
+DIMENSION_RE = re.compile(r"const\s+uint16_t\s+(\w+?)(Width|Height)\s*=\s*(\d+)\s*;")
+ARRAY_RE = re.compile(r"const\s+unsigned\s+short\s+(\w+)\s*\[[^\]]*\]\s*PROGMEM\s*=\s*\{(.*?)\}\s*;", re.S)
+VALUE_RE = re.compile(r"0x[0-9A-Fa-f]+|\d+")
+
+
+def parse_header(text):
+    """Returns the dimension declarations and (name, width, height, pixels) for each image.
+    An image takes the last width and height declared before its array."""
+    events = []
+    for m in DIMENSION_RE.finditer(text):
+        events.append((m.start(), "dim", m))
+    for m in ARRAY_RE.finditer(text):
+        events.append((m.start(), "array", m))
+    events.sort(key=lambda e: e[0])
+
+    width = height = None
+    dimensions = []
+    images = []
+    for _, kind, m in events:
+        if kind == "dim":
+            if m.group(2) == "Width":
+                width = int(m.group(3))
+            else:
+                height = int(m.group(3))
+            dimensions.append(m.group(0))
+        else:
+            # Strip the // comments before reading the values
+            body = re.sub(r"//[^\n]*", "", m.group(2))
+            pixels = [int(v, 0) for v in VALUE_RE.findall(body)]
+            if width is None or height is None:
+                raise ValueError("%s: no width/height declared" % m.group(1))
+            if len(pixels) < width * height:
+                # The raw push read past the end of the array, draw black there instead
+                print("[IMAGES] %s: %d pixels for %dx%d, padded with black" % (m.group(1), len(pixels), width, height))
+                pixels += [0] * (width * height - len(pixels))
+            images.append((m.group(1), width, height, pixels[:width * height]))
+    return dimensions, images
+
+
+def append_literal(out, pixels):
+    for start in range(0, len(pixels), MAX_PACKET):
+        chunk = pixels[start:start + MAX_PACKET]
+        out.append(len(chunk) - 1)
+        for p in chunk:
+            out += p.to_bytes(2, "little")
+
+
+def encode_row(row):
+    out = bytearray()
+    i = 0
+    n = len(row)
+    literal_start = None
+
+    while i < n:
+        run = 1
+        while i + run < n and run < MAX_PACKET and row[i + run] == row[i]:
+            run += 1
+        if run >= 2:
+            if literal_start is not None:
+                append_literal(out, row[literal_start:i])
+                literal_start = None
+            out.append(0x80 | (run - 1))
+            out += row[i].to_bytes(2, "little")
+            i += run
+        else:
+            if literal_start is None:
+                literal_start = i
+            i += 1
+    if literal_start is not None:
+        append_literal(out, row[literal_start:n])
+    return out
+
+
+def decode_row(data, width):
+    """Reference decoder, checks every encoded row"""
+    row = []
+    i = 0
+    while len(row) < width:
+        h = data[i]
+        i += 1
+        count = (h & 0x7F) + 1
+        if h & 0x80:
+            row += [int.from_bytes(data[i:i + 2], "little")] * count
+            i += 2
+        else:
+            for _ in range(count):
+                row.append(int.from_bytes(data[i:i + 2], "little"))
+                i += 2
+    return row
+
+
+def format_bytes(data, indent="  ", per_line=24):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join("0x%02X" % b for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def convert(source, target):
+    with open(source, "r") as f:
+        text = f.read()
+
+    header = os.path.basename(source)
+    guard = re.sub(r"\W", "_", os.path.basename(target)).upper()
+    out = []
+    out.append("// Generated by tools/compress_images.py from %s, do not edit" % header)
+    out.append("#ifndef %s" % guard)
+    out.append("#define %s" % guard)
+    out.append("")
+    out.append('#include "drivers/displays/rleImage.h"')
+    out.append("")
+    out.append("#if RLE_IMAGES")
+    out.append("")
+
+    dimensions, images = parse_header(text)
+    for line in dimensions:
+        out.append(line)
+    out.append("")
+
+    report = []
+    for name, width, height, pixels in images:
+        data = bytearray()
+        offsets = []
+        for y in range(height):
+            row = pixels[y * width:(y + 1) * width]
+            encoded = encode_row(row)
+            if decode_row(encoded, width) != row:
+                raise ValueError("%s: row %d doesn't decode back" % (name, y))
+            offsets.append(len(data))
+            data += encoded
+        out.append("static const uint8_t %s_rleData[%d] PROGMEM = {" % (name, len(data)))
+        out.append(format_bytes(data))
+        out.append("};")
+        out.append("static const uint32_t %s_rleRows[%d] PROGMEM = {" % (name, height))
+        for i in range(0, height, 12):
+            out.append("  " + ", ".join(str(o) for o in offsets[i:i + 12]) + ",")
+        out.append("};")
+        out.append("const rle_image %s_rle = {%s_rleData, %s_rleRows, NULL, %d, %d};" % (name, name, name, width, height))
+        out.append("")
+        raw = width * height * 2
+        packed = len(data) + height * 4
+        report.append((name, raw, packed))
+
+    out.append("#else")
+    out.append("")
+    out.append('#include "%s"' % header)
+    out.append("")
+    for name, width, height, _ in images:
+        out.append("const rle_image %s_rle = {NULL, NULL, %s, %d, %d};" % (name, name, width, height))
+    out.append("")
+    out.append("#endif // RLE_IMAGES")
+    out.append("")
+    out.append("#endif // %s" % guard)
+    out.append("")
+
+    with open(target, "w") as f:
+        f.write("\n".join(out))
+    return report
+
+
+def run(project_dir):
+    media = os.path.join(project_dir, "src", "media")
+    script = os.path.abspath(__file__) if "__file__" in globals() else None
+    total_raw = total_packed = 0
+
+    for header in HEADERS:
+        source = os.path.join(media, header)
+        target = os.path.join(media, header[:-2] + "_rle.h")
+        newest = os.path.getmtime(source)
+        if script and os.path.exists(script):
+            newest = max(newest, os.path.getmtime(script))
+        if os.path.exists(target) and os.path.getmtime(target) >= newest:
+            continue
+
+        for name, raw, packed in convert(source, target):
+            total_raw += raw
+            total_packed += packed
+            print("[IMAGES] %-22s %7d -> %7d bytes (%4.1f%%)" % (name, raw, packed, 100.0 * packed / raw))
+
+    if total_raw:
+        print("[IMAGES] total %d -> %d bytes of flash" % (total_raw, total_packed))
+
+
+if "Import" in globals():
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    run(env.subst("$PROJECT_DIR"))  # noqa: F821
+else:
+    run(os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), ".."))
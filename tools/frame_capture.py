@@ -0,0 +1,115 @@
+# Frame capture
+#
+# Runs the off-device display harness of a board (the native-* envs in
+# platformio.ini, sources in native/) and checks its report against a
+# baseline. The harness draws every screen twice, "first" is the full frame
+# and "again" the same screen redrawn with nothing changed, and writes one
+# PNG per frame plus report.json with what each frame cost.
+#
+#   python tools/frame_capture.py native-tdisplay --out frames/tdisplay
+#   python tools/frame_capture.py native-tdisplay --out frames/tdisplay --update
+#   python tools/frame_capture.py native-tdisplay --out new --baseline frames/tdisplay/report.json
+#   python tools/frame_capture.py --no-build --out frames/tdisplay --baseline base.json
+#
+# Without --baseline the baseline is <out>/baseline.json. A frame fails when
+# its image (crc) changed, or when it costs more draw calls, pixels or bytes
+# than the baseline; the exit code is then 1 so it can gate CI. --update
+# writes the current report as the new baseline instead. Standard library only.
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+
+CHECKED = ["drawCalls", "pixels", "bytes"]
+
+
+def run_harness(args):
+    if not args.no_build:
+        print("[BUILD] pio run -e %s" % args.env)
+        if subprocess.call(["pio", "run", "-e", args.env]) != 0:
+            return False
+        program = os.path.join(".pio", "build", args.env, "program")
+        os.makedirs(args.out, exist_ok=True)
+        print("[RUN] %s %s" % (program, args.out))
+        if subprocess.call([program, args.out]) != 0:
+            return False
+    return True
+
+
+def load_report(path):
+    with open(path) as f:
+        report = json.load(f)
+    return report, {(fr["screen"], fr["pass"]): fr for fr in report["frames"]}
+
+
+def compare(report, frames, baseline):
+    old_report, old_frames = baseline
+    failures = 0
+    if (report["width"], report["height"]) != (old_report["width"], old_report["height"]):
+        print("[FAIL] panel %dx%d, baseline %dx%d" % (report["width"], report["height"],
+                                                        old_report["width"], old_report["height"]))
+        return 1
+
+    for key, frame in frames.items():
+        old = old_frames.get(key)
+        name = "screen %s %s" % key
+        if old is None:
+            print("[NEW] %s: not in the baseline" % name)
+            continue
+        if frame["crc"] != old["crc"]:
+            print("[FAIL] %s: image differs from the baseline (%s)" % (name, frame["image"]))
+            failures += 1
+        for field in CHECKED:
+            if frame[field] > old[field]:
+                print("[FAIL] %s: %d %s, baseline %d" % (name, frame[field], field, old[field]))
+                failures += 1
+            elif frame[field] < old[field]:
+                print("[BETTER] %s: %d %s, baseline %d" % (name, frame[field], field, old[field]))
+
+    for key in [k for k in old_frames if k not in frames]:
+        print("[FAIL] screen %s %s: missing, it is in the baseline" % key)
+        failures += 1
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the off-device display harness and compare its frames")
+    parser.add_argument("env", nargs="?", default="native-tdisplay", help="native-* env of platformio.ini")
+    parser.add_argument("--out", default="frames", help="Directory for the PNGs and report.json")
+    parser.add_argument("--no-build", action="store_true", help="Only check the report already in --out")
+    parser.add_argument("--baseline", help="Baseline report, <out>/baseline.json by default")
+    parser.add_argument("--update", action="store_true", help="Write the report as the new baseline")
+    args = parser.parse_args()
+
+    if not run_harness(args):
+        print("[FAIL] the harness did not run")
+        return 1
+
+    path = os.path.join(args.out, "report.json")
+    if not os.path.exists(path):
+        print("[FAIL] no %s" % path)
+        return 1
+    report, frames = load_report(path)
+    for (screen, step), fr in frames.items():
+        print("[FRAME] screen %-8s %-6s %5d calls %5d pushes %8d px %9d bytes" %
+              (screen, step, fr["drawCalls"], fr["pushes"], fr["pixels"], fr["bytes"]))
+
+    baseline = args.baseline or os.path.join(args.out, "baseline.json")
+    if args.update:
+        shutil.copyfile(path, baseline)
+        print("[BASELINE] written to %s" % baseline)
+        return 0
+    if not os.path.exists(baseline):
+        print("[BASELINE] none at %s, run with --update to create it" % baseline)
+        return 0
+
+    failures = compare(report, frames, load_report(baseline))
+    print("[%s] %d regression(s) against %s" % ("FAIL" if failures else "OK", failures, baseline))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,207 @@
+# Web portal load test
+#
+# Hammers a miner's web server from the host and checks that the small API
+# endpoints keep answering while large responses are being transferred:
+#
+#   python tools/portal_loadtest.py 192.168.1.50
+#   python tools/portal_loadtest.py 192.168.1.50 --clients 6 --slow 2 --seconds 60
+#
+# Three kinds of clients run at the same time for --seconds:
+#   clients   loop over the portal assets (with and without If-None-Match)
+#             and /api/history, the largest response
+#   slow      request /api/history and read it at --slow-rate bytes/s, the
+#             connection stays open the whole time
+#   probe     one client polling /api/stats every --probe-ms, its latency is
+#             the number that matters, it should not grow with the others
+#
+# At the end the latency percentiles per endpoint are printed, followed by the
+# "portal" timings the firmware reports in /api/stats. Standard library only.
+
+import argparse
+import http.client
+import json
+import socket
+import threading
+import time
+
+ASSETS = ["/", "/portal.css", "/portal.js"]
+
+
+class Results:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latency = {}       # endpoint -> [seconds]
+        self.errors = {}        # endpoint -> count
+        self.bytes = 0
+
+    def add(self, name, seconds, size):
+        with self.lock:
+            self.latency.setdefault(name, []).append(seconds)
+            self.bytes += size
+
+    def error(self, name, reason):
+        with self.lock:
+            self.errors[name] = self.errors.get(name, 0) + 1
+            if self.errors[name] <= 3:
+                print("[LOADTEST] %s failed: %s" % (name, reason))
+
+
+def request(host, port, path, timeout, headers=None):
+    """Returns (status, headers, body) on a new connection, like a browser tab would"""
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    try:
+        conn.request("GET", path, headers=headers or {})
+        response = conn.getresponse()
+        body = response.read()
+        return response.status, dict((k.lower(), v) for k, v in response.getheaders()), body
+    finally:
+        conn.close()
+
+
+def timed(results, name, host, port, path, timeout, headers=None, expect=(200,)):
+    start = time.monotonic()
+    try:
+        status, head, body = request(host, port, path, timeout, headers)
+    except Exception as e:  # noqa: BLE001 - any failure counts as an error
+        results.error(name, e)
+        return None, None
+    if status not in expect:
+        results.error(name, "status %d" % status)
+        return None, None
+    results.add(name, time.monotonic() - start, len(body))
+    return head, body
+
+
+def check_assets(host, port, timeout):
+    """Each asset must be gzipped, carry an ETag and answer 304 when it matches"""
+    ok = True
+    for path in ASSETS:
+        status, head, body = request(host, port, path, timeout, {"Accept-Encoding": "gzip"})
+        etag = head.get("etag")
+        if status != 200 or head.get("content-encoding") != "gzip" or not etag:
+            print("[LOADTEST] %s: status %d, encoding %s, etag %s" % (path, status, head.get("content-encoding"), etag))
+            ok = False
+            continue
+        status, _, _ = request(host, port, path, timeout, {"If-None-Match": etag})
+        print("[LOADTEST] %-12s %5d gzip bytes, ETag %s, revalidation %d" % (path, len(body), etag, status))
+        ok = ok and status == 304
+    return ok
+
+
+def run_client(results, args, stop, index):
+    etags = {}
+    i = index
+    while not stop.is_set():
+        path = (ASSETS + ["/api/history"])[i % (len(ASSETS) + 1)]
+        i += 1
+        if path == "/api/history":
+            timed(results, "history", args.host, args.port, path, args.timeout, expect=(200, 503))
+            continue
+        # Every other round revalidates like a browser with a warm cache
+        cached = etags.get(path) if i % 2 else None
+        headers = {"Accept-Encoding": "gzip"}
+        if cached:
+            headers["If-None-Match"] = cached
+        head, _ = timed(results, path + (" 304" if cached else ""), args.host, args.port, path, args.timeout,
+                        headers, expect=(304,) if cached else (200,))
+        if head and head.get("etag"):
+            etags[path] = head["etag"]
+
+
+def slow_connection(host, port, timeout):
+    """A small receive buffer keeps the TCP window closed, the data waits on the server"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1024)
+    sock.settimeout(timeout)
+    sock.connect((socket.gethostbyname(host), port))
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    conn.sock = sock
+    return conn
+
+
+def run_slow(results, args, stop):
+    """Reads /api/history at slow-rate bytes/s, the server has to keep the response open"""
+    while not stop.is_set():
+        start = time.monotonic()
+        size = 0
+        try:
+            conn = slow_connection(args.host, args.port, args.timeout)
+            conn.request("GET", "/api/history")
+            response = conn.getresponse()
+            while not stop.is_set():
+                data = response.read(64)
+                if not data:
+                    break
+                size += len(data)
+                time.sleep(64.0 / args.slow_rate)
+            conn.close()
+            results.add("history slow", time.monotonic() - start, size)
+        except Exception as e:  # noqa: BLE001
+            results.error("history slow", e)
+
+
+def run_probe(results, args, stop):
+    while not stop.is_set():
+        timed(results, "api/stats probe", args.host, args.port, "/api/stats", args.timeout)
+        stop.wait(args.probe_ms / 1000.0)
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def report(results, seconds):
+    print("[LOADTEST] %-18s %6s %6s %8s %8s %8s" % ("endpoint", "ok", "errors", "p50 ms", "p95 ms", "max ms"))
+    names = sorted(set(results.latency) | set(results.errors))
+    for name in names:
+        lat = results.latency.get(name, [])
+        if lat:
+            print("[LOADTEST] %-18s %6d %6d %8.1f %8.1f %8.1f" % (name, len(lat), results.errors.get(name, 0),
+                  percentile(lat, 50) * 1000, percentile(lat, 95) * 1000, max(lat) * 1000))
+        else:
+            print("[LOADTEST] %-18s %6d %6d" % (name, 0, results.errors.get(name, 0)))
+    print("[LOADTEST] %.1f KB/s received" % (results.bytes / 1024.0 / seconds))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Load test of the miner web portal")
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--clients", type=int, default=4, help="clients looping over the assets and /api/history")
+    parser.add_argument("--slow", type=int, default=1, help="clients reading /api/history slowly")
+    parser.add_argument("--slow-rate", type=int, default=512, help="bytes/s read by a slow client")
+    parser.add_argument("--probe-ms", type=int, default=250, help="/api/stats poll interval")
+    parser.add_argument("--seconds", type=int, default=30)
+    parser.add_argument("--timeout", type=float, default=10.0)
+    args = parser.parse_args()
+
+    if not check_assets(args.host, args.port, args.timeout):
+        print("[LOADTEST] The assets are not served gzipped and cacheable")
+
+    results = Results()
+    stop = threading.Event()
+    threads = [threading.Thread(target=run_probe, args=(results, args, stop))]
+    threads += [threading.Thread(target=run_client, args=(results, args, stop, i)) for i in range(args.clients)]
+    threads += [threading.Thread(target=run_slow, args=(results, args, stop)) for _ in range(args.slow)]
+    print("[LOADTEST] %d clients, %d slow clients, 1 probe for %d s" % (args.clients, args.slow, args.seconds))
+    for t in threads:
+        t.daemon = True
+        t.start()
+    time.sleep(args.seconds)
+    stop.set()
+    for t in threads:
+        t.join(args.timeout + 64.0 / max(args.slow_rate, 1))
+
+    report(results, args.seconds)
+    try:
+        _, _, body = request(args.host, args.port, "/api/stats", args.timeout)
+        for route in json.loads(body).get("portal", []):
+            print("[LOADTEST] device %-12s %6d requests, %6d not modified, avg %6d us, max %7d us, heap delta %d" % (
+                  route["path"], route["requests"], route["notModified"], route["avgUs"], route["maxUs"], route["maxHeapDelta"]))
+    except Exception as e:  # noqa: BLE001
+        print("[LOADTEST] /api/stats failed: %s" % e)
+
+
+if __name__ == "__main__":
+    main()